@@ -3,6 +3,8 @@
 #include <condition_variable>
 #include <mutex>
 
+#include "cancellation.hpp"
+
 namespace cppthreadflow {
 
 /**
@@ -34,6 +36,16 @@ class Barrier {
    */
   void arrive_and_wait();
 
+  /**
+   * @brief 到达屏障并阻塞，直到所有参与者都到达，等待期间可以被取消。
+   *
+   * 如果在本代完成之前被取消，本次到达会被撤销，
+   * 屏障仍然需要 party_count 个参与者才能完成这一代。
+   * @param token 取消令牌；被取消或到达其截止时间时立即停止等待。
+   * @return 如果这一代已完成，返回 true；如果被取消，返回 false。
+   */
+  bool arrive_and_wait(const CancellationToken& token);
+
  private:
   const int party_count_;  // 参与者总数
   int current_count_;      // 当前代已到达的数量
@@ -0,0 +1,17 @@
+﻿#pragma once
+
+#include <cstddef>
+
+namespace cppthreadflow {
+
+/**
+ * @brief 假定的缓存行大小（字节）。
+ *
+ * 主流 x86-64 与 ARM64 处理器的缓存行均为 64 字节。
+ * 不使用 std::hardware_destructive_interference_size，
+ * 因为它在部分编译器上缺失，或会随编译选项变化而引发 ABI 警告。
+ * 被不同线程频繁写入的数据应按此值对齐，以避免伪共享 (false sharing)。
+ */
+inline constexpr std::size_t kCacheLineSize = 64;
+
+}  // namespace cppthreadflow
@@ -0,0 +1,100 @@
+﻿#include "cancellation.hpp"
+
+#include <algorithm>
+
+namespace cppthreadflow {
+
+namespace detail {
+
+CancellationState::CancellationState(std::shared_ptr<CancellationState> parent,
+                                     TimePoint deadline)
+    : parent_(std::move(parent)),
+      deadline_(parent_ != nullptr ? std::min(deadline, parent_->deadline()) : deadline) {
+    if (parent_ != nullptr) {
+        // 父状态已被取消时，回调会立即执行，此时所有成员都已初始化
+        parent_callback_ = parent_->add_callback([this] { request_cancel(); });
+    }
+}
+
+CancellationState::~CancellationState() {
+    if (parent_ != nullptr) {
+        parent_->remove_callback(parent_callback_);
+    }
+}
+
+void CancellationState::request_cancel() {
+    bool expected = false;
+    if (!cancelled_.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    callback_thread_ = std::this_thread::get_id();
+    while (!callbacks_.empty()) {
+        auto it = callbacks_.begin();
+        running_callback_ = it->first;
+        std::function<void()> callback = std::move(it->second);
+        callbacks_.erase(it);
+        // 在锁外执行回调：回调可能会注册或注销其他回调
+        lock.unlock();
+        callback();
+        lock.lock();
+        running_callback_ = 0;
+        callback_done_.notify_all();
+    }
+}
+
+std::uint64_t CancellationState::add_callback(std::function<void()> callback) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // request_cancel 先设置标志再加锁，因此这里看不到标志时，回调一定会被它执行
+        if (!cancelled_.load(std::memory_order_acquire)) {
+            const std::uint64_t id = next_id_++;
+            callbacks_.emplace(id, std::move(callback));
+            return id;
+        }
+    }
+    callback();
+    return 0;
+}
+
+void CancellationState::remove_callback(std::uint64_t id) {
+    if (id == 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (callbacks_.erase(id) > 0) {
+        return;
+    }
+    // 回调正在另一个线程中执行：等待它结束。在回调内部注销自己则不能等待
+    if (running_callback_ == id && callback_thread_ != std::this_thread::get_id()) {
+        callback_done_.wait(lock, [this, id] { return running_callback_ != id; });
+    }
+}
+
+} // namespace detail
+
+CancellationSource::CancellationSource()
+    : CancellationSource(TimePoint::max()) {}
+
+CancellationSource::CancellationSource(const CancellationToken& parent)
+    : CancellationSource(parent, TimePoint::max()) {}
+
+CancellationSource::CancellationSource(TimePoint deadline)
+    : state_(std::make_shared<detail::CancellationState>(nullptr, deadline)) {}
+
+CancellationSource::CancellationSource(const CancellationToken& parent, TimePoint deadline)
+    : state_(std::make_shared<detail::CancellationState>(parent.state_, deadline)) {}
+
+void CancellationSource::cancel() {
+    state_->request_cancel();
+}
+
+bool CancellationSource::is_cancellation_requested() const {
+    return state_->is_cancelled();
+}
+
+CancellationToken CancellationSource::token() const {
+    return CancellationToken(state_);
+}
+
+} // namespace cppthreadflow
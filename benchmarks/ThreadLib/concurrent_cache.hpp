@@ -0,0 +1,351 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <functional>  // for std::hash
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "hash_utils.hpp"
+
+namespace cppthreadflow {
+
+/**
+ * @brief 一个有容量上限的线程安全缓存，按分片使用 CLOCK 算法淘汰。
+ *
+ * 与 ConcurrentHashMap 一样按键的哈希分片，每个分片有独立的锁、索引和
+ * CLOCK 环，没有全局的 LRU 链表，因此命中路径不会争抢同一把锁。
+ * CLOCK 是 LRU 的近似：命中只设置一个引用位，淘汰时指针扫过环，
+ * 跳过（并清除）被引用过的条目，淘汰第一个未被引用的条目。
+ *
+ * 容量可以按条目数计算（默认），也可以传入 weigher 按字节等权重计算。
+ * get_or_load() 会合并同一个键的并发未命中，只有一个线程真正执行加载。
+ *
+ * @tparam Key 键类型。
+ * @tparam Value 值类型，需要可拷贝。
+ * @tparam Hash 哈希函数，默认为 std::hash<Key>。
+ * @tparam KeyEqual 键比较函数，默认为 std::equal_to<Key>。
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key> >
+class ConcurrentCache {
+ public:
+  // 计算条目权重的函数；为空时每个条目的权重为 1
+  using Weigher = std::function<size_t(const Key&, const Value&)>;
+
+  /**
+   * @brief 缓存的统计信息。
+   */
+  struct Stats {
+    std::uint64_t hits = 0;       // 命中次数
+    std::uint64_t misses = 0;     // 未命中次数
+    std::uint64_t evictions = 0;  // 因容量不足被淘汰的条目数
+    std::uint64_t loads = 0;      // get_or_load 实际执行加载的次数
+    size_t size = 0;              // 当前条目数
+    size_t weight = 0;            // 当前总权重
+  };
+
+ private:
+  struct Entry {
+    std::optional<std::pair<Key, Value> > item;  // 为空表示空闲槽位
+    size_t weight = 0;
+    bool referenced = false;  // CLOCK 引用位
+  };
+
+  // 正在进行中的加载，等待者通过 shared_future 获取结果
+  struct PendingLoad {
+    std::promise<Value> promise;
+    std::shared_future<Value> result = promise.get_future().share();
+  };
+
+  struct alignas(kCacheLineSize) Shard {
+    std::mutex mutex_;
+    std::unordered_map<Key, size_t, Hash, KeyEqual> index_;  // 键 -> 槽位
+    std::vector<Entry> slots_;                               // CLOCK 环
+    std::vector<size_t> free_slots_;
+    size_t hand_ = 0;
+    size_t weight_ = 0;
+    size_t capacity_ = 0;
+    std::unordered_map<Key, std::shared_ptr<PendingLoad>, Hash, KeyEqual>
+        loading_;
+    Stats stats_;
+  };
+
+ public:
+  /**
+   * @brief 构造一个缓存。
+   * @param capacity 容量上限：未提供 weigher 时为条目数，否则为总权重。
+   * @param concurrency_level 预期的并发级别，用于确定分片数量（向上取整为 2 的幂）。
+   * @param weigher 可选的权重函数。
+   */
+  explicit ConcurrentCache(
+      size_t capacity,
+      size_t concurrency_level = std::thread::hardware_concurrency(),
+      Weigher weigher = nullptr)
+      : capacity_(capacity == 0 ? 1 : capacity), weigher_(std::move(weigher)) {
+    num_shards_ = detail::next_power_of_two(concurrency_level);
+    // 保证每个分片至少能容纳 1 个单位的容量
+    while (num_shards_ > 1 && num_shards_ > capacity_) {
+      num_shards_ >>= 1;
+    }
+    shard_mask_ = num_shards_ - 1;
+    shards_ = std::make_unique<Shard[]>(num_shards_);
+    // 将总容量尽量均分到各分片，总和恰好等于 capacity
+    for (size_t i = 0; i < num_shards_; ++i) {
+      shards_[i].capacity_ =
+          capacity_ / num_shards_ + (i < capacity_ % num_shards_ ? 1 : 0);
+    }
+  }
+
+  // 禁止拷贝和移动
+  ConcurrentCache(const ConcurrentCache&) = delete;
+  ConcurrentCache& operator=(const ConcurrentCache&) = delete;
+
+  /**
+   * @brief 查找一个键，命中时设置其引用位。
+   * @param key 要查找的键。
+   * @param value_out [输出参数] 如果命中，值将被拷贝到这里。
+   * @return 命中返回 true，否则返回 false。
+   */
+  bool get(const Key& key, Value& value_out) {
+    Shard& shard = get_shard(key);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
+    auto it = shard.index_.find(key);
+    if (it == shard.index_.end()) {
+      ++shard.stats_.misses;
+      return false;
+    }
+    Entry& entry = shard.slots_[it->second];
+    entry.referenced = true;
+    ++shard.stats_.hits;
+    value_out = entry.item->second;
+    return true;
+  }
+
+  /**
+   * @brief 插入或覆盖一个条目，必要时淘汰其他条目。
+   * 如果单个条目的权重超过其分片的容量，该条目不会被缓存。
+   * 同一个键正在进行的 get_or_load 不会再用它加载的（更旧的）值覆盖这次写入。
+   * @param key 键。
+   * @param value 值。
+   */
+  void put(const Key& key, Value value) {
+    Shard& shard = get_shard(key);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
+    shard.loading_.erase(key);
+    store(shard, key, std::move(value));
+  }
+
+  /**
+   * @brief 获取键对应的值；未命中时调用 loader(key) 加载并写入缓存。
+   *
+   * 同一个键的并发未命中会被合并：只有第一个线程调用 loader，
+   * 其他线程等待其结果。loader 在锁外执行，可以做耗时的 I/O。
+   * 如果 loader 抛出异常，所有等待者都会收到该异常，且结果不会被缓存。
+   * 加载期间对同一个键的 put、erase 或 clear 使这次加载失效：
+   * 加载的值仍返回给调用者和等待者，但不写入缓存，以免覆盖更新的状态。
+   * @param key 键。
+   * @param loader 可调用对象，签名为 Value(const Key&)。
+   * @return 键对应的值。
+   */
+  template <typename Loader>
+  Value get_or_load(const Key& key, Loader&& loader) {
+    Shard& shard = get_shard(key);
+    std::shared_ptr<PendingLoad> pending;
+    {
+      std::unique_lock<std::mutex> lock(shard.mutex_);
+      auto it = shard.index_.find(key);
+      if (it != shard.index_.end()) {
+        Entry& entry = shard.slots_[it->second];
+        entry.referenced = true;
+        ++shard.stats_.hits;
+        return entry.item->second;
+      }
+      ++shard.stats_.misses;
+
+      auto loading = shard.loading_.find(key);
+      if (loading != shard.loading_.end()) {
+        // 已有线程在加载同一个键，等待其结果即可
+        std::shared_future<Value> result = loading->second->result;
+        lock.unlock();
+        return result.get();
+      }
+      pending = std::make_shared<PendingLoad>();
+      shard.loading_.emplace(key, pending);
+    }
+
+    try {
+      Value value = std::forward<Loader>(loader)(key);
+      {
+        std::unique_lock<std::mutex> lock(shard.mutex_);
+        // 加载期间被 put/erase/clear 移除（可能已换成后来的加载）时，结果已经过时
+        auto loading = shard.loading_.find(key);
+        if (loading != shard.loading_.end() && loading->second == pending) {
+          store(shard, key, value);
+          shard.loading_.erase(loading);
+        }
+        ++shard.stats_.loads;
+      }
+      pending->promise.set_value(value);
+      return value;
+    } catch (...) {
+      {
+        std::unique_lock<std::mutex> lock(shard.mutex_);
+        auto loading = shard.loading_.find(key);
+        if (loading != shard.loading_.end() && loading->second == pending) {
+          shard.loading_.erase(loading);
+        }
+      }
+      pending->promise.set_exception(std::current_exception());
+      throw;
+    }
+  }
+
+  /**
+   * @brief 移除一个键，同时使该键正在进行的 get_or_load 失效。
+   * @return 如果成功移除，返回 true，否则返回 false。
+   */
+  bool erase(const Key& key) {
+    Shard& shard = get_shard(key);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
+    shard.loading_.erase(key);
+    auto it = shard.index_.find(key);
+    if (it == shard.index_.end()) {
+      return false;
+    }
+    const size_t slot = it->second;
+    shard.index_.erase(it);
+    release_slot(shard, slot);
+    return true;
+  }
+
+  /**
+   * @brief 清空缓存（统计信息保留）。
+   */
+  void clear() {
+    for (size_t i = 0; i < num_shards_; ++i) {
+      Shard& shard = shards_[i];
+      std::unique_lock<std::mutex> lock(shard.mutex_);
+      shard.index_.clear();
+      shard.loading_.clear();
+      shard.slots_.clear();
+      shard.free_slots_.clear();
+      shard.hand_ = 0;
+      shard.weight_ = 0;
+    }
+  }
+
+  /**
+   * @brief 获取当前条目数。
+   */
+  size_t size() const { return stats().size; }
+
+  /**
+   * @brief 获取容量上限。
+   */
+  size_t capacity() const { return capacity_; }
+
+  /**
+   * @brief 汇总所有分片的统计信息。
+   */
+  Stats stats() const {
+    Stats total;
+    for (size_t i = 0; i < num_shards_; ++i) {
+      Shard& shard = shards_[i];
+      std::unique_lock<std::mutex> lock(shard.mutex_);
+      total.hits += shard.stats_.hits;
+      total.misses += shard.stats_.misses;
+      total.evictions += shard.stats_.evictions;
+      total.loads += shard.stats_.loads;
+      total.size += shard.index_.size();
+      total.weight += shard.weight_;
+    }
+    return total;
+  }
+
+ private:
+  Shard& get_shard(const Key& key) const {
+    return shards_[detail::mix_hash(hasher_(key)) & shard_mask_];
+  }
+
+  size_t weigh(const Key& key, const Value& value) const {
+    return weigher_ ? weigher_(key, value) : 1;
+  }
+
+  // 在持有分片锁的情况下写入条目
+  void store(Shard& shard, const Key& key, Value value) {
+    const size_t weight = weigh(key, value);
+    auto it = shard.index_.find(key);
+    if (it != shard.index_.end()) {
+      // 先移除旧条目，再按新权重重新插入
+      const size_t slot = it->second;
+      shard.index_.erase(it);
+      release_slot(shard, slot);
+    }
+    if (weight > shard.capacity_) {
+      return;  // 单个条目超过分片容量，不缓存
+    }
+    while (shard.weight_ + weight > shard.capacity_) {
+      evict_one(shard);
+    }
+
+    size_t slot;
+    if (!shard.free_slots_.empty()) {
+      slot = shard.free_slots_.back();
+      shard.free_slots_.pop_back();
+    } else {
+      slot = shard.slots_.size();
+      shard.slots_.emplace_back();
+    }
+    Entry& entry = shard.slots_[slot];
+    entry.item.emplace(key, std::move(value));
+    entry.weight = weight;
+    // 新条目不设置引用位，只被访问一次的条目会优先被淘汰
+    entry.referenced = false;
+    shard.index_.emplace(key, slot);
+    shard.weight_ += weight;
+  }
+
+  // CLOCK 淘汰：跳过并清除被引用过的条目，淘汰第一个未被引用的条目
+  void evict_one(Shard& shard) {
+    while (true) {
+      if (shard.hand_ >= shard.slots_.size()) {
+        shard.hand_ = 0;
+      }
+      Entry& entry = shard.slots_[shard.hand_];
+      if (entry.item && !entry.referenced) {
+        shard.index_.erase(entry.item->first);
+        release_slot(shard, shard.hand_++);
+        ++shard.stats_.evictions;
+        return;
+      }
+      entry.referenced = false;
+      ++shard.hand_;
+    }
+  }
+
+  void release_slot(Shard& shard, size_t slot) {
+    Entry& entry = shard.slots_[slot];
+    shard.weight_ -= entry.weight;
+    entry.item.reset();
+    entry.weight = 0;
+    entry.referenced = false;
+    shard.free_slots_.push_back(slot);
+  }
+
+  Hash hasher_;
+  const size_t capacity_;
+  Weigher weigher_;
+  size_t num_shards_;
+  size_t shard_mask_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace cppthreadflow
@@ -1,13 +1,47 @@
 ﻿#pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <exception>
 #include <functional>  // for std::hash
+#include <future>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>  // for std::pair
 #include <vector>
+
+#include "cache_line.hpp"
+#include "hash_utils.hpp"
+#include "thread_pool.hpp"
 namespace cppthreadflow {
 
+/**
+ * @brief 支持异构查找的字符串哈希函数。
+ *
+ * 与 std::equal_to<> 搭配作为 ConcurrentHashMap<std::string, ...> 的模板参数，
+ * 即可直接用 std::string_view 或字符串字面量查找，而无需构造临时的 std::string。
+ */
+struct TransparentStringHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view str) const {
+    return std::hash<std::string_view>{}(str);
+  }
+};
+
+namespace detail {
+template <typename T, typename = void>
+struct is_transparent : std::false_type {};
+template <typename T>
+struct is_transparent<T, std::void_t<typename T::is_transparent> >
+    : std::true_type {};
+}  // namespace detail
+
 /**
  * @brief 一个高性能的、基于分片锁的线程安全哈希表。
  *
@@ -24,24 +58,42 @@ class ConcurrentHashMap {
    * @brief 分片 (Shard) 结构体。
    * 每个分片包含一个独立的哈希表和一个独立的互斥锁。
    * 注意：mutex 必须是 mutable，以便在 const 成员函数（如 find）中被锁定。
+   * 分片按缓存行对齐，相邻分片的锁不会落在同一缓存行上而产生伪共享。
    */
-  struct Shard {
+  struct alignas(kCacheLineSize) Shard {
     mutable std::mutex mutex_;
     std::unordered_map<Key, Value, Hash, KeyEqual> map_;
+    // 锁统计：获取次数，以及获取时锁已被占用（发生争用）的次数
+    mutable std::atomic<std::uint64_t> lock_acquisitions_{0};
+    mutable std::atomic<std::uint64_t> lock_contentions_{0};
   };
 
+  // K 是否可以作为异构键使用：不是 Key 本身，且哈希与比较函数都是透明的
+  template <typename K>
+  using is_heterogeneous_key = std::bool_constant<
+      !std::is_same_v<std::decay_t<K>, Key> &&
+      detail::is_transparent<Hash>::value &&
+      detail::is_transparent<KeyEqual>::value>;
+
  public:
+  /**
+   * @brief 单个分片的统计信息。
+   */
+  struct ShardStats {
+    size_t size;                       // 分片中的元素数量
+    std::uint64_t lock_acquisitions;   // 分片锁被获取的次数
+    std::uint64_t lock_contentions;    // 获取时需要等待的次数
+  };
+
   /**
    * @brief 构造一个并发哈希表。
    * @param concurrency_level 预期的并发级别，用于确定分片的数量。
-   * 默认为硬件并发线程数。
+   * 默认为硬件并发线程数，会向上取整为 2 的幂。
    */
   explicit ConcurrentHashMap(
       size_t concurrency_level = std::thread::hardware_concurrency())
-      : num_shards_(concurrency_level) {
-    if (num_shards_ == 0) {
-      num_shards_ = 1;
-    }
+      : num_shards_(detail::next_power_of_two(concurrency_level)),
+        shard_mask_(num_shards_ - 1) {
     // 初始化分片，创建 num_shards_ 个 Shard 实例
     shards_ = std::make_unique<Shard[]>(num_shards_);
   }
@@ -57,7 +109,7 @@ class ConcurrentHashMap {
    */
   void insert(const Key& key, const Value& value) {
     Shard& shard = get_shard(key);
-    std::unique_lock<std::mutex> lock(shard.mutex_);
+    auto lock = lock_shard(shard);
     shard.map_[key] = value;  // 使用 operator[] 实现插入或更新
   }
 
@@ -68,10 +120,113 @@ class ConcurrentHashMap {
    */
   void insert(const Key& key, Value&& value) {
     Shard& shard = get_shard(key);
-    std::unique_lock<std::mutex> lock(shard.mutex_);
+    auto lock = lock_shard(shard);
     shard.map_[key] = std::move(value);
   }
 
+  /**
+   * @brief 插入或覆盖一个键值对。
+   * @param key 键。
+   * @param value 值（完美转发）。
+   * @return 如果是新插入返回 true，如果覆盖了已有的值返回 false。
+   */
+  template <typename V>
+  bool insert_or_assign(const Key& key, V&& value) {
+    Shard& shard = get_shard(key);
+    auto lock = lock_shard(shard);
+    return shard.map_.insert_or_assign(key, std::forward<V>(value)).second;
+  }
+
+  /**
+   * @brief 仅当键不存在时，用给定参数原地构造值。
+   * @param key 键。
+   * @param args 构造值所需的参数。键已存在时参数不会被使用。
+   * @return 如果插入成功返回 true，如果键已存在返回 false。
+   */
+  template <typename... Args>
+  bool try_emplace(const Key& key, Args&&... args) {
+    Shard& shard = get_shard(key);
+    auto lock = lock_shard(shard);
+    return shard.map_.try_emplace(key, std::forward<Args>(args)...).second;
+  }
+
+  /**
+   * @brief 获取键对应的值；如果键不存在，则调用 fn() 计算并插入。
+   * 整个“查找-计算-插入”过程只持有一次分片锁，fn 最多被调用一次。
+   * 注意：fn 在分片锁内执行，应尽量轻量，且不能再访问本哈希表。
+   * @param key 键。
+   * @param fn 无参可调用对象，返回新值。
+   * @return 键对应的值（已存在的值或新计算的值）的拷贝。
+   */
+  template <typename F>
+  Value compute_if_absent(const Key& key, F&& fn) {
+    Shard& shard = get_shard(key);
+    auto lock = lock_shard(shard);
+    auto it = shard.map_.find(key);
+    if (it == shard.map_.end()) {
+      it = shard.map_.emplace(key, std::forward<F>(fn)()).first;
+    }
+    return it->second;
+  }
+
+  /**
+   * @brief 在分片锁内原地修改已存在的值。
+   * @param key 键。
+   * @param fn 可调用对象，签名为 void(Value&)。
+   * @return 如果找到键并执行了 fn，返回 true，否则返回 false。
+   */
+  template <typename F>
+  bool update(const Key& key, F&& fn) {
+    Shard& shard = get_shard(key);
+    auto lock = lock_shard(shard);
+    auto it = shard.map_.find(key);
+    if (it == shard.map_.end()) {
+      return false;
+    }
+    std::forward<F>(fn)(it->second);
+    return true;
+  }
+
+  /**
+   * @brief 键存在时原地修改其值，不存在时插入默认值。
+   * 典型用法是计数器累加：upsert(key, [](int& v) { ++v; }, 1)。
+   * @param key 键。
+   * @param fn 可调用对象，签名为 void(Value&)，仅在键已存在时调用。
+   * @param default_value 键不存在时插入的值。
+   * @return 如果插入了默认值返回 true，如果修改了已有的值返回 false。
+   */
+  template <typename F, typename V>
+  bool upsert(const Key& key, F&& fn, V&& default_value) {
+    Shard& shard = get_shard(key);
+    auto lock = lock_shard(shard);
+    auto it = shard.map_.find(key);
+    if (it == shard.map_.end()) {
+      shard.map_.emplace(key, std::forward<V>(default_value));
+      return true;
+    }
+    std::forward<F>(fn)(it->second);
+    return false;
+  }
+
+  /**
+   * @brief 当键存在且其值满足谓词时移除它。
+   * @param key 键。
+   * @param pred 谓词，签名为 bool(const Value&)。
+   * @return 如果成功移除，返回 true，否则返回 false。
+   */
+  template <typename Pred>
+  bool erase_if(const Key& key, Pred&& pred) {
+    Shard& shard = get_shard(key);
+    auto lock = lock_shard(shard);
+    auto it = shard.map_.find(key);
+    if (it == shard.map_.end() ||
+        !std::forward<Pred>(pred)(static_cast<const Value&>(it->second))) {
+      return false;
+    }
+    shard.map_.erase(it);
+    return true;
+  }
+
   /**
    * @brief 查找一个键。
    * @param key 要查找的键。
@@ -80,7 +235,7 @@ class ConcurrentHashMap {
    */
   bool find(const Key& key, Value& value_out) const {
     const Shard& shard = get_shard(key);
-    std::unique_lock<std::mutex> lock(shard.mutex_);  // 锁是 mutable 的
+    auto lock = lock_shard(shard);  // 锁是 mutable 的
 
     auto it = shard.map_.find(key);
     if (it != shard.map_.end()) {
@@ -90,6 +245,58 @@ class ConcurrentHashMap {
     return false;
   }
 
+  /**
+   * @brief 异构查找：用可与 Key 比较的类型（如 std::string_view）查找。
+   * 仅当 Hash 和 KeyEqual 都声明了 is_transparent 时可用。
+   */
+  template <typename K, typename = std::enable_if_t<
+                            is_heterogeneous_key<K>::value> >
+  bool find(const K& key, Value& value_out) const {
+    return cvisit(key, [&value_out](const Value& value) { value_out = value; });
+  }
+
+  /**
+   * @brief 在分片锁内以可修改的方式访问键对应的值，避免拷贝。
+   * 注意：fn 在分片锁内执行，应尽量轻量，且不能再访问本哈希表。
+   * @param key 键。
+   * @param fn 可调用对象，签名为 void(Value&)。
+   * @return 如果找到键并执行了 fn，返回 true，否则返回 false。
+   */
+  template <typename F>
+  bool visit(const Key& key, F&& fn) {
+    return visit_impl(*this, key, std::forward<F>(fn));
+  }
+
+  /**
+   * @brief visit 的异构查找版本。
+   */
+  template <typename K, typename F,
+            typename = std::enable_if_t<is_heterogeneous_key<K>::value> >
+  bool visit(const K& key, F&& fn) {
+    return visit_impl(*this, key, std::forward<F>(fn));
+  }
+
+  /**
+   * @brief 在分片锁内以只读方式访问键对应的值，避免拷贝。
+   * 注意：fn 在分片锁内执行，应尽量轻量，且不能再访问本哈希表。
+   * @param key 键。
+   * @param fn 可调用对象，签名为 void(const Value&)。
+   * @return 如果找到键并执行了 fn，返回 true，否则返回 false。
+   */
+  template <typename F>
+  bool cvisit(const Key& key, F&& fn) const {
+    return visit_impl(*this, key, std::forward<F>(fn));
+  }
+
+  /**
+   * @brief cvisit 的异构查找版本。
+   */
+  template <typename K, typename F,
+            typename = std::enable_if_t<is_heterogeneous_key<K>::value> >
+  bool cvisit(const K& key, F&& fn) const {
+    return visit_impl(*this, key, std::forward<F>(fn));
+  }
+
   /**
    * @brief 移除一个键。
    * @param key 要移除的键。
@@ -97,7 +304,7 @@ class ConcurrentHashMap {
    */
   bool erase(const Key& key) {
     Shard& shard = get_shard(key);
-    std::unique_lock<std::mutex> lock(shard.mutex_);
+    auto lock = lock_shard(shard);
 
     // std::unordered_map::erase(key) 返回移除的元素数量
     return shard.map_.erase(key) > 0;
@@ -109,11 +316,189 @@ class ConcurrentHashMap {
    */
   void clear() {
     for (size_t i = 0; i < num_shards_; ++i) {
-      std::unique_lock<std::mutex> lock(shards_[i].mutex_);
+      auto lock = lock_shard(shards_[i]);
       shards_[i].map_.clear();
     }
   }
 
+  /**
+   * @brief 批量插入（或覆盖）键值对。
+   * 先按分片对所有键分组，再逐个分片加锁写入，每个分片只加锁一次。
+   * 如果传入 std::move_iterator，键值将被移动而不是拷贝。
+   * @param first 指向 std::pair<Key, Value>（或兼容类型）的前向迭代器。
+   * @param last 范围的结束迭代器。
+   */
+  template <typename ForwardIt>
+  void insert_bulk(ForwardIt first, ForwardIt last) {
+    static_assert(
+        std::is_base_of_v<
+            std::forward_iterator_tag,
+            typename std::iterator_traits<ForwardIt>::iterator_category>,
+        "insert_bulk requires forward iterators");
+
+    // 1. 按分片分组，只记录迭代器，不拷贝元素
+    std::vector<std::vector<ForwardIt> > groups(num_shards_);
+    for (ForwardIt it = first; it != last; ++it) {
+      groups[shard_index((*it).first)].push_back(it);
+    }
+
+    // 2. 每个分片加锁一次，并预留好容量，避免写入过程中反复重哈希
+    for (size_t i = 0; i < num_shards_; ++i) {
+      if (groups[i].empty()) {
+        continue;
+      }
+      Shard& shard = shards_[i];
+      auto lock = lock_shard(shard);
+      shard.map_.reserve(shard.map_.size() + groups[i].size());
+      for (ForwardIt it : groups[i]) {
+        auto&& item = *it;
+        shard.map_.insert_or_assign(
+            std::forward<decltype(item)>(item).first,
+            std::forward<decltype(item)>(item).second);
+      }
+    }
+  }
+
+  /**
+   * @brief 为预期的元素总数预先分配各分片的桶，避免批量加载时反复重哈希。
+   * @param expected_size 预期的元素总数。
+   */
+  void reserve(size_t expected_size) {
+    const size_t per_shard = expected_size / num_shards_ + 1;
+    for (size_t i = 0; i < num_shards_; ++i) {
+      auto lock = lock_shard(shards_[i]);
+      shards_[i].map_.reserve(per_shard);
+    }
+  }
+
+  /**
+   * @brief 逐个分片遍历所有元素。
+   * 遍历某个分片时只持有该分片的锁，因此结果不是整张表的一致性快照。
+   * 注意：fn 在分片锁内执行，不能再访问本哈希表。
+   * @param fn 可调用对象，签名为 void(const Key&, Value&)。
+   */
+  template <typename F>
+  void for_each(F&& fn) {
+    for (size_t i = 0; i < num_shards_; ++i) {
+      for_each_in_shard(shards_[i], fn);
+    }
+  }
+
+  /**
+   * @brief for_each 的只读版本，fn 的签名为 void(const Key&, const Value&)。
+   */
+  template <typename F>
+  void for_each(F&& fn) const {
+    for (size_t i = 0; i < num_shards_; ++i) {
+      auto lock = lock_shard(shards_[i]);
+      for (const auto& entry : shards_[i].map_) {
+        fn(entry.first, entry.second);
+      }
+    }
+  }
+
+  /**
+   * @brief 在线程池上并行遍历所有元素，每个分片作为一个独立任务。
+   * 每个任务只持有自己分片的锁，因此全量扫描可以随核数扩展。
+   * 此函数会阻塞直到所有分片处理完毕，fn 抛出的第一个异常会被重新抛出。
+   * 如果线程池拒绝提交（QueueFullError、AdmissionRejected 或已停止），其余分片不再提交，
+   * 等已提交的任务结束后重新抛出该异常。
+   * 注意：
+   *  1. fn 会被多个线程并发调用，必须是线程安全的；
+   *  2. 不要在同一线程池的工作线程中调用，否则可能因等待自身而死锁。
+   * @param pool 执行遍历任务的线程池。
+   * @param fn 可调用对象，签名为 void(const Key&, Value&)。
+   */
+  template <typename F>
+  void parallel_for_each(ThreadPool& pool, F&& fn) {
+    std::vector<std::future<void> > futures;
+    futures.reserve(num_shards_);
+    std::exception_ptr first_error;
+    try {
+      for (size_t i = 0; i < num_shards_; ++i) {
+        futures.push_back(pool.submit(
+            [this, i, &fn]() { for_each_in_shard(shards_[i], fn); }));
+      }
+    } catch (...) {
+      // 提交失败：已提交的任务仍引用 fn，必须等它们结束后才能抛出
+      first_error = std::current_exception();
+    }
+    // 等待所有任务结束后再抛出异常，保证 fn 不会在返回后仍被调用
+    for (auto& future : futures) {
+      try {
+        future.get();
+      } catch (...) {
+        if (!first_error) {
+          first_error = std::current_exception();
+        }
+      }
+    }
+    if (first_error) {
+      std::rethrow_exception(first_error);
+    }
+  }
+
+  /**
+   * @brief 移除所有满足谓词的元素，逐个分片加锁处理。
+   * 典型用途是定期扫描并清理过期的条目。
+   * @param pred 谓词，签名为 bool(const Key&, const Value&)。
+   * @return 被移除的元素数量。
+   */
+  template <typename Pred>
+  size_t erase_if(Pred&& pred) {
+    size_t removed = 0;
+    for (size_t i = 0; i < num_shards_; ++i) {
+      auto lock = lock_shard(shards_[i]);
+      auto& map = shards_[i].map_;
+      for (auto it = map.begin(); it != map.end();) {
+        if (pred(static_cast<const Key&>(it->first),
+                 static_cast<const Value&>(it->second))) {
+          it = map.erase(it);
+          ++removed;
+        } else {
+          ++it;
+        }
+      }
+    }
+    return removed;
+  }
+
+  /**
+   * @brief 获取分片数量（总是 2 的幂）。
+   */
+  size_t shard_count() const { return num_shards_; }
+
+  /**
+   * @brief 获取每个分片的元素数量与锁争用统计，用于诊断热点分片。
+   */
+  std::vector<ShardStats> shard_stats() const {
+    std::vector<ShardStats> stats;
+    stats.reserve(num_shards_);
+    for (size_t i = 0; i < num_shards_; ++i) {
+      const Shard& shard = shards_[i];
+      size_t size = 0;
+      {
+        // 直接加锁，读取统计本身不计入统计
+        std::unique_lock<std::mutex> lock(shard.mutex_);
+        size = shard.map_.size();
+      }
+      stats.push_back(
+          {size, shard.lock_acquisitions_.load(std::memory_order_relaxed),
+           shard.lock_contentions_.load(std::memory_order_relaxed)});
+    }
+    return stats;
+  }
+
+  /**
+   * @brief 将所有分片的锁统计清零。
+   */
+  void reset_stats() {
+    for (size_t i = 0; i < num_shards_; ++i) {
+      shards_[i].lock_acquisitions_.store(0, std::memory_order_relaxed);
+      shards_[i].lock_contentions_.store(0, std::memory_order_relaxed);
+    }
+  }
+
   /**
    * @brief 获取哈希表中的元素总数。
    * 注意：这是一个估算值，因为在计算时其他线程可能正在修改。
@@ -123,28 +508,94 @@ class ConcurrentHashMap {
   size_t size() const {
     size_t total_size = 0;
     for (size_t i = 0; i < num_shards_; ++i) {
-      std::unique_lock<std::mutex> lock(shards_[i].mutex_);
+      auto lock = lock_shard(shards_[i]);
       total_size += shards_[i].map_.size();
     }
     return total_size;
   }
 
  private:
+  // 访问的公共实现；Self 可能带 const，据此决定传给 fn 的值是否可修改
+  template <typename Self, typename K, typename F>
+  static bool visit_impl(Self& self, const K& key, F&& fn) {
+    auto& shard = self.get_shard(key);
+    auto lock = lock_shard(shard);
+    using MapType = decltype(shard.map_);
+    std::conditional_t<std::is_const_v<Self>, const MapType&, MapType&> map =
+        shard.map_;
+    auto it = find_in(map, key);
+    if (it == map.end()) {
+      return false;
+    }
+    std::forward<F>(fn)(it->second);
+    return true;
+  }
+
+  /**
+   * @brief 在分片内查找键，异构键在标准库支持时直接查找。
+   * C++17 的 unordered_map 不支持异构查找，此时退化为复用一个线程局部的
+   * 临时键（对 std::string 等类型，复用其容量即可避免每次查找都分配内存）。
+   */
+  template <typename Map, typename K>
+  static auto find_in(Map& map, const K& key) {
+#if defined(__cpp_lib_generic_unordered_lookup)
+    return map.find(key);
+#else
+    if constexpr (std::is_same_v<K, Key>) {
+      return map.find(key);
+    } else if constexpr (std::is_assignable_v<Key&, const K&> &&
+                         std::is_default_constructible_v<Key>) {
+      thread_local Key scratch;
+      scratch = key;
+      return map.find(scratch);
+    } else {
+      return map.find(Key(key));
+    }
+#endif
+  }
+
   /**
    * @brief 根据键的哈希值获取对应的分片。
-   * @param key 键。
+   * @param key 键（或可与键比较的异构类型）。
    * @return 对应的分片引用。
    */
-  Shard& get_shard(const Key& key) const {
-    // 1. 计算键的哈希值
-    size_t hash_val = hasher_(key);
-    // 2. 通过取模找到分片索引
-    size_t shard_index = hash_val % num_shards_;
-    return shards_[shard_index];
+  template <typename K>
+  Shard& get_shard(const K& key) const {
+    return shards_[shard_index(key)];
+  }
+
+  template <typename K>
+  size_t shard_index(const K& key) const {
+    // 1. 计算键的哈希值，并做一次强位混合。
+    //    std::hash<int> 等通常是恒等函数，直接取低位会让连续的键挤在少数分片上
+    const std::uint64_t hash_val = detail::mix_hash(hasher_(key));
+    // 2. 分片数是 2 的幂，用掩码代替取模
+    return static_cast<size_t>(hash_val) & shard_mask_;
+  }
+
+  // 获取分片锁，并记录获取与争用次数
+  static std::unique_lock<std::mutex> lock_shard(const Shard& shard) {
+    std::unique_lock<std::mutex> lock(shard.mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      shard.lock_contentions_.fetch_add(1, std::memory_order_relaxed);
+      lock.lock();
+    }
+    shard.lock_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    return lock;
+  }
+
+  // 持有分片锁遍历其中的元素
+  template <typename F>
+  static void for_each_in_shard(Shard& shard, F& fn) {
+    auto lock = lock_shard(shard);
+    for (auto& entry : shard.map_) {
+      fn(static_cast<const Key&>(entry.first), entry.second);
+    }
   }
 
   Hash hasher_;
   size_t num_shards_;
+  size_t shard_mask_;
   // 使用 unique_ptr<Shard[]> 来持有分片数组，确保正确的内存管理
   std::unique_ptr<Shard[]> shards_;
 };
@@ -0,0 +1,225 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>  // for std::less
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "hash_utils.hpp"
+
+namespace cppthreadflow {
+
+/**
+ * @brief 并发优先队列的出队顺序保证。
+ */
+enum class PriorityOrdering {
+  // 严格有序：每次出队的都是当前全局优先级最高的元素
+  kStrict,
+  // 宽松有序：出队的元素接近但不一定是全局最高优先级，以换取多线程下的扩展性
+  kRelaxed,
+};
+
+/**
+ * @brief 一个线程安全的优先队列（MultiQueue）。
+ *
+ * 元素分散在 k 个各自带锁的二叉堆（子队列）中：
+ * - 入队时随机选择一个子队列，用 try_lock 加锁，被占用则换一个，生产者之间几乎不争用；
+ * - 出队时随机选择两个子队列，比较它们的堆顶，取优先级更高的那个（two-choice）。
+ *
+ * 宽松模式下，出队元素在全局中的排名期望为 O(k)，没有饥饿：
+ * 任何元素都会在有限次出队后被取出。严格模式使用单个子队列，等价于互斥锁保护的堆。
+ *
+ * 与 std::priority_queue 一致，Compare 为“小于”语义时，先出队的是最大的元素。
+ *
+ * @tparam T 元素类型。
+ * @tparam Compare 比较函数，默认为 std::less<T>。
+ */
+template <typename T, typename Compare = std::less<T> >
+class ConcurrentPriorityQueue {
+ private:
+  struct alignas(kCacheLineSize) SubQueue {
+    std::mutex mutex_;
+    std::vector<T> heap_;
+    // 堆的大小，在锁外读取，用于跳过空的子队列
+    std::atomic<size_t> size_{0};
+  };
+
+ public:
+  // 宽松模式下，未指定数量时每个硬件线程对应的子队列数
+  static constexpr size_t kQueuesPerThread = 2;
+
+  /**
+   * @brief 构造一个优先队列。
+   * @param ordering 顺序保证，严格模式下只使用一个子队列。
+   * @param num_queues 宽松模式下的子队列数量，0 表示按硬件并发数自动选择。
+   * @param comp 元素的比较函数。
+   */
+  explicit ConcurrentPriorityQueue(
+      PriorityOrdering ordering = PriorityOrdering::kRelaxed,
+      size_t num_queues = 0, const Compare& comp = Compare())
+      : comp_(comp), ordering_(ordering) {
+    if (ordering == PriorityOrdering::kStrict) {
+      num_queues_ = 1;
+    } else if (num_queues != 0) {
+      num_queues_ = num_queues;
+    } else {
+      num_queues_ = kQueuesPerThread *
+                    std::max(1u, std::thread::hardware_concurrency());
+    }
+    queues_ = std::make_unique<SubQueue[]>(num_queues_);
+  }
+
+  // 禁止拷贝和移动
+  ConcurrentPriorityQueue(const ConcurrentPriorityQueue&) = delete;
+  ConcurrentPriorityQueue& operator=(const ConcurrentPriorityQueue&) = delete;
+
+  /**
+   * @brief 入队一个元素。
+   */
+  void push(const T& value) { push_impl(value); }
+
+  /**
+   * @brief 入队一个元素（移动语义）。
+   */
+  void push(T&& value) { push_impl(std::move(value)); }
+
+  /**
+   * @brief 出队一个优先级最高（宽松模式下为近似最高）的元素。
+   * @param value_out [输出参数] 如果成功，元素将被移动到这里。
+   * @return 如果成功出队返回 true；只有在依次检查过所有子队列都为空时才返回 false。
+   */
+  bool try_pop(T& value_out) {
+    if (num_queues_ > 1) {
+      for (size_t attempt = 0; attempt < kPopAttempts; ++attempt) {
+        if (try_pop_two_choice(value_out)) {
+          return true;
+        }
+      }
+    }
+    // 随机选择失败（子队列大多为空或都被占用），从随机位置开始逐个检查
+    const size_t start = random_index();
+    for (size_t i = 0; i < num_queues_; ++i) {
+      SubQueue& queue = queues_[(start + i) % num_queues_];
+      if (queue.size_.load(std::memory_order_relaxed) == 0) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(queue.mutex_);
+      if (!queue.heap_.empty()) {
+        pop_locked(queue, value_out);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief 获取元素数量（并发修改时为近似值）。
+   */
+  size_t size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < num_queues_; ++i) {
+      total += queues_[i].size_.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  /**
+   * @brief 检查队列是否为空（并发修改时为近似值）。
+   */
+  bool empty() const { return size() == 0; }
+
+  /**
+   * @brief 获取顺序保证。
+   */
+  PriorityOrdering ordering() const { return ordering_; }
+
+  /**
+   * @brief 获取子队列数量。
+   */
+  size_t queue_count() const { return num_queues_; }
+
+ private:
+  // 入队时 try_lock 失败多少次后改为阻塞加锁
+  static constexpr size_t kPushAttempts = 8;
+  // 出队时 two-choice 的尝试次数，之后退化为顺序检查
+  static constexpr size_t kPopAttempts = 8;
+
+  size_t random_index() const {
+    return static_cast<size_t>(detail::thread_random() % num_queues_);
+  }
+
+  template <typename V>
+  void push_impl(V&& value) {
+    if (num_queues_ > 1) {
+      for (size_t attempt = 0; attempt < kPushAttempts; ++attempt) {
+        SubQueue& queue = queues_[random_index()];
+        std::unique_lock<std::mutex> lock(queue.mutex_, std::try_to_lock);
+        if (lock.owns_lock()) {
+          push_locked(queue, std::forward<V>(value));
+          return;
+        }
+      }
+    }
+    SubQueue& queue = queues_[random_index()];
+    std::unique_lock<std::mutex> lock(queue.mutex_);
+    push_locked(queue, std::forward<V>(value));
+  }
+
+  // 随机选择两个不同的子队列，从堆顶优先级更高的那个出队
+  bool try_pop_two_choice(T& value_out) {
+    const size_t i = random_index();
+    const size_t j =
+        (i + 1 + detail::thread_random() % (num_queues_ - 1)) % num_queues_;
+    SubQueue* first = &queues_[i];
+    SubQueue* second = &queues_[j];
+    if (first->size_.load(std::memory_order_relaxed) == 0) {
+      std::swap(first, second);
+    }
+    if (first->size_.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+
+    std::unique_lock<std::mutex> first_lock(first->mutex_, std::try_to_lock);
+    if (!first_lock.owns_lock() || first->heap_.empty()) {
+      return false;
+    }
+    SubQueue* target = first;
+    std::unique_lock<std::mutex> second_lock;
+    if (second->size_.load(std::memory_order_relaxed) != 0) {
+      second_lock = std::unique_lock<std::mutex>(second->mutex_, std::try_to_lock);
+      // 第二个子队列被占用时不等待，直接使用第一个
+      if (second_lock.owns_lock() && !second->heap_.empty() &&
+          comp_(first->heap_.front(), second->heap_.front())) {
+        target = second;
+      }
+    }
+    pop_locked(*target, value_out);
+    return true;
+  }
+
+  template <typename V>
+  void push_locked(SubQueue& queue, V&& value) {
+    queue.heap_.push_back(std::forward<V>(value));
+    std::push_heap(queue.heap_.begin(), queue.heap_.end(), comp_);
+    queue.size_.store(queue.heap_.size(), std::memory_order_relaxed);
+  }
+
+  void pop_locked(SubQueue& queue, T& value_out) {
+    std::pop_heap(queue.heap_.begin(), queue.heap_.end(), comp_);
+    value_out = std::move(queue.heap_.back());
+    queue.heap_.pop_back();
+    queue.size_.store(queue.heap_.size(), std::memory_order_relaxed);
+  }
+
+  Compare comp_;
+  const PriorityOrdering ordering_;
+  size_t num_queues_;
+  std::unique_ptr<SubQueue[]> queues_;
+};
+
+}  // namespace cppthreadflow
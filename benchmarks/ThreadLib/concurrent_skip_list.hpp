@@ -0,0 +1,531 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>  // for std::less
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "epoch_reclaimer.hpp"
+#include "hash_utils.hpp"
+#include "pool_allocator.hpp"
+#include "spin_lock.hpp"
+
+namespace cppthreadflow {
+
+/**
+ * @brief 一个基于乐观细粒度锁的并发有序映射（懒惰跳表）。
+ *
+ * 采用 Herlihy 等人提出的 lazy skip list 算法：
+ * - 查找完全无锁，只沿 next 指针前进，不写任何共享数据；
+ * - 插入和删除先无锁地定位各层前驱，再只锁住这些前驱节点并校验它们仍然有效，
+ *   校验失败则重试，因此不同位置的修改可以完全并行；
+ * - 节点带有 marked（逻辑删除）和 fully_linked（各层均已链入）两个标志，
+ *   只有 fully_linked 且未被 marked 的节点才被视为存在。
+ *
+ * 被删除的节点通过 EpochReclaimer 延迟释放；节点内存来自按高度划分的 FixedSizePool。
+ * 值在插入后不可修改，读取时直接拷贝，无需加锁；需要更新值时请先 erase 再 insert。
+ *
+ * 遍历（for_each / for_each_in_range）是弱一致的：不会访问到已释放的节点，
+ * 也不会重复访问同一个键，但可能看到也可能看不到遍历期间并发插入或删除的元素。
+ *
+ * @tparam Key 键类型。
+ * @tparam Value 值类型，需要可拷贝。
+ * @tparam Compare 键的严格弱序比较函数，默认为 std::less<Key>。
+ */
+template <typename Key, typename Value, typename Compare = std::less<Key> >
+class ConcurrentSkipListMap {
+ public:
+  // 最大层数；每层以 1/4 的概率向上增长，足以支撑数十亿个元素
+  static constexpr int kMaxHeight = 16;
+
+ private:
+  struct Node {
+    explicit Node(int h) : height(h) {}
+    // item 由 create_node/destroy_node 手动构造和析构，头节点不构造它
+    ~Node() {}
+
+    const Key& key() const { return item.first; }
+
+    union {
+      std::pair<const Key, Value> item;
+    };
+    const int height;
+    SpinLock lock;
+    std::atomic<bool> marked{false};
+    std::atomic<bool> fully_linked{false};
+    // 实际长度为 height，其余元素紧跟在节点之后分配
+    std::atomic<Node*> next[1];
+  };
+
+ public:
+  /**
+   * @brief 构造一个空的跳表。
+   * @param comp 键的比较函数。
+   */
+  explicit ConcurrentSkipListMap(const Compare& comp = Compare())
+      : comp_(comp), head_(create_head()) {}
+
+  /**
+   * @brief 析构函数。此时不应再有其他线程访问跳表。
+   */
+  ~ConcurrentSkipListMap() {
+    Node* node = head_->next[0].load(std::memory_order_relaxed);
+    while (node != nullptr) {
+      Node* next = node->next[0].load(std::memory_order_relaxed);
+      destroy_node(node);
+      node = next;
+    }
+    destroy_head(head_);
+  }
+
+  // 禁止拷贝和移动
+  ConcurrentSkipListMap(const ConcurrentSkipListMap&) = delete;
+  ConcurrentSkipListMap& operator=(const ConcurrentSkipListMap&) = delete;
+
+  /**
+   * @brief 插入一个键值对（仅当键不存在时）。
+   * @param key 键。
+   * @param value 值（完美转发）。
+   * @return 如果插入成功返回 true，如果键已存在返回 false。
+   */
+  template <typename V>
+  bool insert(const Key& key, V&& value) {
+    const int height = random_height();
+    Node* preds[kMaxHeight];
+    Node* succs[kMaxHeight];
+    Node* new_node = nullptr;
+    EpochGuard guard;
+    while (true) {
+      const int found = find_position(key, preds, succs);
+      if (found != -1) {
+        Node* existing = succs[found];
+        if (!existing->marked.load(std::memory_order_acquire)) {
+          // 键已存在：等待其插入完成，保证返回 false 之后一定能查到它
+          while (!existing->fully_linked.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+          }
+          if (new_node != nullptr) {
+            destroy_node(new_node);
+          }
+          return false;
+        }
+        // 键正在被删除，等删除完成后重试
+        continue;
+      }
+      if (new_node == nullptr) {
+        // 在加锁之前构造节点，避免在持有锁时分配内存或拷贝键值
+        new_node = create_node(height, key, std::forward<V>(value));
+      }
+
+      int highest_locked = -1;
+      bool valid = true;
+      Node* prev_pred = nullptr;
+      for (int level = 0; valid && level < height; ++level) {
+        Node* pred = preds[level];
+        Node* succ = succs[level];
+        if (pred != prev_pred) {
+          pred->lock.lock();
+          highest_locked = level;
+          prev_pred = pred;
+        }
+        valid = !pred->marked.load(std::memory_order_acquire) &&
+                (succ == nullptr ||
+                 !succ->marked.load(std::memory_order_acquire)) &&
+                pred->next[level].load(std::memory_order_acquire) == succ;
+      }
+      if (!valid) {
+        unlock_preds(preds, highest_locked);
+        continue;
+      }
+
+      for (int level = 0; level < height; ++level) {
+        new_node->next[level].store(succs[level], std::memory_order_relaxed);
+      }
+      for (int level = 0; level < height; ++level) {
+        preds[level]->next[level].store(new_node, std::memory_order_release);
+      }
+      new_node->fully_linked.store(true, std::memory_order_release);
+      unlock_preds(preds, highest_locked);
+      size_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  /**
+   * @brief 查找一个键。
+   * @param key 要查找的键。
+   * @param value_out [输出参数] 如果找到，值将被拷贝到这里。
+   * @return 如果找到返回 true，否则返回 false。
+   */
+  bool find(const Key& key, Value& value_out) const {
+    EpochGuard guard;
+    const Node* node = find_node(key);
+    if (node == nullptr || !is_live(node)) {
+      return false;
+    }
+    value_out = node->item.second;
+    return true;
+  }
+
+  /**
+   * @brief 检查一个键是否存在。
+   */
+  bool contains(const Key& key) const {
+    EpochGuard guard;
+    const Node* node = find_node(key);
+    return node != nullptr && is_live(node);
+  }
+
+  /**
+   * @brief 查找第一个不小于 key 的元素。
+   * @param key 要比较的键。
+   * @param key_out [输出参数] 如果找到，键将被拷贝到这里。
+   * @param value_out [输出参数] 如果找到，值将被拷贝到这里。
+   * @return 如果存在这样的元素返回 true，否则返回 false。
+   */
+  bool lower_bound(const Key& key, Key& key_out, Value& value_out) const {
+    EpochGuard guard;
+    const Node* node = first_live_from(lower_bound_node(key));
+    if (node == nullptr) {
+      return false;
+    }
+    key_out = node->key();
+    value_out = node->item.second;
+    return true;
+  }
+
+  /**
+   * @brief 删除一个键。
+   * @return 如果成功删除返回 true，如果键不存在返回 false。
+   */
+  bool erase(const Key& key) {
+    Node* preds[kMaxHeight];
+    Node* succs[kMaxHeight];
+    Node* victim = nullptr;
+    bool is_marked = false;
+    int height = -1;
+    EpochGuard guard;
+    while (true) {
+      const int found = find_position(key, preds, succs);
+      if (found != -1) {
+        victim = succs[found];
+      }
+      if (!is_marked) {
+        // 只删除已完整链入、且是在其最高层被找到的节点
+        if (found == -1 ||
+            !victim->fully_linked.load(std::memory_order_acquire) ||
+            victim->height - 1 != found ||
+            victim->marked.load(std::memory_order_acquire)) {
+          return false;
+        }
+        height = victim->height;
+        victim->lock.lock();
+        if (victim->marked.load(std::memory_order_relaxed)) {
+          // 其他线程抢先删除了它
+          victim->lock.unlock();
+          return false;
+        }
+        // 逻辑删除：从这一刻起查找将看不到该键
+        victim->marked.store(true, std::memory_order_release);
+        is_marked = true;
+      }
+
+      int highest_locked = -1;
+      bool valid = true;
+      Node* prev_pred = nullptr;
+      for (int level = 0; valid && level < height; ++level) {
+        Node* pred = preds[level];
+        if (pred != prev_pred) {
+          pred->lock.lock();
+          highest_locked = level;
+          prev_pred = pred;
+        }
+        valid = !pred->marked.load(std::memory_order_acquire) &&
+                pred->next[level].load(std::memory_order_acquire) == victim;
+      }
+      if (!valid) {
+        unlock_preds(preds, highest_locked);
+        continue;
+      }
+
+      // 物理删除：自顶向下摘除，victim 自身的 next 指针保持不变，
+      // 正停留在 victim 上的遍历者仍能继续向后走
+      for (int level = height - 1; level >= 0; --level) {
+        preds[level]->next[level].store(
+            victim->next[level].load(std::memory_order_relaxed),
+            std::memory_order_release);
+      }
+      victim->lock.unlock();
+      unlock_preds(preds, highest_locked);
+      size_.fetch_sub(1, std::memory_order_relaxed);
+      EpochReclaimer::instance().retire(victim, &reclaim_node);
+      return true;
+    }
+  }
+
+  /**
+   * @brief 按键的升序遍历所有元素（弱一致）。
+   * @param fn 可调用对象，签名为 void(const Key&, const Value&) 或
+   * bool(const Key&, const Value&)；返回 false 时提前结束遍历。
+   * 遍历期间当前线程处于 EBR 临界区内，fn 不应长时间阻塞。
+   */
+  template <typename F>
+  void for_each(F&& fn) const {
+    EpochGuard guard;
+    for (const Node* node = head_->next[0].load(std::memory_order_acquire);
+         node != nullptr; node = node->next[0].load(std::memory_order_acquire)) {
+      if (is_live(node) && !visit_item(fn, node)) {
+        return;
+      }
+    }
+  }
+
+  /**
+   * @brief 按键的升序遍历区间 [from, to) 内的元素（弱一致）。
+   * @param from 区间下界（包含）。
+   * @param to 区间上界（不包含）。
+   * @param fn 同 for_each。
+   */
+  template <typename F>
+  void for_each_in_range(const Key& from, const Key& to, F&& fn) const {
+    EpochGuard guard;
+    for (const Node* node = lower_bound_node(from);
+         node != nullptr && comp_(node->key(), to);
+         node = node->next[0].load(std::memory_order_acquire)) {
+      if (is_live(node) && !visit_item(fn, node)) {
+        return;
+      }
+    }
+  }
+
+  /**
+   * @brief 获取元素数量（并发修改时为近似值）。
+   */
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 检查跳表是否为空（并发修改时为近似值）。
+   */
+  bool empty() const { return size() == 0; }
+
+ private:
+  static size_t node_size(int height) {
+    return sizeof(Node) + (height - 1) * sizeof(std::atomic<Node*>);
+  }
+
+  // 每种高度一个内存池。池被有意泄漏：已退休的节点可能直到进程退出、
+  // EpochReclaimer 析构时才被释放，池必须比所有跳表实例和回收器都活得更久。
+  static FixedSizePool& node_pool(int height) {
+    static FixedSizePool** const pools = [] {
+      auto** result = new FixedSizePool*[kMaxHeight];
+      for (int h = 1; h <= kMaxHeight; ++h) {
+        result[h - 1] = new FixedSizePool(node_size(h));
+      }
+      return result;
+    }();
+    return *pools[height - 1];
+  }
+
+  static Node* construct_node(int height) {
+    static_assert(alignof(Node) <= alignof(std::max_align_t),
+                  "FixedSizePool only guarantees max_align_t alignment");
+    Node* node = new (node_pool(height).allocate()) Node(height);
+    for (int level = 1; level < height; ++level) {
+      new (&node->next[level]) std::atomic<Node*>(nullptr);
+    }
+    node->next[0].store(nullptr, std::memory_order_relaxed);
+    return node;
+  }
+
+  template <typename V>
+  static Node* create_node(int height, const Key& key, V&& value) {
+    Node* node = construct_node(height);
+    try {
+      new (&node->item)
+          std::pair<const Key, Value>(key, std::forward<V>(value));
+    } catch (...) {
+      destroy_head(node);
+      throw;
+    }
+    return node;
+  }
+
+  static Node* create_head() { return construct_node(kMaxHeight); }
+
+  // 释放节点内存但不析构 item（用于头节点和构造失败的节点）
+  static void destroy_head(Node* node) {
+    const int height = node->height;
+    node->~Node();
+    node_pool(height).deallocate(node);
+  }
+
+  static void destroy_node(Node* node) {
+    node->item.~pair();
+    destroy_head(node);
+  }
+
+  // EpochReclaimer 的删除回调
+  static void reclaim_node(void* ptr) { destroy_node(static_cast<Node*>(ptr)); }
+
+  // 几何分布的随机高度
+  static int random_height() {
+    std::uint64_t bits = detail::thread_random();
+    int height = 1;
+    while (height < kMaxHeight && (bits & 3) == 0) {
+      ++height;
+      bits >>= 2;
+    }
+    return height;
+  }
+
+  static bool is_live(const Node* node) {
+    return node->fully_linked.load(std::memory_order_acquire) &&
+           !node->marked.load(std::memory_order_acquire);
+  }
+
+  // 记录每一层的前驱和后继，返回键所在的最高层，未找到返回 -1
+  int find_position(const Key& key, Node** preds, Node** succs) const {
+    int found = -1;
+    Node* pred = head_;
+    for (int level = kMaxHeight - 1; level >= 0; --level) {
+      Node* curr = pred->next[level].load(std::memory_order_acquire);
+      while (curr != nullptr && comp_(curr->key(), key)) {
+        pred = curr;
+        curr = pred->next[level].load(std::memory_order_acquire);
+      }
+      if (found == -1 && curr != nullptr && !comp_(key, curr->key())) {
+        found = level;
+      }
+      preds[level] = pred;
+      succs[level] = curr;
+    }
+    return found;
+  }
+
+  // 返回键等于 key 的节点（不检查是否存活），不存在返回 nullptr
+  const Node* find_node(const Key& key) const {
+    const Node* node = lower_bound_node(key);
+    return node != nullptr && !comp_(key, node->key()) ? node : nullptr;
+  }
+
+  // 返回第 0 层上第一个键不小于 key 的节点（不检查是否存活）
+  const Node* lower_bound_node(const Key& key) const {
+    const Node* pred = head_;
+    const Node* curr = nullptr;
+    for (int level = kMaxHeight - 1; level >= 0; --level) {
+      curr = pred->next[level].load(std::memory_order_acquire);
+      while (curr != nullptr && comp_(curr->key(), key)) {
+        pred = curr;
+        curr = pred->next[level].load(std::memory_order_acquire);
+      }
+    }
+    return curr;
+  }
+
+  static const Node* first_live_from(const Node* node) {
+    while (node != nullptr && !is_live(node)) {
+      node = node->next[0].load(std::memory_order_acquire);
+    }
+    return node;
+  }
+
+  // 按与加锁相同的规则释放前驱节点的锁（相邻层的相同前驱只锁一次）
+  static void unlock_preds(Node* const* preds, int highest_locked) {
+    Node* prev_pred = nullptr;
+    for (int level = 0; level <= highest_locked; ++level) {
+      if (preds[level] != prev_pred) {
+        preds[level]->lock.unlock();
+        prev_pred = preds[level];
+      }
+    }
+  }
+
+  // 调用遍历回调，返回是否继续遍历
+  template <typename F>
+  static bool visit_item(F& fn, const Node* node) {
+    if constexpr (std::is_same_v<
+                      std::invoke_result_t<F&, const Key&, const Value&>,
+                      bool>) {
+      return fn(node->key(), node->item.second);
+    } else {
+      fn(node->key(), node->item.second);
+      return true;
+    }
+  }
+
+  Compare comp_;
+  Node* const head_;
+  std::atomic<size_t> size_{0};
+};
+
+/**
+ * @brief 基于 ConcurrentSkipListMap 的并发有序集合。
+ *
+ * @tparam Key 元素类型。
+ * @tparam Compare 元素的严格弱序比较函数，默认为 std::less<Key>。
+ */
+template <typename Key, typename Compare = std::less<Key> >
+class ConcurrentSkipListSet {
+ public:
+  explicit ConcurrentSkipListSet(const Compare& comp = Compare())
+      : map_(comp) {}
+
+  /**
+   * @brief 插入一个元素。
+   * @return 如果插入成功返回 true，如果元素已存在返回 false。
+   */
+  bool insert(const Key& key) { return map_.insert(key, Empty{}); }
+
+  /**
+   * @brief 删除一个元素。
+   * @return 如果成功删除返回 true，否则返回 false。
+   */
+  bool erase(const Key& key) { return map_.erase(key); }
+
+  /**
+   * @brief 检查一个元素是否存在。
+   */
+  bool contains(const Key& key) const { return map_.contains(key); }
+
+  /**
+   * @brief 查找第一个不小于 key 的元素。
+   * @param key 要比较的值。
+   * @param key_out [输出参数] 如果找到，元素将被拷贝到这里。
+   * @return 如果存在这样的元素返回 true，否则返回 false。
+   */
+  bool lower_bound(const Key& key, Key& key_out) const {
+    Empty unused;
+    return map_.lower_bound(key, key_out, unused);
+  }
+
+  /**
+   * @brief 按升序遍历所有元素（弱一致）。
+   * @param fn 签名为 void(const Key&) 或 bool(const Key&)；返回 false 时提前结束。
+   */
+  template <typename F>
+  void for_each(F&& fn) const {
+    map_.for_each([&fn](const Key& key, const Empty&) { return fn(key); });
+  }
+
+  /**
+   * @brief 按升序遍历区间 [from, to) 内的元素（弱一致）。
+   */
+  template <typename F>
+  void for_each_in_range(const Key& from, const Key& to, F&& fn) const {
+    map_.for_each_in_range(
+        from, to, [&fn](const Key& key, const Empty&) { return fn(key); });
+  }
+
+  size_t size() const { return map_.size(); }
+  bool empty() const { return map_.empty(); }
+
+ private:
+  struct Empty {};
+
+  ConcurrentSkipListMap<Key, Empty, Compare> map_;
+};
+
+}  // namespace cppthreadflow
@@ -0,0 +1,348 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "event_count.hpp"
+#include "hash_utils.hpp"
+
+namespace cppthreadflow {
+
+/**
+ * @brief 生产者与消费者在序号上等待时采用的策略。
+ */
+enum class WaitStrategy {
+  kBusySpin,  // 一直自旋：延迟最低，但每个等待的线程都占满一个核心
+  kYield,     // 自旋一段时间后让出 CPU
+  kBlocking,  // 自旋一段时间后通过 EventCount 挂起线程
+};
+
+/**
+ * @brief 一个独占缓存行的序号，用于表示发布进度或消费进度。
+ * 序号从 0 开始递增，kInitial 表示还没有任何事件。
+ */
+class alignas(kCacheLineSize) Sequence {
+ public:
+  static constexpr std::int64_t kInitial = -1;
+
+  std::int64_t get() const { return value_.load(std::memory_order_acquire); }
+
+  // seq_cst：与 EventCount 的等待协议配合，见 event_count.hpp
+  void set(std::int64_t value) {
+    value_.store(value, std::memory_order_seq_cst);
+  }
+
+ private:
+  std::atomic<std::int64_t> value_{kInitial};
+};
+
+/**
+ * @brief Disruptor 风格的单生产者环形缓冲区，把每个事件广播给多个消费者。
+ *
+ * 事件对象在构造时一次性分配好，生产者原地填写、消费者原地读取，
+ * 发布和消费都不需要为每个事件分配内存或拷贝。
+ * 进度完全由序号表示：
+ * - 生产者用 claim() 申请一批序号，填写事件后用 publish() 推进发布游标；
+ * - 每个消费者在自己的线程中运行，拥有自己的 Sequence，
+ *   一次取走所有已可用的事件（批量消费），处理完后才推进序号；
+ * - 消费者可以依赖其他消费者：只有当依赖都处理完某个事件后，它才能看到这个事件；
+ * - 生产者申请序号时受所有消费者中最慢的序号限制，不会覆盖未被消费的事件。
+ *
+ * @code
+ *   Disruptor<Tick> disruptor(1024, WaitStrategy::kYield);
+ *   auto& journal = disruptor.add_consumer(write_journal);
+ *   disruptor.add_consumer(update_book, {&journal});  // 在 journal 之后处理
+ *   disruptor.start();
+ *   disruptor.publish_event([&](Tick& tick) { tick.price = price; });
+ *   disruptor.shutdown();
+ * @endcode
+ *
+ * 只允许一个线程发布事件。
+ *
+ * @tparam T 事件类型，需要可默认构造；事件对象会被反复复用。
+ */
+template <typename T>
+class Disruptor {
+ public:
+  /**
+   * @brief 事件处理函数。
+   * end_of_batch 为 true 表示这是本批可用事件中的最后一个，可用于批量刷新。
+   * 处理函数抛出的异常会被忽略，以免阻塞整个流水线。
+   */
+  using Handler =
+      std::function<void(T& event, std::int64_t sequence, bool end_of_batch)>;
+
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  /**
+   * @brief 一个消费者，在 start() 之后运行在自己的线程中。
+   */
+  class Consumer {
+   public:
+    /**
+     * @brief 获取已处理完的最大序号。
+     */
+    const Sequence& sequence() const { return sequence_; }
+
+   private:
+    friend class Disruptor;
+
+    Sequence sequence_;
+    Handler handler_;
+    std::vector<const Sequence*> dependencies_;
+    std::thread thread_;
+  };
+
+  /**
+   * @brief 构造一个环形缓冲区，并预先构造所有事件对象。
+   * @param capacity 容量，会向上取整为 2 的幂。
+   * @param strategy 等待策略。
+   */
+  explicit Disruptor(size_t capacity = kDefaultCapacity,
+                     WaitStrategy strategy = WaitStrategy::kBlocking)
+      : capacity_(detail::next_power_of_two(capacity)),
+        mask_(capacity_ - 1),
+        strategy_(strategy),
+        events_(new T[capacity_]) {}
+
+  /**
+   * @brief 析构函数，等待消费者处理完已发布的事件后停止它们。
+   */
+  ~Disruptor() { shutdown(); }
+
+  // 禁止拷贝和移动
+  Disruptor(const Disruptor&) = delete;
+  Disruptor& operator=(const Disruptor&) = delete;
+
+  /**
+   * @brief 添加一个消费者，必须在 start() 之前调用。
+   * @param handler 事件处理函数。
+   * @param dependencies 必须先于这个消费者处理每个事件的其他消费者。
+   * @return 消费者的引用，可以作为后续消费者的依赖。
+   */
+  Consumer& add_consumer(
+      Handler handler, const std::vector<const Consumer*>& dependencies = {}) {
+    if (started_) {
+      throw std::logic_error("add_consumer called after start on Disruptor");
+    }
+    auto consumer = std::make_unique<Consumer>();
+    consumer->handler_ = std::move(handler);
+    for (const Consumer* dependency : dependencies) {
+      consumer->dependencies_.push_back(&dependency->sequence_);
+    }
+    consumers_.push_back(std::move(consumer));
+    return *consumers_.back();
+  }
+
+  /**
+   * @brief 为每个消费者启动一个线程。
+   */
+  void start() {
+    if (started_) {
+      return;
+    }
+    started_ = true;
+    for (auto& consumer : consumers_) {
+      Consumer* raw = consumer.get();
+      raw->thread_ = std::thread([this, raw] { run(*raw); });
+    }
+  }
+
+  /**
+   * @brief 申请 n 个连续的序号，必要时等待最慢的消费者腾出空间（仅限生产者线程）。
+   * @param n 申请的数量，不能超过容量。
+   * @return 第一个序号；申请到的序号为 [返回值, 返回值 + n)。
+   */
+  std::int64_t claim(size_t n = 1) {
+    if (n == 0 || n > capacity_) {
+      throw std::invalid_argument(
+          "Disruptor::claim size must be in [1, capacity]");
+    }
+    const std::int64_t first = claimed_ + 1;
+    const std::int64_t last = claimed_ + static_cast<std::int64_t>(n);
+    const std::int64_t wrap_point = last - static_cast<std::int64_t>(capacity_);
+    if (wrap_point > cached_gating_) {
+      wait_until([this, wrap_point] {
+        cached_gating_ = min_consumer_sequence(claimed_);
+        return wrap_point <= cached_gating_;
+      });
+    }
+    claimed_ = last;
+    return first;
+  }
+
+  /**
+   * @brief 获取某个序号对应的事件对象。
+   */
+  T& get(std::int64_t sequence) { return events_[sequence & mask_]; }
+
+  /**
+   * @brief 发布直到 sequence（含）的所有已申请事件（仅限生产者线程）。
+   */
+  void publish(std::int64_t sequence) {
+    cursor_.set(sequence);
+    signal();
+  }
+
+  /**
+   * @brief 申请一个序号，用 fill(event) 原地填写事件，然后发布。
+   */
+  template <typename Fill>
+  void publish_event(Fill&& fill) {
+    const std::int64_t sequence = claim(1);
+    fill(get(sequence));
+    publish(sequence);
+  }
+
+  /**
+   * @brief 批量申请 n 个序号，用 fill(event, i) 依次填写，然后一次性发布。
+   * @param n 事件数量，不能超过容量。
+   * @param fill 可调用对象，i 为事件在本批中的下标（从 0 开始）。
+   */
+  template <typename Fill>
+  void publish_events(size_t n, Fill&& fill) {
+    const std::int64_t first = claim(n);
+    for (size_t i = 0; i < n; ++i) {
+      fill(get(first + static_cast<std::int64_t>(i)), i);
+    }
+    publish(first + static_cast<std::int64_t>(n) - 1);
+  }
+
+  /**
+   * @brief 等待所有消费者处理完已发布的事件，然后停止并回收消费者线程。
+   * 应当由生产者线程调用；调用之后不能再发布事件。
+   */
+  void shutdown() {
+    if (!started_ || halted_.load(std::memory_order_seq_cst)) {
+      return;
+    }
+    const std::int64_t published = cursor_.get();
+    wait_until([this, published] {
+      return min_consumer_sequence(published) >= published;
+    });
+    halted_.store(true, std::memory_order_seq_cst);
+    progress_.notify_all();
+    for (auto& consumer : consumers_) {
+      if (consumer->thread_.joinable()) {
+        consumer->thread_.join();
+      }
+    }
+  }
+
+  /**
+   * @brief 获取已发布的最大序号。
+   */
+  std::int64_t cursor() const { return cursor_.get(); }
+
+  /**
+   * @brief 获取容量。
+   */
+  size_t capacity() const { return capacity_; }
+
+ private:
+  // 挂起或让出 CPU 之前先自旋重试的次数
+  static constexpr int kSpinCount = 128;
+
+  // 消费者线程的主循环：每次取走所有可用事件，处理完后推进自己的序号
+  void run(Consumer& consumer) {
+    std::int64_t next = consumer.sequence_.get() + 1;
+    while (true) {
+      std::int64_t available = Sequence::kInitial;
+      wait_until([&] {
+        available = available_sequence(consumer);
+        return available >= next || halted_.load(std::memory_order_seq_cst);
+      });
+      if (available < next) {
+        return;  // 已停止，且没有剩余事件
+      }
+      for (std::int64_t sequence = next; sequence <= available; ++sequence) {
+        try {
+          consumer.handler_(get(sequence), sequence, sequence == available);
+        } catch (...) {
+          // 忽略异常，继续处理后续事件
+        }
+      }
+      consumer.sequence_.set(available);
+      signal();
+      next = available + 1;
+    }
+  }
+
+  // 消费者可以处理到的最大序号：不超过发布游标，也不超过任何依赖
+  std::int64_t available_sequence(const Consumer& consumer) const {
+    std::int64_t available = cursor_.get();
+    for (const Sequence* dependency : consumer.dependencies_) {
+      available = std::min(available, dependency->get());
+    }
+    return available;
+  }
+
+  // 所有消费者中最小的序号；没有消费者时返回 fallback
+  std::int64_t min_consumer_sequence(std::int64_t fallback) const {
+    std::int64_t minimum = fallback;
+    for (const auto& consumer : consumers_) {
+      minimum = std::min(minimum, consumer->sequence_.get());
+    }
+    return minimum;
+  }
+
+  // 某个序号前进之后唤醒等待者；非阻塞策略下没有线程会挂起
+  void signal() {
+    if (strategy_ == WaitStrategy::kBlocking) {
+      progress_.notify_all();
+    }
+  }
+
+  // 按等待策略等待，直到 ready() 成立
+  template <typename Ready>
+  void wait_until(Ready ready) {
+    if (strategy_ == WaitStrategy::kBusySpin) {
+      while (!ready()) {
+      }
+      return;
+    }
+    for (int i = 0; i < kSpinCount; ++i) {
+      if (ready()) {
+        return;
+      }
+    }
+    while (!ready()) {
+      if (strategy_ == WaitStrategy::kYield) {
+        std::this_thread::yield();
+        continue;
+      }
+      const EventCount::Key key = progress_.prepare_wait();
+      if (ready()) {
+        progress_.cancel_wait();
+        return;
+      }
+      progress_.wait(key);
+    }
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  const WaitStrategy strategy_;
+  std::unique_ptr<T[]> events_;
+  std::vector<std::unique_ptr<Consumer> > consumers_;
+  bool started_ = false;
+
+  // 生产者独占：已申请的最大序号，以及对最慢消费者序号的缓存
+  alignas(kCacheLineSize) std::int64_t claimed_ = Sequence::kInitial;
+  std::int64_t cached_gating_ = Sequence::kInitial;
+
+  Sequence cursor_;
+  alignas(kCacheLineSize) std::atomic<bool> halted_{false};
+  EventCount progress_;
+};
+
+}  // namespace cppthreadflow
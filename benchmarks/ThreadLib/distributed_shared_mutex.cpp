@@ -0,0 +1,140 @@
+﻿#include "distributed_shared_mutex.hpp"
+#include "hash_utils.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace cppthreadflow {
+
+namespace {
+// 自动选择槽数量时的上限，避免写者扫描过多的缓存行
+constexpr size_t kMaxAutoSlots = 64;
+
+// 每个线程固定的哈希值，用于选择读者计数槽
+size_t thread_slot_hash() {
+    thread_local const size_t hash = static_cast<size_t>(
+        detail::mix_hash(std::hash<std::thread::id>{}(std::this_thread::get_id())));
+    return hash;
+}
+} // namespace
+
+DistributedSharedMutex::DistributedSharedMutex(RwPreference preference, size_t num_slots)
+    : preference_(preference) {
+    if (num_slots == 0) {
+        num_slots = std::min<size_t>(
+            kMaxAutoSlots, std::max(1u, std::thread::hardware_concurrency()));
+    }
+    num_slots_ = detail::next_power_of_two(num_slots);
+    slots_ = std::make_unique<Slot[]>(num_slots_);
+}
+
+DistributedSharedMutex::Slot& DistributedSharedMutex::my_slot() {
+    return slots_[thread_slot_hash() & (num_slots_ - 1)];
+}
+
+bool DistributedSharedMutex::no_readers() const {
+    for (size_t i = 0; i < num_slots_; ++i) {
+        if (slots_[i].readers.load(std::memory_order_seq_cst) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DistributedSharedMutex::release_slot(Slot& slot) {
+    slot.readers.fetch_sub(1, std::memory_order_seq_cst);
+    if (writer_waiting_.load(std::memory_order_seq_cst)) {
+        events_.notify_all();
+    }
+}
+
+void DistributedSharedMutex::wait_for_readers() {
+    while (!no_readers()) {
+        auto key = events_.prepare_wait();
+        if (no_readers()) {
+            events_.cancel_wait();
+            return;
+        }
+        events_.wait(key);
+    }
+}
+
+void DistributedSharedMutex::lock() {
+    writer_mutex_.lock();
+    writer_waiting_.store(true, std::memory_order_seq_cst);
+    while (true) {
+        // 先设置标志再检查槽，与读者“先加计数再检查标志”配对，二者至少有一方能看到对方
+        writer_active_.store(true, std::memory_order_seq_cst);
+        if (preference_ == RwPreference::kWriter) {
+            // 新来的读者会看到标志而让路，只需等已经进入的读者退出
+            wait_for_readers();
+            break;
+        }
+        if (no_readers()) {
+            break;
+        }
+        // 读者优先：撤回标志让读者继续进入，等到没有读者的时刻再试
+        writer_active_.store(false, std::memory_order_seq_cst);
+        events_.notify_all();
+        wait_for_readers();
+    }
+    writer_waiting_.store(false, std::memory_order_relaxed);
+}
+
+bool DistributedSharedMutex::try_lock() {
+    if (!writer_mutex_.try_lock()) {
+        return false;
+    }
+    writer_active_.store(true, std::memory_order_seq_cst);
+    if (no_readers()) {
+        return true;
+    }
+    writer_active_.store(false, std::memory_order_seq_cst);
+    writer_mutex_.unlock();
+    // 期间让路的读者需要被唤醒
+    events_.notify_all();
+    return false;
+}
+
+void DistributedSharedMutex::unlock() {
+    writer_active_.store(false, std::memory_order_seq_cst);
+    writer_mutex_.unlock();
+    events_.notify_all();
+}
+
+void DistributedSharedMutex::lock_shared() {
+    Slot& slot = my_slot();
+    while (true) {
+        slot.readers.fetch_add(1, std::memory_order_seq_cst);
+        if (!writer_active_.load(std::memory_order_seq_cst)) {
+            return;
+        }
+        // 有写者：撤回计数，等写者释放后重试
+        release_slot(slot);
+        while (writer_active_.load(std::memory_order_seq_cst)) {
+            auto key = events_.prepare_wait();
+            if (!writer_active_.load(std::memory_order_seq_cst)) {
+                events_.cancel_wait();
+                break;
+            }
+            events_.wait(key);
+        }
+    }
+}
+
+bool DistributedSharedMutex::try_lock_shared() {
+    Slot& slot = my_slot();
+    slot.readers.fetch_add(1, std::memory_order_seq_cst);
+    if (!writer_active_.load(std::memory_order_seq_cst)) {
+        return true;
+    }
+    release_slot(slot);
+    return false;
+}
+
+void DistributedSharedMutex::unlock_shared() {
+    release_slot(my_slot());
+}
+
+} // namespace cppthreadflow
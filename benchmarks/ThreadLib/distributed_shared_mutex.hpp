@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include "cache_line.hpp"
+#include "event_count.hpp"
+
+namespace cppthreadflow {
+
+/**
+ * @brief 读写锁在读者与写者竞争时的偏好。
+ */
+enum class RwPreference {
+  // 写者优先：写者一旦开始等待，新来的读者就让路，写者不会饿死
+  kWriter,
+  // 读者优先：只要还有读者，写者就退让，读者不会被写者阻塞
+  kReader,
+};
+
+/**
+ * @brief 面向读多写少场景的可扩展读写锁（big-reader 锁）。
+ *
+ * std::shared_mutex 的所有读者都修改同一个计数器，读多的时候这条缓存行在核间
+ * 来回迁移，读的吞吐量反而随线程数下降。这里把读者计数分散到多个各占一条缓存行
+ * 的槽中，每个线程固定使用按线程标识哈希得到的槽：
+ * - 读者在自己的槽上加一，再检查写者标志，没有写者就直接进入，全程不碰共享的写入位置；
+ * - 写者互相串行，设置写者标志后等待所有槽归零。
+ * 代价是写者需要扫描所有槽，适合读取次数远多于写入的配置表、路由表等。
+ *
+ * 满足 Lockable 与 SharedLockable 要求，可与 std::unique_lock、std::shared_lock 搭配使用。
+ * unlock_shared() 必须在调用 lock_shared() 的同一线程中调用。
+ */
+class DistributedSharedMutex {
+ public:
+  /**
+   * @brief 构造函数。
+   * @param preference 读写竞争时的偏好。
+   * @param num_slots 读者计数槽的数量（向上取整为 2 的幂），0 表示按硬件并发数选择。
+   */
+  explicit DistributedSharedMutex(
+      RwPreference preference = RwPreference::kWriter, size_t num_slots = 0);
+
+  // 禁止拷贝和移动
+  DistributedSharedMutex(const DistributedSharedMutex&) = delete;
+  DistributedSharedMutex& operator=(const DistributedSharedMutex&) = delete;
+  DistributedSharedMutex(DistributedSharedMutex&&) = delete;
+  DistributedSharedMutex& operator=(DistributedSharedMutex&&) = delete;
+
+  /**
+   * @brief 以独占（写）方式加锁。
+   */
+  void lock();
+
+  /**
+   * @brief 尝试以独占方式加锁，有其他写者或读者时立即返回 false。
+   */
+  bool try_lock();
+
+  /**
+   * @brief 释放独占锁。
+   */
+  void unlock();
+
+  /**
+   * @brief 以共享（读）方式加锁。
+   */
+  void lock_shared();
+
+  /**
+   * @brief 尝试以共享方式加锁，有写者时立即返回 false。
+   */
+  bool try_lock_shared();
+
+  /**
+   * @brief 释放共享锁。
+   */
+  void unlock_shared();
+
+  /**
+   * @brief 获取读写竞争时的偏好。
+   */
+  RwPreference preference() const { return preference_; }
+
+  /**
+   * @brief 获取读者计数槽的数量。
+   */
+  size_t slot_count() const { return num_slots_; }
+
+ private:
+  struct alignas(kCacheLineSize) Slot {
+    std::atomic<size_t> readers{0};
+  };
+
+  Slot& my_slot();
+  bool no_readers() const;
+  // 读者撤回在槽上的计数，必要时唤醒等待读者退出的写者
+  void release_slot(Slot& slot);
+  // 写者等待所有读者退出
+  void wait_for_readers();
+
+  const RwPreference preference_;
+  size_t num_slots_;
+  std::unique_ptr<Slot[]> slots_;
+
+  // 写者之间互斥
+  std::mutex writer_mutex_;
+  // 写者持有锁（或在写者优先模式下正在等待），读者需要让路
+  alignas(kCacheLineSize) std::atomic<bool> writer_active_{false};
+  // 有写者在等待读者退出，读者释放时需要通知
+  std::atomic<bool> writer_waiting_{false};
+  EventCount events_;
+};
+
+}  // namespace cppthreadflow
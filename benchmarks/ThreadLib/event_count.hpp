@@ -0,0 +1,107 @@
+﻿#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace cppthreadflow {
+
+/**
+ * @brief 事件计数器 (EventCount)，让无锁数据结构在“没有数据可取”时挂起线程。
+ *
+ * 无锁队列本身不带条件变量。EventCount 提供一种不会丢失唤醒的等待协议：
+ * @code
+ *   // 等待方
+ *   while (!try_pop(item)) {
+ *     auto key = ec.prepare_wait();
+ *     if (try_pop(item)) { ec.cancel_wait(); break; }  // 登记后必须再检查一次
+ *     ec.wait(key);
+ *   }
+ *   // 通知方
+ *   publish(item);   // 必须是 seq_cst 的原子写或读-改-写
+ *   ec.notify();
+ * @endcode
+ * 没有线程在等待时，notify() 只有一次原子读，不会进入互斥锁，因此快路径上几乎没有开销。
+ */
+class EventCount {
+ public:
+  using Key = std::uint32_t;
+
+  EventCount() = default;
+
+  // 禁止拷贝和移动
+  EventCount(const EventCount&) = delete;
+  EventCount& operator=(const EventCount&) = delete;
+
+  /**
+   * @brief 登记为等待者，并返回当前的纪元。
+   * 之后必须再检查一次等待条件，再调用 wait() 或 cancel_wait()。
+   */
+  Key prepare_wait() {
+    const std::uint64_t prev =
+        state_.fetch_add(kWaiterInc, std::memory_order_seq_cst);
+    return static_cast<Key>(prev >> kEpochShift);
+  }
+
+  /**
+   * @brief 条件已经满足，撤销 prepare_wait() 的登记。
+   */
+  void cancel_wait() { state_.fetch_sub(kWaiterInc, std::memory_order_seq_cst); }
+
+  /**
+   * @brief 阻塞，直到 prepare_wait() 之后有人调用了 notify()。
+   * @param key prepare_wait() 的返回值。
+   */
+  void wait(Key key) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this, key] {
+        return static_cast<Key>(state_.load(std::memory_order_seq_cst) >>
+                                kEpochShift) != key;
+      });
+    }
+    state_.fetch_sub(kWaiterInc, std::memory_order_seq_cst);
+  }
+
+  /**
+   * @brief 唤醒一个等待者（如果有）。
+   */
+  void notify() { notify_impl(false); }
+
+  /**
+   * @brief 唤醒所有等待者。
+   */
+  void notify_all() { notify_impl(true); }
+
+ private:
+  // 低 32 位为等待者数量，高 32 位为纪元
+  static constexpr int kEpochShift = 32;
+  static constexpr std::uint64_t kWaiterInc = 1;
+  static constexpr std::uint64_t kWaiterMask = (std::uint64_t{1} << kEpochShift) - 1;
+  static constexpr std::uint64_t kEpochInc = std::uint64_t{1} << kEpochShift;
+
+  void notify_impl(bool all) {
+    // 与等待方的 prepare_wait() 构成 seq_cst 顺序：要么这里看到等待者，
+    // 要么等待方在登记之后的再次检查中看到已发布的数据
+    if ((state_.load(std::memory_order_seq_cst) & kWaiterMask) == 0) {
+      return;
+    }
+    state_.fetch_add(kEpochInc, std::memory_order_seq_cst);
+    {
+      // 空的临界区：保证等待方要么还没检查纪元，要么已经在 cv_ 上挂起
+      std::lock_guard<std::mutex> lock(mutex_);
+    }
+    if (all) {
+      cv_.notify_all();
+    } else {
+      cv_.notify_one();
+    }
+  }
+
+  std::atomic<std::uint64_t> state_{0};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+}  // namespace cppthreadflow
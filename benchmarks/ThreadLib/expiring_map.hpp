@@ -0,0 +1,335 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>  // for std::hash
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "hash_utils.hpp"
+#include "scheduler.hpp"
+
+namespace cppthreadflow {
+
+/**
+ * @brief 一个条目带有存活时间 (TTL) 的线程安全分片哈希表。
+ *
+ * 每个条目保存自己的过期时间点，每个分片另有一个按过期时间排序的最小堆。
+ * 过期条目通过两种方式回收，都不需要为每个键安排定时器：
+ * - 惰性过期：访问到已过期的条目时，将其视为不存在并立即删除；
+ * - 后台清扫：如果构造时传入了 Scheduler，则只注册一个周期性任务，
+ *   每次对每个分片最多处理 sweep_batch 个堆元素，避免长时间持有分片锁。
+ *
+ * 覆盖或删除条目不会修改堆，旧的堆元素在出堆时被识别为过时并丢弃；
+ * 当过时元素过多时，分片会根据当前条目重建堆。
+ *
+ * @tparam Key 键类型，需要可拷贝（堆中保存一份键的副本）。
+ * @tparam Value 值类型。
+ * @tparam Hash 哈希函数，默认为 std::hash<Key>。
+ * @tparam KeyEqual 键比较函数，默认为 std::equal_to<Key>。
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key> >
+class ExpiringMap {
+ public:
+  using Clock = Scheduler::Clock;
+  using TimePoint = Scheduler::TimePoint;
+  using Duration = Scheduler::Duration;
+
+  // 后台清扫时，每个分片每次最多处理的堆元素数
+  static constexpr size_t kDefaultSweepBatch = 256;
+
+ private:
+  struct Entry {
+    Value value;
+    TimePoint expires_at;
+  };
+
+  // 堆元素：某个键在某个时间点到期
+  struct Deadline {
+    TimePoint expires_at;
+    Key key;
+  };
+
+  // 使 std::push_heap/pop_heap 构成最小堆，最早到期的元素在堆顶
+  struct DeadlineLater {
+    bool operator()(const Deadline& a, const Deadline& b) const {
+      return a.expires_at > b.expires_at;
+    }
+  };
+
+  struct alignas(kCacheLineSize) Shard {
+    std::mutex mutex_;
+    std::unordered_map<Key, Entry, Hash, KeyEqual> map_;
+    std::vector<Deadline> deadlines_;
+  };
+
+  // 分片数据由 shared_ptr 持有，后台清扫任务只保存 weak_ptr，
+  // 因此表析构后，已经提交到线程池的清扫任务也能安全地退出。
+  struct State {
+    explicit State(size_t num_shards)
+        : num_shards_(num_shards),
+          shards_(std::make_unique<Shard[]>(num_shards)) {}
+
+    const size_t num_shards_;
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<std::uint64_t> expired_{0};
+  };
+
+ public:
+  /**
+   * @brief 构造一个只做惰性过期的表，可以手动调用 sweep() 回收内存。
+   * @param default_ttl 默认的存活时间。
+   * @param concurrency_level 预期的并发级别，用于确定分片数量（向上取整为 2 的幂）。
+   */
+  explicit ExpiringMap(
+      Duration default_ttl,
+      size_t concurrency_level = std::thread::hardware_concurrency())
+      : default_ttl_(default_ttl),
+        shard_mask_(detail::next_power_of_two(concurrency_level) - 1),
+        state_(std::make_shared<State>(shard_mask_ + 1)) {}
+
+  /**
+   * @brief 构造一个由 Scheduler 周期性清扫的表。
+   * 调度器必须比这个表活得更久。
+   * @param scheduler 用于注册清扫任务的调度器。
+   * @param default_ttl 默认的存活时间。
+   * @param sweep_interval 两次后台清扫之间的间隔。
+   * @param concurrency_level 预期的并发级别，用于确定分片数量。
+   * @param sweep_batch 每次清扫中每个分片最多处理的堆元素数。
+   */
+  ExpiringMap(Scheduler& scheduler, Duration default_ttl,
+              Duration sweep_interval,
+              size_t concurrency_level = std::thread::hardware_concurrency(),
+              size_t sweep_batch = kDefaultSweepBatch)
+      : ExpiringMap(default_ttl, concurrency_level) {
+    scheduler_ = &scheduler;
+    std::weak_ptr<State> weak_state = state_;
+    sweep_task_ = scheduler.schedule_periodic(
+        Clock::now() + sweep_interval, sweep_interval,
+        [weak_state, sweep_batch]() {
+          if (auto state = weak_state.lock()) {
+            sweep_state(*state, sweep_batch);
+          }
+        });
+  }
+
+  /**
+   * @brief 析构函数，取消后台清扫任务。
+   */
+  ~ExpiringMap() {
+    if (scheduler_ != nullptr) {
+      scheduler_->cancel(sweep_task_);
+    }
+  }
+
+  // 禁止拷贝和移动
+  ExpiringMap(const ExpiringMap&) = delete;
+  ExpiringMap& operator=(const ExpiringMap&) = delete;
+
+  /**
+   * @brief 以默认存活时间插入或覆盖一个键值对。
+   */
+  void insert(const Key& key, Value value) {
+    insert(key, std::move(value), default_ttl_);
+  }
+
+  /**
+   * @brief 以指定的存活时间插入或覆盖一个键值对。
+   * @param key 键。
+   * @param value 值。
+   * @param ttl 存活时间，从现在开始计算。
+   */
+  void insert(const Key& key, Value value, Duration ttl) {
+    const TimePoint expires_at = Clock::now() + ttl;
+    Shard& shard = get_shard(key);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
+    shard.map_.insert_or_assign(key, Entry{std::move(value), expires_at});
+    push_deadline(shard, key, expires_at);
+  }
+
+  /**
+   * @brief 查找一个未过期的键。遇到已过期的条目会顺便将其删除。
+   * @param key 要查找的键。
+   * @param value_out [输出参数] 如果找到，值将被拷贝到这里。
+   * @return 如果找到未过期的条目，返回 true，否则返回 false。
+   */
+  bool find(const Key& key, Value& value_out) const {
+    Shard& shard = get_shard(key);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
+    auto it = find_live(shard, key, Clock::now());
+    if (it == shard.map_.end()) {
+      return false;
+    }
+    value_out = it->second.value;
+    return true;
+  }
+
+  /**
+   * @brief 检查一个未过期的键是否存在。
+   */
+  bool contains(const Key& key) const {
+    Shard& shard = get_shard(key);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
+    return find_live(shard, key, Clock::now()) != shard.map_.end();
+  }
+
+  /**
+   * @brief 为一个未过期的键重新设置存活时间。
+   * @param key 键。
+   * @param ttl 新的存活时间，从现在开始计算。
+   * @return 如果键存在且未过期，返回 true，否则返回 false。
+   */
+  bool refresh(const Key& key, Duration ttl) {
+    const TimePoint now = Clock::now();
+    Shard& shard = get_shard(key);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
+    auto it = find_live(shard, key, now);
+    if (it == shard.map_.end()) {
+      return false;
+    }
+    it->second.expires_at = now + ttl;
+    push_deadline(shard, key, it->second.expires_at);
+    return true;
+  }
+
+  /**
+   * @brief 删除一个键。
+   * @return 如果删除了一个未过期的条目，返回 true，否则返回 false。
+   */
+  bool erase(const Key& key) {
+    Shard& shard = get_shard(key);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
+    auto it = find_live(shard, key, Clock::now());
+    if (it == shard.map_.end()) {
+      return false;
+    }
+    shard.map_.erase(it);
+    return true;
+  }
+
+  /**
+   * @brief 清空所有条目。
+   */
+  void clear() {
+    for (size_t i = 0; i < state_->num_shards_; ++i) {
+      Shard& shard = state_->shards_[i];
+      std::unique_lock<std::mutex> lock(shard.mutex_);
+      shard.map_.clear();
+      std::vector<Deadline>().swap(shard.deadlines_);
+    }
+  }
+
+  /**
+   * @brief 立即回收已过期的条目。
+   * @param max_per_shard 每个分片最多处理的堆元素数。
+   * @return 本次回收的条目数。
+   */
+  size_t sweep(size_t max_per_shard = std::numeric_limits<size_t>::max()) {
+    return sweep_state(*state_, max_per_shard);
+  }
+
+  /**
+   * @brief 获取当前保存的条目数。
+   * 已过期但尚未被访问或清扫回收的条目也会被计算在内。
+   */
+  size_t size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < state_->num_shards_; ++i) {
+      Shard& shard = state_->shards_[i];
+      std::unique_lock<std::mutex> lock(shard.mutex_);
+      total += shard.map_.size();
+    }
+    return total;
+  }
+
+  /**
+   * @brief 获取因过期而被回收（惰性删除或清扫）的条目总数。
+   */
+  std::uint64_t expired_count() const {
+    return state_->expired_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  using MapIterator =
+      typename std::unordered_map<Key, Entry, Hash, KeyEqual>::iterator;
+
+  Shard& get_shard(const Key& key) const {
+    return state_->shards_[detail::mix_hash(hasher_(key)) & shard_mask_];
+  }
+
+  // 在持有分片锁的情况下查找未过期的条目；已过期的条目会被删除
+  MapIterator find_live(Shard& shard, const Key& key, TimePoint now) const {
+    auto it = shard.map_.find(key);
+    if (it != shard.map_.end() && it->second.expires_at <= now) {
+      shard.map_.erase(it);
+      state_->expired_.fetch_add(1, std::memory_order_relaxed);
+      return shard.map_.end();
+    }
+    return it;
+  }
+
+  // 在持有分片锁的情况下登记一个到期时间点，过时元素过多时重建堆
+  static void push_deadline(Shard& shard, const Key& key,
+                            TimePoint expires_at) {
+    auto& heap = shard.deadlines_;
+    if (heap.size() >= 2 * shard.map_.size() + kMinCompactSize) {
+      std::vector<Deadline> rebuilt;
+      rebuilt.reserve(shard.map_.size() + 1);
+      for (const auto& pair : shard.map_) {
+        if (!KeyEqual()(pair.first, key)) {
+          rebuilt.push_back(Deadline{pair.second.expires_at, pair.first});
+        }
+      }
+      std::make_heap(rebuilt.begin(), rebuilt.end(), DeadlineLater());
+      heap.swap(rebuilt);
+    }
+    heap.push_back(Deadline{expires_at, key});
+    std::push_heap(heap.begin(), heap.end(), DeadlineLater());
+  }
+
+  // 对每个分片依次加锁，回收堆顶已到期的条目
+  static size_t sweep_state(State& state, size_t max_per_shard) {
+    size_t reclaimed = 0;
+    for (size_t i = 0; i < state.num_shards_; ++i) {
+      Shard& shard = state.shards_[i];
+      std::unique_lock<std::mutex> lock(shard.mutex_);
+      const TimePoint now = Clock::now();
+      auto& heap = shard.deadlines_;
+      size_t budget = max_per_shard;
+      while (budget > 0 && !heap.empty() && heap.front().expires_at <= now) {
+        std::pop_heap(heap.begin(), heap.end(), DeadlineLater());
+        Deadline deadline = std::move(heap.back());
+        heap.pop_back();
+        --budget;
+        // 条目可能已被删除，或被覆盖/续期为更晚的时间，此时堆元素已过时
+        auto it = shard.map_.find(deadline.key);
+        if (it != shard.map_.end() && it->second.expires_at <= now) {
+          shard.map_.erase(it);
+          ++reclaimed;
+        }
+      }
+    }
+    state.expired_.fetch_add(reclaimed, std::memory_order_relaxed);
+    return reclaimed;
+  }
+
+  // 堆的大小低于此值时不做重建
+  static constexpr size_t kMinCompactSize = 64;
+
+  Hash hasher_;
+  const Duration default_ttl_;
+  const size_t shard_mask_;
+  std::shared_ptr<State> state_;
+  Scheduler* scheduler_ = nullptr;
+  Scheduler::TaskId sweep_task_ = 0;
+};
+
+}  // namespace cppthreadflow
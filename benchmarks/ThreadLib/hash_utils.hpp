@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+namespace cppthreadflow {
+namespace detail {
+
+/**
+ * @brief 对哈希值做一次强位混合（MurmurHash3 的 fmix64 终结函数）。
+ *
+ * 许多标准库对整数的 std::hash 是恒等函数，连续的键只在低位上不同。
+ * 混合后每个输入位都会影响所有输出位，再用低位掩码选择分片或桶时就不会出现倾斜。
+ */
+inline std::uint64_t mix_hash(std::uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/**
+ * @brief 向上取整为 2 的幂，0 视为 1。
+ */
+inline std::size_t next_power_of_two(std::size_t v) {
+  std::size_t result = 1;
+  while (result < v) {
+    result <<= 1;
+  }
+  return result;
+}
+
+/**
+ * @brief 每个线程独立的快速伪随机数（xorshift64），不需要任何同步。
+ *
+ * 只用于负载分散、随机层高等对随机质量要求不高的场合。
+ */
+inline std::uint64_t thread_random() {
+  thread_local std::uint64_t state =
+      mix_hash(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1;
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+}  // namespace detail
+}  // namespace cppthreadflow
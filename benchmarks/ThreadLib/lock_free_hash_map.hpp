@@ -0,0 +1,408 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>  // for std::hash
+#include <utility>
+
+#include "epoch_reclaimer.hpp"
+
+namespace cppthreadflow {
+
+/**
+ * @brief 一个无锁、可增量扩容的并发哈希表（Split-Ordered List）。
+ *
+ * 所有元素按“反转后的哈希值”排序，存放在同一条无锁有序链表中；
+ * 桶只是指向链表中哨兵节点的捷径。扩容时只需把桶数量翻倍，
+ * 新桶在首次被访问时才插入自己的哨兵节点，因此不存在整体重哈希，
+ * 也不会有任何线程因扩容而被阻塞。
+ *
+ * 被删除的节点通过 EpochReclaimer 延迟释放。
+ * 与 ConcurrentHashMap 不同，insert() 只在键不存在时插入，不会覆盖已有的值。
+ *
+ * @tparam Key 键类型。
+ * @tparam Value 值类型，需要可拷贝。
+ * @tparam Hash 哈希函数，默认为 std::hash<Key>。
+ * @tparam KeyEqual 键比较函数，默认为 std::equal_to<Key>。
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key> >
+class LockFreeHashMap {
+ private:
+  // 链表节点。so_key 为分裂序键：最低位为 0 表示哨兵节点，为 1 表示数据节点
+  struct Node {
+    explicit Node(std::uint64_t key) : so_key(key) {}
+    const std::uint64_t so_key;
+    // 指向后继节点，最低位为逻辑删除标记
+    std::atomic<std::uintptr_t> next{0};
+  };
+
+  struct DataNode : Node {
+    template <typename V>
+    DataNode(std::uint64_t so, const Key& k, V&& v)
+        : Node(so), key(k), value(std::forward<V>(v)) {}
+    const Key key;
+    const Value value;
+  };
+
+  // 查找结果：prev 指向前驱的 next 字段，curr 为第一个不小于目标的节点
+  struct Position {
+    std::atomic<std::uintptr_t>* prev;
+    Node* curr;
+  };
+
+  // 桶目录的段数。第 k 段（k >= 1）容纳 [2^(k-1), 2^k) 号桶
+  static constexpr std::size_t kMaxSegments = 48;
+
+ public:
+  /**
+   * @brief 构造一个无锁哈希表。
+   * @param initial_buckets 初始桶数量，会向上取整为 2 的幂。
+   * @param max_load_factor 平均每个桶的元素数超过该值时，桶数量翻倍。
+   */
+  explicit LockFreeHashMap(std::size_t initial_buckets = 16,
+                           double max_load_factor = 2.0)
+      : max_load_factor_(max_load_factor > 0 ? max_load_factor : 2.0) {
+    std::size_t buckets = 1;
+    while (buckets < initial_buckets) {
+      buckets <<= 1;
+    }
+    bucket_count_.store(buckets, std::memory_order_relaxed);
+    for (auto& segment : segments_) {
+      segment.store(nullptr, std::memory_order_relaxed);
+    }
+    // 0 号桶的哨兵节点即整条链表的头
+    head_ = new Node(dummy_key(0));
+    bucket_slot(0).store(head_, std::memory_order_release);
+  }
+
+  /**
+   * @brief 析构函数。调用时不能再有其他线程访问该哈希表。
+   */
+  ~LockFreeHashMap() {
+    Node* node = head_;
+    while (node != nullptr) {
+      Node* next = pointer(node->next.load(std::memory_order_relaxed));
+      destroy_node(node);
+      node = next;
+    }
+    for (std::size_t k = 0; k < kMaxSegments; ++k) {
+      delete[] segments_[k].load(std::memory_order_relaxed);
+    }
+  }
+
+  // 禁止拷贝和移动
+  LockFreeHashMap(const LockFreeHashMap&) = delete;
+  LockFreeHashMap& operator=(const LockFreeHashMap&) = delete;
+
+  /**
+   * @brief 插入一个键值对（仅当键不存在时）。
+   * @param key 键。
+   * @param value 值。
+   * @return 如果插入成功返回 true；如果键已存在返回 false，原有值保持不变。
+   */
+  bool insert(const Key& key, const Value& value) {
+    return emplace(key, value);
+  }
+
+  /**
+   * @brief 插入一个键值对（移动语义，仅当键不存在时）。
+   */
+  bool insert(const Key& key, Value&& value) {
+    return emplace(key, std::move(value));
+  }
+
+  /**
+   * @brief 查找一个键。
+   * @param key 要查找的键。
+   * @param value_out [输出参数] 如果找到，值将被拷贝到这里。
+   * @return 如果找到键，返回 true，否则返回 false。
+   */
+  bool find(const Key& key, Value& value_out) const {
+    EpochGuard guard;
+    const std::size_t hash = hasher_(key);
+    Position pos;
+    if (!search(bucket_for(hash), regular_key(hash), &key, pos)) {
+      return false;
+    }
+    value_out = static_cast<DataNode*>(pos.curr)->value;
+    return true;
+  }
+
+  /**
+   * @brief 判断键是否存在。
+   */
+  bool contains(const Key& key) const {
+    EpochGuard guard;
+    const std::size_t hash = hasher_(key);
+    Position pos;
+    return search(bucket_for(hash), regular_key(hash), &key, pos);
+  }
+
+  /**
+   * @brief 移除一个键。
+   * @param key 要移除的键。
+   * @return 如果成功移除，返回 true，否则返回 false。
+   */
+  bool erase(const Key& key) {
+    EpochGuard guard;
+    const std::size_t hash = hasher_(key);
+    const std::uint64_t so_key = regular_key(hash);
+    Node* bucket = bucket_for(hash);
+    Position pos;
+
+    while (true) {
+      if (!search(bucket, so_key, &key, pos)) {
+        return false;
+      }
+      std::uintptr_t next = pos.curr->next.load(std::memory_order_acquire);
+      if (is_marked(next)) {
+        continue;  // 其他线程正在删除它，重新查找
+      }
+      // 1. 逻辑删除：在 next 指针上打标记
+      if (!pos.curr->next.compare_exchange_weak(next, next | 1,
+                                                std::memory_order_acq_rel)) {
+        continue;
+      }
+      // 2. 物理删除：尝试从前驱上摘除，失败则交给后续的查找顺带清理
+      std::uintptr_t expected = to_word(pos.curr);
+      if (pos.prev->compare_exchange_strong(expected, next,
+                                            std::memory_order_acq_rel)) {
+        retire_node(pos.curr);
+      } else {
+        search(bucket, so_key, &key, pos);
+      }
+      count_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  /**
+   * @brief 获取哈希表中的元素总数。
+   * 注意：这是一个估算值，因为在计算时其他线程可能正在修改。
+   */
+  std::size_t size() const { return count_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 获取当前的桶数量（总是 2 的幂）。
+   */
+  std::size_t bucket_count() const {
+    return bucket_count_.load(std::memory_order_acquire);
+  }
+
+ private:
+  template <typename V>
+  bool emplace(const Key& key, V&& value) {
+    EpochGuard guard;
+    const std::size_t hash = hasher_(key);
+    const std::uint64_t so_key = regular_key(hash);
+    Node* bucket = bucket_for(hash);
+    Position pos;
+
+    // 先做一次查找，避免键已存在时白白构造节点
+    if (search(bucket, so_key, &key, pos)) {
+      return false;
+    }
+    auto* node = new DataNode(so_key, key, std::forward<V>(value));
+    while (true) {
+      node->next.store(to_word(pos.curr), std::memory_order_relaxed);
+      std::uintptr_t expected = to_word(pos.curr);
+      if (pos.prev->compare_exchange_weak(expected, to_word(node),
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+        break;
+      }
+      if (search(bucket, so_key, &key, pos)) {
+        delete node;  // 节点从未发布，可以直接释放
+        return false;
+      }
+    }
+
+    const std::size_t count = count_.fetch_add(1, std::memory_order_relaxed) + 1;
+    maybe_grow(count);
+    return true;
+  }
+
+  // 元素过多时把桶数量翻倍；新桶在首次访问时才初始化
+  void maybe_grow(std::size_t count) {
+    std::size_t buckets = bucket_count_.load(std::memory_order_relaxed);
+    if (static_cast<double>(count) > max_load_factor_ * buckets &&
+        buckets < (std::size_t{1} << (kMaxSegments - 1))) {
+      bucket_count_.compare_exchange_strong(buckets, buckets * 2,
+                                            std::memory_order_acq_rel);
+    }
+  }
+
+  /**
+   * @brief 从 head 开始，在有序链表中查找分裂序键 so_key。
+   * 查找过程中会顺带摘除已被逻辑删除的节点。
+   * @param key 对数据节点为要比较的键；查找哨兵节点时为 nullptr。
+   * @return 是否找到完全匹配的节点（此时 pos.curr 指向它）。
+   */
+  bool search(Node* head, std::uint64_t so_key, const Key* key,
+              Position& pos) const {
+  retry:
+    std::atomic<std::uintptr_t>* prev = &head->next;
+    Node* curr = pointer(prev->load(std::memory_order_acquire));
+    while (true) {
+      if (curr == nullptr) {
+        pos = {prev, nullptr};
+        return false;
+      }
+      const std::uintptr_t next = curr->next.load(std::memory_order_acquire);
+      if (is_marked(next)) {
+        std::uintptr_t expected = to_word(curr);
+        if (!prev->compare_exchange_strong(expected, next & ~std::uintptr_t{1},
+                                           std::memory_order_acq_rel)) {
+          goto retry;  // 前驱已变化，从头开始
+        }
+        retire_node(curr);
+        curr = pointer(next);
+        continue;
+      }
+      if (curr->so_key > so_key) {
+        pos = {prev, curr};
+        return false;
+      }
+      if (curr->so_key == so_key &&
+          (key == nullptr ||
+           key_equal_(static_cast<DataNode*>(curr)->key, *key))) {
+        pos = {prev, curr};
+        return true;
+      }
+      prev = &curr->next;
+      curr = pointer(next);
+    }
+  }
+
+  // 获取哈希值对应桶的哨兵节点
+  Node* bucket_for(std::size_t hash) const {
+    const std::size_t buckets = bucket_count_.load(std::memory_order_acquire);
+    return get_bucket(hash & (buckets - 1));
+  }
+
+  Node* get_bucket(std::size_t bucket) const {
+    Node* dummy = bucket_slot(bucket).load(std::memory_order_acquire);
+    if (dummy == nullptr) {
+      dummy = initialize_bucket(bucket);
+    }
+    return dummy;
+  }
+
+  // 以父桶为起点插入本桶的哨兵节点。父桶即清除最高位后的桶号
+  Node* initialize_bucket(std::size_t bucket) const {
+    const std::size_t parent = bucket & ~highest_bit(bucket);
+    Node* parent_dummy = get_bucket(parent);
+
+    const std::uint64_t so_key = dummy_key(bucket);
+    auto* dummy = new Node(so_key);
+    Position pos;
+    Node* result = nullptr;
+    while (true) {
+      if (search(parent_dummy, so_key, nullptr, pos)) {
+        delete dummy;  // 其他线程已插入同一个哨兵
+        result = pos.curr;
+        break;
+      }
+      dummy->next.store(to_word(pos.curr), std::memory_order_relaxed);
+      std::uintptr_t expected = to_word(pos.curr);
+      if (pos.prev->compare_exchange_weak(expected, to_word(dummy),
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+        result = dummy;
+        break;
+      }
+    }
+    bucket_slot(bucket).store(result, std::memory_order_release);
+    return result;
+  }
+
+  // 获取桶在目录中的槽位，所在段不存在时按需分配
+  std::atomic<Node*>& bucket_slot(std::size_t bucket) const {
+    const std::size_t k = bucket == 0 ? 0 : floor_log2(bucket) + 1;
+    const std::size_t base = k == 0 ? 0 : std::size_t{1} << (k - 1);
+    std::atomic<Node*>* segment = segments_[k].load(std::memory_order_acquire);
+    if (segment == nullptr) {
+      const std::size_t length = k == 0 ? 1 : base;
+      auto* fresh = new std::atomic<Node*>[length];
+      for (std::size_t i = 0; i < length; ++i) {
+        fresh[i].store(nullptr, std::memory_order_relaxed);
+      }
+      if (segments_[k].compare_exchange_strong(segment, fresh,
+                                               std::memory_order_acq_rel)) {
+        segment = fresh;
+      } else {
+        delete[] fresh;  // 其他线程抢先分配了该段
+      }
+    }
+    return segment[bucket - base];
+  }
+
+  static void retire_node(Node* node) {
+    if (node->so_key & 1) {
+      EpochReclaimer::instance().retire(static_cast<DataNode*>(node));
+    } else {
+      EpochReclaimer::instance().retire(node);
+    }
+  }
+
+  static void destroy_node(Node* node) {
+    if (node->so_key & 1) {
+      delete static_cast<DataNode*>(node);
+    } else {
+      delete node;
+    }
+  }
+
+  static std::uint64_t reverse_bits(std::uint64_t v) {
+    v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+    v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+    v = ((v >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((v & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    v = ((v >> 8) & 0x00FF00FF00FF00FFULL) | ((v & 0x00FF00FF00FF00FFULL) << 8);
+    v = ((v >> 16) & 0x0000FFFF0000FFFFULL) |
+        ((v & 0x0000FFFF0000FFFFULL) << 16);
+    return (v >> 32) | (v << 32);
+  }
+
+  // 数据节点：置最高位后反转，保证最低位为 1
+  static std::uint64_t regular_key(std::size_t hash) {
+    return reverse_bits(static_cast<std::uint64_t>(hash) | (1ULL << 63));
+  }
+
+  // 哨兵节点：直接反转桶号，最低位为 0
+  static std::uint64_t dummy_key(std::size_t bucket) {
+    return reverse_bits(static_cast<std::uint64_t>(bucket));
+  }
+
+  static std::size_t floor_log2(std::size_t v) {
+    std::size_t log = 0;
+    while (v >>= 1) {
+      ++log;
+    }
+    return log;
+  }
+
+  static std::size_t highest_bit(std::size_t v) {
+    return v == 0 ? 0 : std::size_t{1} << floor_log2(v);
+  }
+
+  static bool is_marked(std::uintptr_t word) { return (word & 1) != 0; }
+  static Node* pointer(std::uintptr_t word) {
+    return reinterpret_cast<Node*>(word & ~std::uintptr_t{1});
+  }
+  static std::uintptr_t to_word(Node* node) {
+    return reinterpret_cast<std::uintptr_t>(node);
+  }
+
+  Hash hasher_;
+  KeyEqual key_equal_;
+  const double max_load_factor_;
+  Node* head_ = nullptr;
+  std::atomic<std::size_t> bucket_count_{0};
+  std::atomic<std::size_t> count_{0};
+  // 分段的桶目录，段只分配不释放，扩容时无需搬移已有的桶
+  mutable std::atomic<std::atomic<Node*>*> segments_[kMaxSegments];
+};
+
+}  // namespace cppthreadflow
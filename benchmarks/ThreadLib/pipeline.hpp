@@ -0,0 +1,218 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <any>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cppthreadflow {
+
+// 前向声明，避免循环引用头文件
+class ThreadPool;
+
+namespace detail {
+
+template <typename T>
+struct is_optional : std::false_type {};
+
+template <typename T>
+struct is_optional<std::optional<T> > : std::true_type {};
+
+}  // namespace detail
+
+/**
+ * @brief 流水线阶段的执行方式。
+ */
+enum class StageMode {
+  kSerialInOrder,     // 串行，且按输入顺序处理（例如写文件、输出结果）
+  kSerialOutOfOrder,  // 串行，但不要求顺序（例如更新非线程安全的聚合状态）
+  kParallel,          // 多个令牌并行处理（无状态的计算）
+};
+
+/**
+ * @brief 流水线的运行选项。
+ */
+struct PipelineOptions {
+  // 同时在流水线中流动的令牌数上限，用于限制内存占用。
+  // 每个令牌在线程池队列中最多占一个位置；使用有界 kBlock 线程池时，
+  // 队列容量必须不小于 max_tokens，否则所有工作线程可能都阻塞在提交上而死锁
+  size_t max_tokens = 2 * std::max(1u, std::thread::hardware_concurrency());
+  // 每个令牌携带的最大元素数，批量传递以摊薄调度开销
+  size_t batch_size = 1;
+};
+
+/**
+ * @brief 类似 TBB parallel_pipeline 的多阶段流式处理流水线。
+ *
+ * 源 (source) 在调用 run() 的线程上依次产生元素，每 batch_size 个元素打包为一个令牌；
+ * 令牌依次流过各个阶段，每个阶段在共享的 ThreadPool 上执行：
+ * - 串行阶段同一时刻只处理一个令牌，kSerialInOrder 还会按源的产生顺序处理；
+ * - 并行阶段最多同时处理 parallelism 个令牌（0 表示只受令牌数限制）。
+ * 流水线中的令牌总数不超过 max_tokens，因此阶段之间的缓冲天然有界：
+ * 源在令牌用完时等待，直到某个令牌走完全部阶段。
+ *
+ * 阶段函数返回空的 std::any（或 std::nullopt）表示丢弃该元素。
+ * 任何阶段抛出异常后，源停止产生新元素，其余令牌被丢弃，run() 重新抛出第一个异常。
+ * 线程池拒绝提交（QueueFullError、AdmissionRejected 或已停止）同样按阶段失败处理；
+ * run() 总是等所有令牌结束后才返回或抛出。
+ *
+ * 线程池必须使用 kBlock（默认）或 kFailFast 溢出策略：丢弃策略会不抛异常地丢掉令牌的任务，
+ * 该令牌永远无法结束，run() 会一直等待，因此构造函数拒绝这样的线程池。
+ *
+ * @code
+ *   Pipeline pipeline(pool, {16, 64});
+ *   pipeline.source<std::string>([&](std::string& line) {
+ *             return static_cast<bool>(std::getline(input, line)); })
+ *       .stage<std::string>(StageMode::kParallel, parse)
+ *       .stage<Record>(StageMode::kSerialOutOfOrder, aggregate)
+ *       .stage<Record>(StageMode::kSerialInOrder, emit);
+ *   pipeline.run();
+ * @endcode
+ */
+class Pipeline {
+ public:
+  // 无类型的源：产生一个元素时写入 out 并返回 true，没有更多元素时返回 false
+  using Source = std::function<bool(std::any& out)>;
+  // 无类型的阶段函数：返回空的 std::any 表示丢弃该元素
+  using StageFunction = std::function<std::any(std::any item)>;
+
+  /**
+   * @brief 构造函数。
+   * @param pool 执行各个阶段的线程池，必须比流水线活得更久。
+   * @param options 运行选项。
+   * @throws std::invalid_argument 如果线程池使用 kDropOldest 或 kDropNewest 溢出策略。
+   */
+  explicit Pipeline(ThreadPool& pool, const PipelineOptions& options = {});
+
+  // 禁止拷贝和移动
+  Pipeline(const Pipeline&) = delete;
+  Pipeline& operator=(const Pipeline&) = delete;
+  Pipeline(Pipeline&&) = delete;
+  Pipeline& operator=(Pipeline&&) = delete;
+
+  /**
+   * @brief 设置无类型的源。
+   */
+  Pipeline& source(Source source);
+
+  /**
+   * @brief 设置类型化的源。
+   * @tparam T 源产生的元素类型，需要可默认构造。
+   * @param produce 可调用对象，签名为 bool(T&)。
+   */
+  template <typename T, typename F>
+  Pipeline& source(F&& produce);
+
+  /**
+   * @brief 追加一个无类型的阶段。
+   * @param mode 执行方式。
+   * @param function 阶段函数。
+   * @param parallelism 并行阶段的最大并发数，0 表示只受令牌数限制；串行阶段忽略此值。
+   */
+  Pipeline& stage(StageMode mode, StageFunction function,
+                  size_t parallelism = 0);
+
+  /**
+   * @brief 追加一个类型化的阶段。
+   * fn 返回 void 时不向后传递任何元素（通常是最后一个阶段）；
+   * 返回 std::optional 时，std::nullopt 表示丢弃该元素。
+   * @tparam In 输入元素类型，必须与上一阶段的输出类型一致。
+   */
+  template <typename In, typename F>
+  Pipeline& stage(StageMode mode, F&& fn, size_t parallelism = 0);
+
+  /**
+   * @brief 运行流水线，阻塞直到源耗尽且所有令牌都走完全部阶段。
+   * 不要在只有一个线程的线程池的工作线程中调用。
+   * @return 源产生的元素数。
+   * @throws 任何阶段（或源）抛出的第一个异常。
+   */
+  size_t run();
+
+ private:
+  struct Token {
+    std::uint64_t sequence;
+    std::vector<std::any> items;
+  };
+
+  struct Stage {
+    StageMode mode;
+    StageFunction function;
+    size_t max_active;
+    std::mutex mutex;
+    std::deque<Token> queue;                 // kParallel / kSerialOutOfOrder
+    std::map<std::uint64_t, Token> reorder;  // kSerialInOrder，按序号等待
+    std::uint64_t next_sequence = 0;
+    size_t active = 0;
+  };
+
+  // 把令牌交给第 index 个阶段；index 越过最后一个阶段时令牌结束
+  void enqueue(size_t index, Token token);
+  // 在持有阶段锁时取出可以开始处理的令牌
+  std::vector<std::shared_ptr<Token> > take_ready_locked(Stage& stage);
+  // 把取出的令牌提交到线程池（不持有任何锁）
+  void submit_tokens(size_t index, std::vector<std::shared_ptr<Token> > tokens);
+  void process(size_t index, Token token);
+  void finish_token();
+  void record_error(std::exception_ptr error);
+
+  ThreadPool& pool_;
+  const size_t max_tokens_;
+  const size_t batch_size_;
+  Source source_;
+  std::vector<std::unique_ptr<Stage> > stages_;
+
+  // 一次 run() 的状态
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t in_flight_ = 0;
+  std::exception_ptr error_;
+  std::atomic<bool> failed_{false};
+};
+
+template <typename T, typename F>
+Pipeline& Pipeline::source(F&& produce) {
+  return source(
+      [produce = std::forward<F>(produce)](std::any& out) mutable -> bool {
+        T item{};
+        if (!produce(item)) {
+          return false;
+        }
+        out = std::move(item);
+        return true;
+      });
+}
+
+template <typename In, typename F>
+Pipeline& Pipeline::stage(StageMode mode, F&& fn, size_t parallelism) {
+  using Out = std::invoke_result_t<F&, In>;
+  // 并行阶段可能在多个线程中同时调用同一个函数对象，因此按 const 调用
+  auto typed = [fn = std::forward<F>(fn)](std::any item) -> std::any {
+    In input = std::any_cast<In>(std::move(item));
+    if constexpr (std::is_void_v<Out>) {
+      fn(std::move(input));
+      return std::any();
+    } else if constexpr (detail::is_optional<std::decay_t<Out> >::value) {
+      auto result = fn(std::move(input));
+      return result.has_value() ? std::any(std::move(*result)) : std::any();
+    } else {
+      return std::any(fn(std::move(input)));
+    }
+  };
+  return stage(mode, StageFunction(std::move(typed)), parallelism);
+}
+
+}  // namespace cppthreadflow
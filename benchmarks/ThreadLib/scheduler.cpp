@@ -17,35 +17,99 @@ Scheduler::~Scheduler() {
     if (scheduler_thread_.joinable()) {
         scheduler_thread_.join();
     }
+    // 4. 在锁外注销所有取消回调，之后不会再有回调访问这个调度器
+    std::vector<CancellationRegistration> registrations;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (auto& entry : pending_) {
+            registrations.push_back(std::move(entry.second.registration));
+        }
+    }
 }
 
-void Scheduler::schedule_at(const TimePoint& time, Task task) {
+Scheduler::TaskId Scheduler::add_task(const TimePoint& time, const Duration& interval, Task task,
+                                      const CancellationToken& token) {
+    TaskId id;
     {
         std::unique_lock<std::mutex> lock(mutex_);
-        tasks_.push({time, Duration::zero(), std::move(task)});
+        id = next_id_++;
+        pending_.emplace(id, PendingTask{std::move(task), token, CancellationRegistration()});
+        tasks_.push({id, time, interval});
+    }
+    if (token.can_be_cancelled()) {
+        // 在锁外注册：令牌已被取消时回调会立即在当前线程执行，而它需要获取 mutex_。
+        // 声明在锁之前，任务已经结束时它在锁释放之后才被销毁
+        CancellationRegistration registration =
+            token.register_callback([this, id] { cancel(id); });
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = pending_.find(id);
+        if (it != pending_.end()) {
+            it->second.registration = std::move(registration);
+        }
     }
+    return id;
+}
+
+Scheduler::TaskId Scheduler::schedule_at(const TimePoint& time, Task task,
+                                         const CancellationToken& token) {
+    const TaskId id = add_task(time, Duration::zero(), std::move(task), token);
     // 通知调度线程，可能有新的、更早的任务需要处理
     cv_.notify_one();
+    return id;
 }
 
-void Scheduler::schedule_after(const Duration& delay, Task task) {
-    schedule_at(Clock::now() + delay, std::move(task));
+Scheduler::TaskId Scheduler::schedule_after(const Duration& delay, Task task,
+                                            const CancellationToken& token) {
+    return schedule_at(Clock::now() + delay, std::move(task), token);
 }
 
-void Scheduler::schedule_periodic(const TimePoint& first_time, const Duration& interval, Task task) {
+Scheduler::TaskId Scheduler::schedule_periodic(const TimePoint& first_time, const Duration& interval, Task task,
+                                               const CancellationToken& token) {
     if (interval == Duration::zero()) {
         // 避免无限循环
-        return;
+        return 0;
     }
+    const TaskId id = add_task(first_time, interval, std::move(task), token);
+    cv_.notify_one();
+    return id;
+}
+
+bool Scheduler::cancel(TaskId id) {
+    // 闭包与回调注册在锁外销毁：闭包的析构可能很重，注销回调可能要等待正在执行的回调
+    PendingTask released;
     {
         std::unique_lock<std::mutex> lock(mutex_);
-        tasks_.push({first_time, interval, std::move(task)});
+        auto it = pending_.find(id);
+        if (it == pending_.end()) {
+            return false;
+        }
+        released = std::move(it->second);
+        pending_.erase(it);
+        // 堆中的条目留到出队时丢弃，除非被取消的条目已经太多
+        compact_locked();
     }
-    cv_.notify_one();
+    return true;
+}
+
+void Scheduler::compact_locked() {
+    if (tasks_.size() <= kCompactThreshold || tasks_.size() <= 2 * pending_.size()) {
+        return;
+    }
+    std::vector<ScheduledTask> live;
+    live.reserve(pending_.size());
+    while (!tasks_.empty()) {
+        if (pending_.count(tasks_.top().id) > 0) {
+            live.push_back(tasks_.top());
+        }
+        tasks_.pop();
+    }
+    tasks_ = decltype(tasks_)(TaskComparer(), std::move(live));
 }
 
 void Scheduler::scheduler_loop() {
     while (!stop_) {
+        // 结束的任务的回调注册，在锁释放之后才销毁（声明在锁之前）
+        std::vector<CancellationRegistration> finished;
         std::unique_lock<std::mutex> lock(mutex_);
 
         if (tasks_.empty()) {
@@ -57,7 +121,7 @@ void Scheduler::scheduler_loop() {
             cv_.wait_until(lock, next_time, [this, next_time] {
                 // 仅在以下情况被真正唤醒：
                 // 1. 停止信号来了
-                // 2. 任务队列为空了（可能被其他线程偷走，虽然我们这里没有）
+                // 2. 任务队列为空了（被压缩）
                 // 3. 队首任务变了（即有新任务插入，且比当前队首任务更早）
                 return stop_ || tasks_.empty() || tasks_.top().time < next_time;
             });
@@ -74,17 +138,50 @@ void Scheduler::scheduler_loop() {
             ScheduledTask scheduled_task = tasks_.top();
             tasks_.pop();
 
+            // 任务已被取消，直接丢弃
+            auto it = pending_.find(scheduled_task.id);
+            if (it == pending_.end()) {
+                continue;
+            }
+            PendingTask& pending = it->second;
+            // 任务的令牌已被取消：丢弃任务，周期性任务也不再重新安排
+            if (pending.token.is_cancellation_requested()) {
+                finished.push_back(std::move(pending.registration));
+                pending_.erase(it);
+                continue;
+            }
+            const bool periodic = scheduled_task.interval > Duration::zero();
+            const CancellationToken token = pending.token;
+            Task task;
+            if (periodic) {
+                task = pending.func;
+            } else {
+                task = std::move(pending.func);
+                finished.push_back(std::move(pending.registration));
+                pending_.erase(it);
+            }
+
             // 【关键】提前释放锁，再去提交任务
             lock.unlock();
 
-            // 将任务提交到线程池执行
-            pool_.submit(scheduled_task.func);
+            // 将任务提交到线程池执行；有界线程池拒绝时只丢弃这一次执行并计数，
+            // 不能让异常终止调度线程
+            try {
+                if (token.can_be_cancelled()) {
+                    // 在线程池中排队期间被取消的执行同样会被丢弃
+                    pool_.submit(token, std::move(task));
+                } else {
+                    pool_.submit(std::move(task));
+                }
+            } catch (const std::exception&) {
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+            }
 
             // 重新加锁以处理周期性任务和循环
             lock.lock();
 
-            // 如果是周期性任务，计算下一次执行时间并重新入队
-            if (scheduled_task.interval > Duration::zero()) {
+            // 如果是周期性任务（且在提交期间没有被取消），计算下一次执行时间并重新入队
+            if (periodic && pending_.count(scheduled_task.id) > 0) {
                 scheduled_task.time += scheduled_task.interval;
                 tasks_.push(scheduled_task);
             }
@@ -33,6 +33,19 @@ void Semaphore::acquire() {
   count_--;
 }
 
+bool Semaphore::acquire(const CancellationToken& token) {
+  // 先注册唤醒回调再加锁：已取消时回调会立即执行并获取同一把锁
+  CancellationRegistration registration =
+      detail::notify_on_cancel(token, mutex_, cv_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!detail::wait_unless_cancelled(lock, cv_, token,
+                                     [this] { return count_ > 0; })) {
+    return false;
+  }
+  count_--;
+  return true;
+}
+
 bool Semaphore::try_acquire() {
   std::unique_lock<std::mutex> lock(mutex_);
 
@@ -1,8 +1,11 @@
 ﻿#pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 
+#include "cancellation.hpp"
+
 namespace cppthreadflow {
 
 /**
@@ -46,6 +49,37 @@ class Semaphore {
    */
   bool try_acquire();
 
+  /**
+   * @brief 获取一个信号量资源，等待期间可以被取消。
+   * @param token 取消令牌；被取消或到达其截止时间时立即停止等待。
+   * @return 如果获取成功，返回 true；如果被取消，返回 false。
+   */
+  bool acquire(const CancellationToken& token);
+
+  /**
+   * @brief 获取一个信号量资源，最多等待 timeout。
+   * @return 如果获取成功，返回 true；如果超时，返回 false。
+   */
+  template <typename Rep, typename Period>
+  bool try_acquire_for(const std::chrono::duration<Rep, Period>& timeout) {
+    return try_acquire_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  /**
+   * @brief 获取一个信号量资源，最多等待到 deadline。
+   * @return 如果获取成功，返回 true；如果超时，返回 false。
+   */
+  template <typename Clock, typename Duration>
+  bool try_acquire_until(
+      const std::chrono::time_point<Clock, Duration>& deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!cv_.wait_until(lock, deadline, [this] { return count_ > 0; })) {
+      return false;
+    }
+    count_--;
+    return true;
+  }
+
  private:
   int count_;
   std::mutex mutex_;
@@ -0,0 +1,108 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "mpsc_queue.hpp"
+
+namespace cppthreadflow {
+namespace detail {
+
+/**
+ * @brief 串行执行器（Strand、Actor）共用的“排空”协议：保证任意时刻至多一个线程在处理节点。
+ *
+ * 节点进入无锁的 MPSC 队列，一个原子计数记录已入队但尚未处理完的节点数。
+ * push 让计数从 0 变为 1 时返回 true，调用者随后负责调度一次排空（schedule_serial_drain）；
+ * 其他 push 只入队。drain 每次最多处理 max_batch 个节点，返回 true 表示还有剩余，
+ * 执行权仍在当前的排空者手中，需要再调度一次。
+ *
+ * 由于计数覆盖了“已交换队尾、尚未链接”的节点，即使 try_pop 暂时取不到它们，
+ * 执行权也不会在它们被处理之前交出去。
+ */
+class SerialQueue {
+ public:
+  SerialQueue() = default;
+
+  // 禁止拷贝和移动
+  SerialQueue(const SerialQueue&) = delete;
+  SerialQueue& operator=(const SerialQueue&) = delete;
+
+  /**
+   * @brief 入队一个节点（任意线程）。
+   * @return 如果调用者取得了执行权、需要调度一次排空，返回 true。
+   */
+  bool push(MpscNode* node) {
+    queue_.push(node);
+    return pending_.fetch_add(1, std::memory_order_acq_rel) == 0;
+  }
+
+  /**
+   * @brief 处理一批节点（仅限持有执行权的线程）。
+   * @param consume 对每个出队节点调用一次，负责处理并释放节点，不能抛出异常。
+   * @return 是否还有剩余的节点（批次用完，或生产者正在入队）。
+   */
+  template <typename Consume>
+  bool drain(size_t max_batch, Consume&& consume) {
+    size_t processed = 0;
+    while (processed < max_batch) {
+      MpscNode* node = queue_.try_pop();
+      if (node == nullptr) {
+        // 队列已空，或某个生产者尚未完成链接；后者由下面的计数检查处理
+        break;
+      }
+      consume(node);
+      ++processed;
+    }
+    return pending_.fetch_sub(processed, std::memory_order_acq_rel) !=
+           processed;
+  }
+
+  /**
+   * @brief 释放剩余的节点，只在所有者析构、不再有生产者时调用。
+   */
+  template <typename Dispose>
+  void clear(Dispose&& dispose) {
+    while (MpscNode* node = queue_.try_pop()) {
+      dispose(node);
+    }
+  }
+
+  /**
+   * @brief 已入队但尚未处理完的节点数（近似值）。
+   */
+  size_t pending() const { return pending_.load(std::memory_order_relaxed); }
+
+ private:
+  IntrusiveMpscQueue queue_;
+  // 已入队但尚未处理完的节点数，由 0 变为 1 时负责调度
+  std::atomic<size_t> pending_{0};
+};
+
+/**
+ * @brief 把一次排空提交到线程池；排空后还有剩余时重新提交，把工作线程让给其他执行器。
+ *
+ * 线程池拒绝提交（已满、准入控制拒绝或已停止）时，执行权仍在当前线程，直接在这里排空，
+ * 以免执行器永远停滞。丢弃策略（kDropOldest/kDropNewest）不抛异常地丢掉排空任务，
+ * 执行权随之丢失，执行器会永远停滞，因此线程池应当使用 kBlock 或 kFailFast。
+ *
+ * @param pool 线程池，必须比 self 以及它的所有排空活得更久。
+ * @param self 提供 bool drain() 的执行器，排空任务持有它的一份引用。
+ */
+template <typename Pool, typename Executor>
+void schedule_serial_drain(Pool& pool, std::shared_ptr<Executor> self) {
+  try {
+    pool.submit([&pool, self]() {
+      if (self->drain()) {
+        schedule_serial_drain(pool, self);
+      }
+    });
+  } catch (...) {
+    while (self->drain()) {
+    }
+  }
+}
+
+}  // namespace detail
+}  // namespace cppthreadflow
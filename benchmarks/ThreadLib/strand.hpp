@@ -0,0 +1,106 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "serial_queue.hpp"
+
+namespace cppthreadflow {
+
+// 前向声明，避免循环引用头文件
+class ThreadPool;
+
+/**
+ * @brief 串行执行器 (strand)：提交到同一个 strand 的任务按提交顺序依次执行，
+ * 绝不会并发执行，但它们运行在共享的 ThreadPool 上，而不是专用线程中。
+ *
+ * 任务进入一个无锁的 MPSC 队列，并用一个原子计数记录未执行的任务数。
+ * 只有计数从 0 变为 1 的那次 post 才会向线程池提交一次“排空”任务，
+ * 之后的 post 只入队，不再提交。排空任务每次最多执行 max_batch 个任务，
+ * 还有剩余时重新提交自己，让同一线程池上的其他 strand 也有机会运行。
+ * 与每个实体一把互斥锁相比，工作线程不会因为等待锁而被挂起。
+ *
+ * 线程池应当使用 kBlock（默认）或 kFailFast 溢出策略：
+ * 使用丢弃策略时，被丢弃的排空任务会让 strand 停滞。
+ */
+class Strand {
+ public:
+  static constexpr size_t kDefaultMaxBatch = 64;
+
+  /**
+   * @brief 构造函数。
+   * @param pool 执行任务的线程池，必须比这个 strand 以及它的所有任务活得更久。
+   * @param max_batch 每次在工作线程上最多连续执行的任务数。
+   */
+  explicit Strand(ThreadPool& pool, size_t max_batch = kDefaultMaxBatch);
+
+  /**
+   * @brief 析构函数。
+   * 已提交的任务仍会在线程池上按顺序执行完。
+   */
+  ~Strand() = default;
+
+  // 禁止拷贝和移动
+  Strand(const Strand&) = delete;
+  Strand& operator=(const Strand&) = delete;
+  Strand(Strand&&) = delete;
+  Strand& operator=(Strand&&) = delete;
+
+  /**
+   * @brief 提交一个任务，不关心结果。任务抛出的异常会被忽略。
+   * @param task 要执行的任务。
+   */
+  void post(std::function<void()> task);
+
+  /**
+   * @brief 提交一个任务，并通过 future 获取其结果或异常。
+   */
+  template <class F, class... Args>
+  auto submit(F&& f, Args&&... args)
+      -> std::future<std::invoke_result_t<F, Args...>>;
+
+  /**
+   * @brief 当前线程是否正在执行这个 strand 的任务。
+   */
+  bool running_in_this_thread() const;
+
+ private:
+  struct TaskNode : MpscNode {
+    explicit TaskNode(std::function<void()> t) : task(std::move(t)) {}
+    std::function<void()> task;
+  };
+
+  // 由 shared_ptr 持有：提交到线程池的排空任务保存一份引用，
+  // 因此 Strand 析构后，剩余的任务仍能安全地执行完
+  struct State : std::enable_shared_from_this<State> {
+    State(ThreadPool& pool, size_t max_batch)
+        : pool_(pool), max_batch_(max_batch == 0 ? 1 : max_batch) {}
+    ~State();
+
+    // 执行一批任务，返回是否还有剩余的任务
+    bool drain();
+
+    ThreadPool& pool_;
+    const size_t max_batch_;
+    detail::SerialQueue queue_;
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+template <class F, class... Args>
+auto Strand::submit(F&& f, Args&&... args)
+    -> std::future<std::invoke_result_t<F, Args...>> {
+  using return_type = std::invoke_result_t<F, Args...>;
+  auto task = std::make_shared<std::packaged_task<return_type()>>(
+      std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+  std::future<return_type> future = task->get_future();
+  post([task]() { (*task)(); });
+  return future;
+}
+
+}  // namespace cppthreadflow
@@ -0,0 +1,146 @@
+﻿#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cancellation.hpp"
+
+namespace cppthreadflow {
+
+// 前向声明，避免循环引用头文件
+class ThreadPool;
+
+/**
+ * @brief TaskGroup::wait() 在有任务失败时抛出的异常，汇总了所有失败任务的异常。
+ */
+class TaskGroupError : public std::runtime_error {
+ public:
+  explicit TaskGroupError(std::vector<std::exception_ptr> exceptions);
+
+  /**
+   * @brief 获取所有失败任务抛出的异常，按失败的先后顺序排列。
+   */
+  const std::vector<std::exception_ptr>& exceptions() const {
+    return exceptions_;
+  }
+
+ private:
+  std::vector<std::exception_ptr> exceptions_;
+};
+
+/**
+ * @brief 结构化并发的任务组：派生一组子任务，等待它们全部结束，并统一处理失败。
+ *
+ * - run() 把子任务提交到线程池；子任务可以接收一个 CancellationToken 参数，
+ *   以便在长时间运行时协作式地检查取消；
+ * - 任何子任务抛出异常时，任务组被取消：尚未开始的子任务不再执行；
+ * - wait() 在等待期间从线程池的队列中取出任务帮忙执行，而不是挂起线程，
+ *   因此在工作线程中等待嵌套的任务组也不会让线程池死锁；
+ * - 用父令牌构造的任务组在父令牌被取消时一同被取消，取消沿嵌套结构向下传播。
+ *
+ * 析构函数会等待所有子任务结束（忽略它们的异常）。
+ *
+ * 线程池必须使用 kBlock（默认）或 kFailFast 溢出策略：被丢弃策略丢掉的子任务既不执行
+ * 也不抛出异常，wait() 会永远等待它，因此构造函数拒绝这样的线程池。
+ */
+class TaskGroup {
+ public:
+  /**
+   * @brief 构造一个任务组。
+   * @param pool 执行子任务的线程池，必须比任务组活得更久。
+   * @throws std::invalid_argument 如果线程池使用 kDropOldest 或 kDropNewest 溢出策略。
+   */
+  explicit TaskGroup(ThreadPool& pool);
+
+  /**
+   * @brief 构造一个与父令牌关联的任务组，父令牌被取消时任务组也被取消。
+   */
+  TaskGroup(ThreadPool& pool, const CancellationToken& parent);
+
+  /**
+   * @brief 析构函数，等待所有子任务结束。
+   */
+  ~TaskGroup();
+
+  // 禁止拷贝和移动
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+  TaskGroup(TaskGroup&&) = delete;
+  TaskGroup& operator=(TaskGroup&&) = delete;
+
+  /**
+   * @brief 派生一个子任务。
+   * @param task 可调用对象，签名为 void() 或 void(const CancellationToken&)。
+   */
+  template <typename F>
+  void run(F&& task);
+
+  /**
+   * @brief 等待所有子任务结束，等待期间帮忙执行线程池中排队的任务。
+   * @throws TaskGroupError 如果有子任务抛出了异常。
+   */
+  void wait();
+
+  /**
+   * @brief 取消任务组：尚未开始的子任务不再执行，正在执行的子任务可以通过令牌感知。
+   */
+  void cancel();
+
+  /**
+   * @brief 任务组是否已被取消（主动取消、子任务失败或父令牌被取消）。
+   */
+  bool is_cancelled() const;
+
+  /**
+   * @brief 获取任务组的令牌，可用于构造嵌套的子任务组。
+   */
+  CancellationToken token() const;
+
+ private:
+  // 由 shared_ptr 持有，已提交到线程池的子任务保存一份引用
+  struct State {
+    explicit State(CancellationSource s) : source(std::move(s)) {}
+
+    void execute(const std::function<void()>& task);
+    void record_error(std::exception_ptr error);
+    void finish_one();
+
+    CancellationSource source;
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t pending = 0;
+    std::vector<std::exception_ptr> errors;
+  };
+
+  // 没有可帮忙的任务时，两次检查线程池队列之间的最长等待时间
+  static constexpr std::chrono::microseconds kHelpPollInterval{200};
+
+  void run_impl(std::function<void()> task);
+  // 拒绝会静默丢弃任务的线程池
+  static ThreadPool& checked_pool(ThreadPool& pool);
+
+  ThreadPool& pool_;
+  std::shared_ptr<State> state_;
+};
+
+template <typename F>
+void TaskGroup::run(F&& task) {
+  if constexpr (std::is_invocable_v<F&, const CancellationToken&>) {
+    run_impl([task = std::forward<F>(task), token = token()]() mutable {
+      task(token);
+    });
+  } else {
+    run_impl(std::function<void()>(std::forward<F>(task)));
+  }
+}
+
+}  // namespace cppthreadflow
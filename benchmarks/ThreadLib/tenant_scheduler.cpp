@@ -0,0 +1,150 @@
+﻿#include "tenant_scheduler.hpp"
+#include "thread_pool.hpp" // 需要 ThreadPool 的完整定义
+
+#include <stdexcept>
+
+namespace cppthreadflow {
+
+TenantScheduler::TenantScheduler(ThreadPool& pool, size_t max_in_flight)
+    : state_(std::make_shared<State>(
+          pool, max_in_flight != 0 ? max_in_flight : pool.thread_count())) {}
+
+TenantScheduler::TenantId TenantScheduler::add_tenant(TenantOptions options) {
+    if (options.weight == 0) {
+        throw std::invalid_argument("TenantScheduler tenant weight must be greater than 0");
+    }
+    std::lock_guard<std::mutex> lock(state_->mutex_);
+    state_->tenants_.push_back(std::make_unique<Tenant>(std::move(options)));
+    return state_->tenants_.size() - 1;
+}
+
+void TenantScheduler::post(TenantId tenant, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex_);
+        Tenant& t = state_->tenant_locked(tenant);
+        t.queue.push_back(Job{std::move(task), Clock::now()});
+        ++t.stats.submitted;
+        if (!t.active) {
+            // 新加入的租户排在环尾，从下一轮开始获得额度
+            t.active = true;
+            t.deficit = 0;
+            state_->active_.push_back(&t);
+        }
+    }
+    state_->dispatch();
+}
+
+TenantStats TenantScheduler::tenant_stats(TenantId tenant) const {
+    std::lock_guard<std::mutex> lock(state_->mutex_);
+    const Tenant& t = state_->tenant_locked(tenant);
+    TenantStats stats = t.stats;
+    stats.queued = t.queue.size();
+    return stats;
+}
+
+size_t TenantScheduler::tenant_count() const {
+    std::lock_guard<std::mutex> lock(state_->mutex_);
+    return state_->tenants_.size();
+}
+
+TenantScheduler::Tenant& TenantScheduler::State::tenant_locked(TenantId id) const {
+    if (id >= tenants_.size()) {
+        throw std::out_of_range("TenantScheduler unknown tenant id");
+    }
+    return *tenants_[id];
+}
+
+TenantScheduler::Tenant* TenantScheduler::State::pick_locked() {
+    // 环中的租户都有任务排队；最多检查一整圈，全部达到并发上限时返回 nullptr
+    for (size_t skipped = 0; skipped < active_.size(); ++skipped) {
+        Tenant* t = active_.front();
+        const size_t cap = t->options.max_concurrency;
+        if (cap != 0 && t->stats.running >= cap) {
+            // 跳过时保留剩余额度，下次轮到时继续使用
+            active_.pop_front();
+            active_.push_back(t);
+            continue;
+        }
+        if (t->deficit == 0) {
+            // 新一轮：按权重获得额度
+            t->deficit = t->options.weight;
+        }
+        --t->deficit;
+        return t;
+    }
+    return nullptr;
+}
+
+void TenantScheduler::State::dispatch() {
+    while (true) {
+        Tenant* tenant = nullptr;
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (in_flight_ >= max_in_flight_) {
+                return;
+            }
+            tenant = pick_locked();
+            if (tenant == nullptr) {
+                return;
+            }
+            job = std::move(tenant->queue.front());
+            tenant->queue.pop_front();
+            if (tenant->queue.empty()) {
+                // 队列已空的租户离开环，放弃剩余额度
+                active_.pop_front();
+                tenant->active = false;
+                tenant->deficit = 0;
+            } else if (tenant->deficit == 0) {
+                // 额度用完，轮到下一个租户
+                active_.pop_front();
+                active_.push_back(tenant);
+            }
+
+            const auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - job.enqueued);
+            tenant->stats.total_wait_time += wait;
+            if (wait > tenant->stats.max_wait_time) {
+                tenant->stats.max_wait_time = wait;
+            }
+            ++tenant->stats.running;
+            ++in_flight_;
+        }
+
+        // 在锁外提交：有界线程池的 submit 可能阻塞，而任务完成时需要获取 mutex_
+        auto self = shared_from_this();
+        try {
+            pool_.submit([self, tenant, task = job.task]() {
+                self->execute(task, tenant);
+                self->dispatch();
+            });
+        } catch (...) {
+            // 线程池拒绝了提交（已满、准入控制拒绝或已停止）：任务按失败处理并丢弃，
+            // submit 的 future 收到 broken_promise 错误。不能在当前线程中执行它：
+            // 那会让一次 post 同步执行其他租户的任务，绕过准入控制与并发上限
+            job = Job();
+            std::lock_guard<std::mutex> lock(mutex_);
+            --tenant->stats.running;
+            ++tenant->stats.rejected;
+            --in_flight_;
+            if (in_flight_ != 0) {
+                // 执行中的任务完成时会再次调度
+                return;
+            }
+        }
+    }
+}
+
+void TenantScheduler::State::execute(const std::function<void()>& task, Tenant* tenant) {
+    try {
+        task();
+    } catch (...) {
+        // post 提交的任务没有人接收异常，忽略它以免影响调度
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    --tenant->stats.running;
+    ++tenant->stats.completed;
+    --in_flight_;
+}
+
+} // namespace cppthreadflow
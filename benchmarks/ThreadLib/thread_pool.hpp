@@ -7,12 +7,62 @@
 #include <memory>
 #include <stdexcept>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <type_traits>
+#include "admission_controller.hpp"
+#include "cancellation.hpp"
+#include "concurrent_priority_queue.hpp"
 #include "concurrent_queue.hpp"
 namespace cppthreadflow {
+
+/**
+ * @brief 线程池的构造选项。
+ */
+struct ThreadPoolOptions {
+    // 工作线程数量
+    size_t num_threads = std::thread::hardware_concurrency();
+    // 任务队列容量，ConcurrentQueue<...>::kUnbounded (0) 表示无界
+    size_t queue_capacity = 0;
+    // 任务队列已满时 submit 的处理方式：
+    // kBlock 阻塞提交者；kFailFast 抛出 QueueFullError；
+    // kDropOldest/kDropNewest 丢弃任务，被丢弃任务的 future 会收到 broken_promise 错误
+    OverflowPolicy overflow_policy = OverflowPolicy::kBlock;
+    // submit_with_deadline 任务的排序保证：kRelaxed 使用多个子堆以减少争用，
+    // 出队的是近似（而不一定是全局）最早截止的任务；kStrict 使用单个堆
+    PriorityOrdering deadline_ordering = PriorityOrdering::kRelaxed;
+    // 为 true 时，开始执行前已过截止时间的任务不再执行，
+    // 其 future 会收到 OperationCancelled 异常
+    bool drop_expired_tasks = false;
+    // 自适应准入控制：启用后，已接纳而未执行完的任务数超过动态上限时，
+    // submit 抛出 AdmissionRejected，而不是让队列与延迟无限增长
+    AdmissionOptions admission;
+};
+
+/**
+ * @brief submit_with_deadline 任务的统计。
+ */
+struct DeadlineStats {
+    std::uint64_t submitted = 0;  // 提交的带截止时间的任务数
+    std::uint64_t expired = 0;    // 开始执行前已过期而被丢弃的任务数
+    std::uint64_t late = 0;       // 过了截止时间才开始执行的任务数
+};
+
+/**
+ * @brief 有界线程池在 kFailFast 策略下队列已满时，submit 抛出的异常。
+ */
+class QueueFullError : public std::runtime_error {
+public:
+    QueueFullError() : std::runtime_error("ThreadPool task queue is full") {}
+};
+
 class ThreadPool {
 public:
+    using Clock = std::chrono::steady_clock;
+
     explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency());
+    // 使用有界任务队列时，submit 会对上游施加背压，而不是让队列无限增长
+    explicit ThreadPool(const ThreadPoolOptions& options);
     ~ThreadPool();
 
     // 禁止拷贝和移动，因为线程池是唯一的资源管理者
@@ -21,20 +71,132 @@ public:
     ThreadPool(ThreadPool&&) = delete;
     ThreadPool& operator=(ThreadPool&&) = delete;
     // 模板参数
-    template<class F, class... Args>
+    template<class F, class... Args,
+             std::enable_if_t<!std::is_same_v<std::decay_t<F>, CancellationToken>, int> = 0>
     auto submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>;
 
+    // 提交一个可取消的任务：如果任务开始执行前令牌已被取消（或已过截止时间），
+    // 任务不会执行，future 将收到 OperationCancelled 异常，从而在过载时丢弃已无用的工作
+    template<class F, class... Args>
+    auto submit(const CancellationToken& token, F&& f, Args&&... args)
+        -> std::future<std::invoke_result_t<F, Args...>>;
+
+    // 提交一个带截止时间的任务。带截止时间的任务之间按最早截止时间优先（EDF）执行，
+    // 而不是提交顺序：每次提交向 FIFO 队列放入一张“票据”，工作线程取到票据时，
+    // 执行截止时间队列中最早截止的任务。因此它们与普通任务共享队列容量与溢出策略，
+    // 被溢出策略丢弃的票据会丢弃一个带截止时间的任务（future 收到 broken_promise 错误）。
+    // 局限：
+    // - EDF 只在带截止时间的任务之间生效。票据仍按 FIFO 排在之前提交的所有普通任务之后，
+    //   截止时间再紧的任务也要等这些普通任务先被取走，不会插队到它们前面；
+    // - 宽松队列的出队可能与并发的入队、出队错过，有限次重试仍取不到时，
+    //   票据退回 FIFO 顺序，执行它自己对应的任务，而不是忙等最早截止的那个
+    template<class F, class... Args>
+    auto submit_with_deadline(Clock::time_point deadline, F&& f, Args&&... args)
+        -> std::future<std::invoke_result_t<F, Args...>>;
+
+    // 获取带截止时间任务的统计
+    DeadlineStats deadline_stats() const;
+
+    // 获取任务队列的溢出统计（丢弃、拒绝的任务数以及提交者阻塞的时间）
+    OverflowStats queue_stats() const { return task_queue_.overflow_stats(); }
+
+    // 获取任务队列已满时的溢出策略
+    OverflowPolicy overflow_policy() const { return task_queue_.overflow_policy(); }
+
+    // 获取准入控制的当前上限；未启用准入控制时返回 0
+    size_t admission_limit() const { return admission_ ? admission_->current_limit() : 0; }
+
+    // 获取准入控制的统计；未启用准入控制时返回全零的统计
+    AdmissionStats admission_stats() const { return admission_ ? admission_->stats() : AdmissionStats(); }
+
+    // 获取工作线程数量
+    size_t thread_count() const { return workers_.size(); }
+
+    // 获取当前排队等待执行的任务数
+    size_t pending_tasks() const { return task_queue_.size(); }
+
+    // 如果队列中有任务，在当前线程中取出并执行一个，返回是否执行了任务。
+    // 等待其他任务的线程（包括工作线程自己）可以借此帮忙，而不是挂起
+    bool try_run_pending_task();
+
 private:
+    // 截止时间队列连续取不到任务时，退回 FIFO 顺序之前的重试次数
+    static constexpr int kDeadlineClaimAttempts = 4;
+
+    // 截止时间队列中的一个任务，claimed 保证它只被执行或丢弃一次
+    struct DeadlineTask {
+        Clock::time_point deadline;
+        std::uint64_t sequence;
+        std::function<void()> run;
+        std::atomic<bool> claimed{false};
+    };
+    using DeadlineTaskPtr = std::shared_ptr<DeadlineTask>;
+
+    // 截止时间早的优先级高；截止时间相同时先提交的优先
+    struct EarlierDeadline {
+        bool operator()(const DeadlineTaskPtr& a, const DeadlineTaskPtr& b) const {
+            if (a->deadline != b->deadline) {
+                return a->deadline > b->deadline;
+            }
+            return a->sequence > b->sequence;
+        }
+    };
+
+    // FIFO 队列中的票据：执行时运行最早截止的任务；未执行就被销毁时（溢出策略丢弃、
+    // 提交失败）丢弃一个任务，优先丢弃自己对应的那个，使票据数与未认领的任务数保持一致
+    class DeadlineTicket {
+    public:
+        DeadlineTicket(ThreadPool* pool, DeadlineTaskPtr own)
+            : pool_(pool), own_(std::move(own)) {}
+        ~DeadlineTicket() {
+            if (!used_) {
+                pool_->drop_deadline_task(own_);
+            }
+        }
+
+        // 禁止拷贝和移动
+        DeadlineTicket(const DeadlineTicket&) = delete;
+        DeadlineTicket& operator=(const DeadlineTicket&) = delete;
+
+        void run() {
+            used_ = true;
+            pool_->run_deadline_task(own_);
+        }
+
+    private:
+        ThreadPool* pool_;
+        DeadlineTaskPtr own_;
+        bool used_ = false;
+    };
+
     // 工作线程的执行函数
     void worker_thread();
 
+    // 将任务放入 FIFO 队列，并按溢出策略处理放入失败的情况；
+    // 启用准入控制时先申请名额，被拒绝则抛出 AdmissionRejected
+    void enqueue(std::function<void()> task);
+
+    // 认领一个截止时间最早的未认领任务；截止时间队列多次取不到时，退回认领 own
+    DeadlineTaskPtr claim_deadline_task(const DeadlineTaskPtr& own);
+    void run_deadline_task(const DeadlineTaskPtr& own);
+    void drop_deadline_task(const DeadlineTaskPtr& own) noexcept;
+
     std::vector<std::thread> workers_;
+    // 必须在 task_queue_ 之前声明：task_queue_ 中剩余的票据析构时会访问它
+    ConcurrentPriorityQueue<DeadlineTaskPtr, EarlierDeadline> deadline_queue_;
+    const bool drop_expired_tasks_;
+    std::atomic<std::uint64_t> deadline_sequence_{0};
+    std::atomic<std::uint64_t> deadline_expired_{0};
+    std::atomic<std::uint64_t> deadline_late_{0};
+    // 未启用准入控制时为空；必须在 task_queue_ 之前声明，队列中剩余的任务析构时会归还名额
+    std::unique_ptr<AdmissionController> admission_;
     ConcurrentQueue<std::function<void()>> task_queue_;
     std::atomic<bool> stop_flag_{false};
 };
 
 
-template<class F, class... Args>
+template<class F, class... Args,
+         std::enable_if_t<!std::is_same_v<std::decay_t<F>, CancellationToken>, int>>
 auto ThreadPool::submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
     if (stop_flag_) {
         throw std::runtime_error("submit on a stopped ThreadPool");
@@ -51,7 +213,56 @@ auto ThreadPool::submit(F&& f, Args&&... args) -> std::future<std::invoke_result
     std::future<return_type> future = task->get_future();
 
     // 将任务的执行体（lambda）放入队列
-    task_queue_.push([task]() { (*task)(); });
+    enqueue([task]() { (*task)(); });
+
+    return future;
+}
+
+template<class F, class... Args>
+auto ThreadPool::submit(const CancellationToken& token, F&& f, Args&&... args)
+    -> std::future<std::invoke_result_t<F, Args...>> {
+    // 在工作线程取出任务时检查令牌，而不是提交时：排队期间被取消的任务同样会被丢弃
+    return submit([token, bound = std::bind(std::forward<F>(f), std::forward<Args>(args)...)]() mutable {
+        token.throw_if_cancellation_requested();
+        return bound();
+    });
+}
+
+template<class F, class... Args>
+auto ThreadPool::submit_with_deadline(Clock::time_point deadline, F&& f, Args&&... args)
+    -> std::future<std::invoke_result_t<F, Args...>> {
+    if (stop_flag_) {
+        throw std::runtime_error("submit on a stopped ThreadPool");
+    }
+
+    using return_type = std::invoke_result_t<F, Args...>;
+
+    // 在开始执行时检查截止时间：排队期间过期的任务按选项丢弃或记为迟到
+    auto task = std::make_shared<std::packaged_task<return_type()>>(
+        [this, deadline, bound = std::bind(std::forward<F>(f), std::forward<Args>(args)...)]() mutable
+            -> return_type {
+            if (Clock::now() > deadline) {
+                if (drop_expired_tasks_) {
+                    deadline_expired_.fetch_add(1, std::memory_order_relaxed);
+                    throw OperationCancelled();
+                }
+                deadline_late_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return bound();
+        });
+
+    std::future<return_type> future = task->get_future();
+
+    auto entry = std::make_shared<DeadlineTask>();
+    entry->deadline = deadline;
+    entry->sequence = deadline_sequence_.fetch_add(1, std::memory_order_relaxed);
+    entry->run = [task]() { (*task)(); };
+
+    // 先放入任务再放入票据，保证任何时刻未认领的任务数不少于排队的票据数
+    deadline_queue_.push(entry);
+    enqueue([ticket = std::make_shared<DeadlineTicket>(this, std::move(entry))]() {
+        ticket->run();
+    });
 
     return future;
 }
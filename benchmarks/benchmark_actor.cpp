@@ -0,0 +1,100 @@
+﻿#include <benchmark/benchmark.h>
+#include "ThreadLib/actor.hpp"
+#include "ThreadLib/thread_pool.hpp"
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Ball {
+    int remaining;
+    cppthreadflow::ActorRef<Ball> reply_to;
+    std::promise<void>* done;
+};
+
+// 收到球後把剩餘次數減一，回覆給發送者
+class Player : public cppthreadflow::Actor<Ball> {
+protected:
+    void receive(Ball& ball) override {
+        if (ball.remaining == 0) {
+            ball.done->set_value();
+            return;
+        }
+        ball.reply_to.tell(Ball{ball.remaining - 1, self(), ball.done});
+    }
+};
+
+// 收到 kEnd 時匯報本地計數，其餘消息只累加
+class Session : public cppthreadflow::Actor<int> {
+public:
+    static constexpr int kEnd = -1;
+    Session(std::atomic<int>* finished) : finished_(finished) {}
+
+protected:
+    void receive(int& value) override {
+        if (value == kEnd) {
+            benchmark::DoNotOptimize(sum_);
+            finished_->fetch_add(1, std::memory_order_release);
+            return;
+        }
+        sum_ += value;
+    }
+
+private:
+    std::atomic<int>* finished_;
+    long long sum_ = 0;
+};
+
+} // namespace
+
+// 1. 乒乓：兩個 actor 之間來回傳遞一條消息，衡量單條消息的調度延遲
+static void BM_Actor_PingPong(benchmark::State& state) {
+    const int round_trips = 10000;
+    cppthreadflow::ThreadPool pool(static_cast<size_t>(state.range(0)));
+    auto ping = cppthreadflow::spawn<Player>(pool, {});
+    auto pong = cppthreadflow::spawn<Player>(pool, {});
+    for (auto _ : state) {
+        std::promise<void> done;
+        pong.tell(Ball{round_trips, ping, &done});
+        done.get_future().wait();
+    }
+    state.SetItemsProcessed(state.iterations() * round_trips);
+}
+
+// 2. 扇出：一個發送者向大量會話 actor 各發送若干消息
+static void BM_Actor_FanOut(benchmark::State& state) {
+    const int num_sessions = static_cast<int>(state.range(0));
+    const int messages_per_session = 16;
+    cppthreadflow::ThreadPool pool(4);
+    std::atomic<int> finished(0);
+    std::vector<cppthreadflow::ActorRef<int>> sessions;
+    for (int i = 0; i < num_sessions; ++i) {
+        sessions.push_back(cppthreadflow::spawn<Session>(pool, {}, &finished));
+    }
+    for (auto _ : state) {
+        finished.store(0);
+        for (int j = 0; j < messages_per_session; ++j) {
+            for (auto& session : sessions) {
+                session.tell(j);
+            }
+        }
+        for (auto& session : sessions) {
+            session.tell(Session::kEnd);
+        }
+        while (finished.load(std::memory_order_acquire) < num_sessions) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * num_sessions * (messages_per_session + 1));
+}
+
+// 註冊測試
+BENCHMARK(BM_Actor_PingPong)
+    ->Arg(1)->Arg(2)->Arg(4)
+    ->UseRealTime();
+
+BENCHMARK(BM_Actor_FanOut)
+    ->Arg(100)->Arg(10000)
+    ->UseRealTime();
@@ -0,0 +1,86 @@
+﻿#include <benchmark/benchmark.h>
+#include "ThreadLib/concurrent_queue.hpp"
+#include "ThreadLib/disruptor.hpp"
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// 每次迭代由一個生產者發布一批事件，所有消費者都要處理每個事件
+static constexpr int kEventsPerIteration = 10000;
+
+struct MarketEvent {
+    std::int64_t price = 0;
+    std::int64_t quantity = 0;
+};
+
+// 1. 基線：每個消費者一個 ConcurrentQueue，生產者把事件拷貝到每個隊列
+static void BM_ConcurrentQueue_FanOut(benchmark::State& state) {
+    const int num_consumers = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        std::vector<std::unique_ptr<cppthreadflow::ConcurrentQueue<MarketEvent>>> queues;
+        std::vector<std::thread> consumers;
+        for (int i = 0; i < num_consumers; ++i) {
+            queues.push_back(std::make_unique<cppthreadflow::ConcurrentQueue<MarketEvent>>());
+        }
+        for (int i = 0; i < num_consumers; ++i) {
+            consumers.emplace_back([&queues, i]() {
+                MarketEvent event;
+                std::int64_t sum = 0;
+                while (queues[i]->pop(event)) {
+                    sum += event.price * event.quantity;
+                }
+                benchmark::DoNotOptimize(sum);
+            });
+        }
+        for (int j = 0; j < kEventsPerIteration; ++j) {
+            for (auto& queue : queues) {
+                queue->push(MarketEvent{j, 1});
+            }
+        }
+        for (auto& queue : queues) {
+            queue->stop();
+        }
+        for (auto& t : consumers) {
+            t.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kEventsPerIteration);
+}
+
+// 2. Disruptor：事件原地寫入環形緩衝區，所有消費者讀取同一份事件
+static void BM_Disruptor_FanOut(benchmark::State& state) {
+    const int num_consumers = static_cast<int>(state.range(0));
+    const auto strategy = static_cast<cppthreadflow::WaitStrategy>(state.range(1));
+    for (auto _ : state) {
+        cppthreadflow::Disruptor<MarketEvent> disruptor(1024, strategy);
+        std::vector<std::int64_t> sums(num_consumers);
+        for (int i = 0; i < num_consumers; ++i) {
+            disruptor.add_consumer([&sums, i](MarketEvent& event, std::int64_t, bool) {
+                sums[i] += event.price * event.quantity;
+            });
+        }
+        disruptor.start();
+        for (int j = 0; j < kEventsPerIteration; ++j) {
+            disruptor.publish_event([j](MarketEvent& event) {
+                event.price = j;
+                event.quantity = 1;
+            });
+        }
+        disruptor.shutdown();
+        benchmark::DoNotOptimize(sums.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kEventsPerIteration);
+}
+
+// 註冊測試
+BENCHMARK(BM_ConcurrentQueue_FanOut)
+    ->Arg(1)->Arg(3)
+    ->UseRealTime();
+
+BENCHMARK(BM_Disruptor_FanOut)
+    ->Args({1, static_cast<int>(cppthreadflow::WaitStrategy::kYield)})
+    ->Args({3, static_cast<int>(cppthreadflow::WaitStrategy::kYield)})
+    ->Args({1, static_cast<int>(cppthreadflow::WaitStrategy::kBlocking)})
+    ->Args({3, static_cast<int>(cppthreadflow::WaitStrategy::kBlocking)})
+    ->UseRealTime();
@@ -0,0 +1,79 @@
+﻿#include <benchmark/benchmark.h>
+#include "ThreadLib/concurrent_priority_queue.hpp"
+#include <mutex>
+#include <queue>
+#include <vector>
+
+// 基線：一把互斥鎖保護的 std::priority_queue（Scheduler 目前的做法）
+template<typename T>
+class MutexPriorityQueue {
+public:
+    void push(const T& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push(value);
+    }
+    bool try_pop(T& value_out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) {
+            return false;
+        }
+        value_out = queue_.top();
+        queue_.pop();
+        return true;
+    }
+private:
+    std::mutex mutex_;
+    std::priority_queue<T> queue_;
+};
+
+// 每個線程交替入隊和出隊，隊列中始終保持一定數量的元素
+template<typename Queue>
+static void run_push_pop(benchmark::State& state, Queue& queue) {
+    if (state.thread_index() == 0) {
+        // 預先填充，避免出隊時頻繁遇到空隊列
+        for (int i = 0; i < 10000; ++i) {
+            queue.push(i);
+        }
+    }
+    int value = state.thread_index();
+    int out = 0;
+    for (auto _ : state) {
+        queue.push(value);
+        value += 7919;
+        benchmark::DoNotOptimize(queue.try_pop(out));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// 1. 基線：互斥鎖 + 堆
+static void BM_MutexPriorityQueue_PushPop(benchmark::State& state) {
+    static MutexPriorityQueue<int> queue;
+    run_push_pop(state, queue);
+}
+
+// 2. 嚴格模式（單個子隊列）
+static void BM_ConcurrentPriorityQueue_Strict_PushPop(benchmark::State& state) {
+    static cppthreadflow::ConcurrentPriorityQueue<int> queue(
+        cppthreadflow::PriorityOrdering::kStrict);
+    run_push_pop(state, queue);
+}
+
+// 3. 寬鬆模式（MultiQueue）
+static void BM_ConcurrentPriorityQueue_Relaxed_PushPop(benchmark::State& state) {
+    static cppthreadflow::ConcurrentPriorityQueue<int> queue(
+        cppthreadflow::PriorityOrdering::kRelaxed);
+    run_push_pop(state, queue);
+}
+
+// 註冊測試
+BENCHMARK(BM_MutexPriorityQueue_PushPop)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8)->Threads(16)
+    ->UseRealTime();
+
+BENCHMARK(BM_ConcurrentPriorityQueue_Strict_PushPop)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8)->Threads(16)
+    ->UseRealTime();
+
+BENCHMARK(BM_ConcurrentPriorityQueue_Relaxed_PushPop)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8)->Threads(16)
+    ->UseRealTime();
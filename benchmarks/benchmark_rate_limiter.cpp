@@ -0,0 +1,71 @@
+﻿#include <benchmark/benchmark.h>
+#include "ThreadLib/rate_limiter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+// 基線：一把互斥鎖保護的令牌桶，每次獲取時按時間補充令牌
+class MutexTokenBucket {
+public:
+    MutexTokenBucket(double rate, double burst)
+        : rate_(rate), burst_(burst), tokens_(burst), last_(std::chrono::steady_clock::now()) {}
+
+    bool try_acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - last_).count();
+        tokens_ = std::min(burst_, tokens_ + elapsed * rate_);
+        last_ = now;
+        if (tokens_ < 1.0) {
+            return false;
+        }
+        tokens_ -= 1.0;
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    const double rate_;
+    const double burst_;
+    double tokens_;
+    std::chrono::steady_clock::time_point last_;
+};
+
+// 速率遠高於獲取速度，測的是獲取本身的開銷與多線程下的擴展性
+template<typename Limiter>
+static void run_try_acquire(benchmark::State& state, Limiter& limiter) {
+    int64_t granted = 0;
+    for (auto _ : state) {
+        granted += limiter.try_acquire() ? 1 : 0;
+    }
+    benchmark::DoNotOptimize(granted);
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_MutexTokenBucket_TryAcquire(benchmark::State& state) {
+    static MutexTokenBucket limiter(1e9, 1e6);
+    run_try_acquire(state, limiter);
+}
+
+static void BM_TokenBucket_TryAcquire(benchmark::State& state) {
+    static cppthreadflow::TokenBucket limiter(1e9, 1000000);
+    run_try_acquire(state, limiter);
+}
+
+static void BM_GcraLimiter_TryAcquire(benchmark::State& state) {
+    static cppthreadflow::GcraLimiter limiter(1000000, std::chrono::milliseconds(1));
+    run_try_acquire(state, limiter);
+}
+
+// 註冊測試
+BENCHMARK(BM_MutexTokenBucket_TryAcquire)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8)
+    ->UseRealTime();
+
+BENCHMARK(BM_TokenBucket_TryAcquire)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8)
+    ->UseRealTime();
+
+BENCHMARK(BM_GcraLimiter_TryAcquire)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8)
+    ->UseRealTime();
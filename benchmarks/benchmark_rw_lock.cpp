@@ -0,0 +1,72 @@
+﻿#include <benchmark/benchmark.h>
+#include "ThreadLib/distributed_shared_mutex.hpp"
+#include "ThreadLib/seq_lock.hpp"
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+
+// 讀多寫少的配置表：每 1024 次讀取伴隨一次寫入
+struct Config {
+    std::uint64_t version = 0;
+    std::uint64_t limits[4] = {};
+};
+
+constexpr int kWriteEvery = 1024;
+
+template<typename Mutex>
+static void run_read_mostly(benchmark::State& state, Mutex& mutex, Config& config) {
+    std::uint64_t sum = 0;
+    int i = 0;
+    for (auto _ : state) {
+        if (++i % kWriteEvery == 0) {
+            std::unique_lock<Mutex> lock(mutex);
+            ++config.version;
+        } else {
+            std::shared_lock<Mutex> lock(mutex);
+            sum += config.version + config.limits[0];
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_StdSharedMutex_ReadMostly(benchmark::State& state) {
+    static std::shared_mutex mutex;
+    static Config config;
+    run_read_mostly(state, mutex, config);
+}
+
+static void BM_DistributedSharedMutex_ReadMostly(benchmark::State& state) {
+    static cppthreadflow::DistributedSharedMutex mutex;
+    static Config config;
+    run_read_mostly(state, mutex, config);
+}
+
+static void BM_SeqLock_ReadMostly(benchmark::State& state) {
+    static cppthreadflow::SeqLock<Config> config;
+    std::uint64_t sum = 0;
+    int i = 0;
+    for (auto _ : state) {
+        if (++i % kWriteEvery == 0) {
+            config.update([](Config& c) { ++c.version; });
+        } else {
+            Config c = config.load();
+            sum += c.version + c.limits[0];
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 註冊測試
+BENCHMARK(BM_StdSharedMutex_ReadMostly)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8)
+    ->UseRealTime();
+
+BENCHMARK(BM_DistributedSharedMutex_ReadMostly)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8)
+    ->UseRealTime();
+
+BENCHMARK(BM_SeqLock_ReadMostly)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8)
+    ->UseRealTime();
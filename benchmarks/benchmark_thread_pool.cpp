@@ -44,6 +44,29 @@ static void BM_ThreadPool_TaskExecution(benchmark::State& state) {
     state.SetItemsProcessed(state.iterations() * num_tasks);
 }
 
+// 3. 測試帶截止時間的提交 (EDF)，與普通 submit 對比額外開銷
+static void BM_ThreadPool_DeadlineTaskExecution(benchmark::State& state) {
+    cppthreadflow::ThreadPool pool(8);
+    const int num_tasks = state.range(0);
+    std::atomic<int> counter(0);
+
+    for (auto _ : state) {
+        cppthreadflow::Latch latch(num_tasks);
+        counter = 0;
+        const auto now = cppthreadflow::ThreadPool::Clock::now();
+
+        for (int i = 0; i < num_tasks; ++i) {
+            // 截止時間交錯，使任務不按提交順序執行
+            pool.submit_with_deadline(now + std::chrono::microseconds((i * 7919) % 1000), [&]() {
+                benchmark::DoNotOptimize(counter++);
+                latch.count_down();
+            });
+        }
+        latch.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * num_tasks);
+}
+
 // 註冊測試
 BENCHMARK(BM_SingleThread_TaskExecution)
     ->Arg(1000)
@@ -53,4 +76,9 @@ BENCHMARK(BM_SingleThread_TaskExecution)
 BENCHMARK(BM_ThreadPool_TaskExecution)
     ->Arg(1000)
     ->Arg(10000)
-    ->UseRealTime();
\ No newline at end of file
+    ->UseRealTime();
+
+BENCHMARK(BM_ThreadPool_DeadlineTaskExecution)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->UseRealTime();
@@ -0,0 +1,216 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "serial_queue.hpp"
+#include "thread_pool.hpp"
+
+namespace cppthreadflow {
+
+/**
+ * @brief 创建 actor 时的选项。
+ */
+struct ActorOptions {
+  // 每次被调度到工作线程上时最多处理的消息数，保证多个 actor 之间的公平性
+  size_t max_batch = 64;
+  // 邮箱容量，0 表示无界；邮箱已满时 tell 返回 false
+  size_t mailbox_capacity = 0;
+};
+
+template <typename Message>
+class Actor;
+
+template <typename Message>
+class ActorRef;
+
+namespace detail {
+struct ActorAccess;
+}  // namespace detail
+
+/**
+ * @brief 创建一个 actor，并返回它的引用。
+ * @tparam A 继承自 Actor<Message> 的类型。
+ * @param pool 运行 actor 的线程池，必须比 actor 活得更久。
+ * @param options actor 选项。
+ * @param args 转发给 A 构造函数的参数。
+ */
+template <typename A, typename... Args>
+ActorRef<typename A::MessageType> spawn(ThreadPool& pool,
+                                        const ActorOptions& options,
+                                        Args&&... args);
+
+/**
+ * @brief 一个 actor：拥有私有状态，通过邮箱接收 Message 类型的消息。
+ *
+ * 派生类实现 receive()，它总是被串行调用，因此可以不加锁地读写自己的成员。
+ * actor 没有专用线程：只有邮箱由空变为非空时，才会向 ThreadPool 提交一次处理任务，
+ * 每次最多处理 max_batch 条消息，还有剩余时重新提交，把工作线程让给其他 actor。
+ * 因此成千上万个有状态的会话可以共享少量工作线程。
+ *
+ * 调度与 Strand 共用同一套串行排空协议（detail::SerialQueue）。
+ * 线程池应当使用 kBlock（默认）或 kFailFast 溢出策略：
+ * 使用丢弃策略时，被丢弃的处理任务会让 actor 永远停滞，之后的消息都不会被处理。
+ *
+ * actor 由 spawn() 创建并由 shared_ptr 管理，最后一个 ActorRef 释放、
+ * 且邮箱处理完毕后才会被销毁。需要多种消息时，Message 可以是 std::variant。
+ *
+ * @tparam Message 消息类型。
+ */
+template <typename Message>
+class Actor : public std::enable_shared_from_this<Actor<Message> > {
+ public:
+  using MessageType = Message;
+
+  Actor() = default;
+
+  virtual ~Actor() {
+    mailbox_.clear(
+        [](MpscNode* node) { delete static_cast<MessageNode*>(node); });
+  }
+
+  // 禁止拷贝和移动
+  Actor(const Actor&) = delete;
+  Actor& operator=(const Actor&) = delete;
+
+ protected:
+  /**
+   * @brief 处理一条消息。抛出的异常会被忽略，不影响后续消息。
+   */
+  virtual void receive(Message& message) = 0;
+
+  /**
+   * @brief 获取指向自己的引用，例如作为回复地址发给其他 actor。
+   * 不要把它保存在自己的成员中，否则 actor 永远不会被销毁。
+   */
+  ActorRef<Message> self() {
+    return ActorRef<Message>(this->shared_from_this());
+  }
+
+ private:
+  friend class ActorRef<Message>;
+  friend struct detail::ActorAccess;
+  template <typename Pool, typename Executor>
+  friend void detail::schedule_serial_drain(Pool& pool,
+                                            std::shared_ptr<Executor> self);
+
+  struct MessageNode : MpscNode {
+    explicit MessageNode(Message m) : message(std::move(m)) {}
+    Message message;
+  };
+
+  bool tell(Message message) {
+    if (options_.mailbox_capacity != 0 &&
+        size_.fetch_add(1, std::memory_order_relaxed) >=
+            options_.mailbox_capacity) {
+      size_.fetch_sub(1, std::memory_order_relaxed);
+      rejected_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    // 只有由空变为非空的那次 tell 负责调度
+    if (mailbox_.push(new MessageNode(std::move(message)))) {
+      detail::schedule_serial_drain(*pool_, this->shared_from_this());
+    }
+    return true;
+  }
+
+  // 处理一批消息，返回是否还有剩余的消息
+  bool drain() {
+    return mailbox_.drain(options_.max_batch, [this](MpscNode* node) {
+      MessageNode* message_node = static_cast<MessageNode*>(node);
+      if (options_.mailbox_capacity != 0) {
+        size_.fetch_sub(1, std::memory_order_relaxed);
+      }
+      try {
+        receive(message_node->message);
+      } catch (...) {
+        // 没有人接收 actor 的异常，忽略它以免影响后续消息
+      }
+      delete message_node;
+    });
+  }
+
+  ThreadPool* pool_ = nullptr;
+  ActorOptions options_;
+  // 邮箱；已入队但尚未处理完的消息数由 0 变为 1 时负责调度
+  detail::SerialQueue mailbox_;
+  // 邮箱中的消息数，仅在邮箱有界时维护，用于容量检查
+  std::atomic<size_t> size_{0};
+  std::atomic<std::uint64_t> rejected_{0};
+};
+
+/**
+ * @brief 指向一个 actor 的引用，可以自由拷贝并在任意线程中使用。
+ */
+template <typename Message>
+class ActorRef {
+ public:
+  ActorRef() = default;
+
+  /**
+   * @brief 向 actor 发送一条消息，不会阻塞。
+   * @return 如果消息进入邮箱，返回 true；如果邮箱已满，返回 false。
+   */
+  bool tell(Message message) const { return actor_->tell(std::move(message)); }
+
+  /**
+   * @brief 获取邮箱中尚未处理的消息数（近似值）。
+   */
+  size_t mailbox_size() const {
+    return actor_->mailbox_.pending();
+  }
+
+  /**
+   * @brief 获取因邮箱已满而被拒绝的消息数。
+   */
+  std::uint64_t rejected_count() const {
+    return actor_->rejected_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 是否指向一个 actor。
+   */
+  explicit operator bool() const { return actor_ != nullptr; }
+
+ private:
+  friend class Actor<Message>;
+  friend struct detail::ActorAccess;
+
+  explicit ActorRef(std::shared_ptr<Actor<Message> > actor)
+      : actor_(std::move(actor)) {}
+
+  std::shared_ptr<Actor<Message> > actor_;
+};
+
+namespace detail {
+
+struct ActorAccess {
+  template <typename Message>
+  static ActorRef<Message> attach(std::shared_ptr<Actor<Message> > actor,
+                                  ThreadPool& pool,
+                                  const ActorOptions& options) {
+    actor->pool_ = &pool;
+    actor->options_ = options;
+    if (actor->options_.max_batch == 0) {
+      actor->options_.max_batch = 1;
+    }
+    return ActorRef<Message>(std::move(actor));
+  }
+};
+
+}  // namespace detail
+
+template <typename A, typename... Args>
+ActorRef<typename A::MessageType> spawn(ThreadPool& pool,
+                                        const ActorOptions& options,
+                                        Args&&... args) {
+  using Message = typename A::MessageType;
+  std::shared_ptr<Actor<Message> > actor =
+      std::make_shared<A>(std::forward<Args>(args)...);
+  return detail::ActorAccess::attach(std::move(actor), pool, options);
+}
+
+}  // namespace cppthreadflow
@@ -0,0 +1,102 @@
+﻿#include "admission_controller.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace cppthreadflow {
+
+namespace {
+constexpr size_t kDefaultLimitPerThread = 4;
+} // namespace
+
+AdmissionController::AdmissionController(const AdmissionOptions& options, size_t num_threads)
+    : target_delay_(std::chrono::duration_cast<Clock::duration>(options.target_delay)),
+      interval_(std::chrono::duration_cast<Clock::duration>(options.interval)),
+      min_limit_(options.min_limit != 0 ? options.min_limit : std::max<size_t>(1, num_threads)),
+      max_limit_(options.max_limit != 0 ? options.max_limit : std::numeric_limits<size_t>::max()),
+      backoff_(options.backoff),
+      increase_(options.increase),
+      limit_(0),
+      window_end_((Clock::now() + interval_).time_since_epoch().count()),
+      window_min_delay_(std::numeric_limits<Clock::rep>::max()) {
+    if (!(backoff_ > 0.0 && backoff_ < 1.0)) {
+        throw std::invalid_argument("AdmissionOptions backoff must be in (0, 1)");
+    }
+    if (min_limit_ > max_limit_) {
+        throw std::invalid_argument("AdmissionOptions min_limit exceeds max_limit");
+    }
+    const size_t initial = options.initial_limit != 0
+                               ? options.initial_limit
+                               : kDefaultLimitPerThread * std::max<size_t>(1, num_threads);
+    limit_.store(std::clamp(initial, min_limit_, max_limit_), std::memory_order_relaxed);
+}
+
+bool AdmissionController::try_acquire() {
+    size_t current = in_flight_.load(std::memory_order_relaxed);
+    while (true) {
+        if (current >= limit_.load(std::memory_order_relaxed)) {
+            saturated_.store(true, std::memory_order_relaxed);
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (in_flight_.compare_exchange_weak(current, current + 1, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    if (current + 1 >= limit_.load(std::memory_order_relaxed)) {
+        saturated_.store(true, std::memory_order_relaxed);
+    }
+    admitted_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void AdmissionController::release() {
+    in_flight_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void AdmissionController::on_start(Clock::duration queue_delay, Clock::time_point now) {
+    const Clock::rep delay = queue_delay.count();
+    Clock::rep current_min = window_min_delay_.load(std::memory_order_relaxed);
+    while (delay < current_min &&
+           !window_min_delay_.compare_exchange_weak(current_min, delay, std::memory_order_relaxed)) {
+    }
+
+    Clock::rep end = window_end_.load(std::memory_order_relaxed);
+    const Clock::rep now_rep = now.time_since_epoch().count();
+    if (now_rep < end) {
+        return;
+    }
+    // 只有推进了窗口的那个线程负责调整上限
+    if (!window_end_.compare_exchange_strong(end, now_rep + interval_.count(),
+                                             std::memory_order_relaxed)) {
+        return;
+    }
+    const Clock::rep min_delay = window_min_delay_.exchange(
+        std::numeric_limits<Clock::rep>::max(), std::memory_order_relaxed);
+    adjust(Clock::duration(min_delay));
+}
+
+void AdmissionController::adjust(Clock::duration min_delay) {
+    const size_t limit = limit_.load(std::memory_order_relaxed);
+    const bool saturated = saturated_.exchange(false, std::memory_order_relaxed);
+    size_t next = limit;
+    if (min_delay > target_delay_) {
+        // 持续拥塞：乘性减，至少减 1
+        next = std::min(limit - 1, static_cast<size_t>(static_cast<double>(limit) * backoff_));
+    } else if (saturated) {
+        // 没有拥塞但名额被用满过：加性增
+        next = limit > max_limit_ - increase_ ? max_limit_ : limit + increase_;
+    }
+    limit_.store(std::clamp(next, min_limit_, max_limit_), std::memory_order_relaxed);
+}
+
+AdmissionStats AdmissionController::stats() const {
+    AdmissionStats stats;
+    stats.admitted = admitted_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.limit = limit_.load(std::memory_order_relaxed);
+    stats.in_flight = in_flight_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace cppthreadflow
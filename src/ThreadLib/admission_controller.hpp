@@ -0,0 +1,134 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace cppthreadflow {
+
+/**
+ * @brief 准入控制拒绝了新任务时，ThreadPool::submit 抛出的异常。
+ * 与 QueueFullError 不同，它表示节点处于过载状态，调用者应当降级或稍后重试。
+ */
+class AdmissionRejected : public std::runtime_error {
+ public:
+  AdmissionRejected()
+      : std::runtime_error("ThreadPool admission controller rejected task") {}
+};
+
+/**
+ * @brief 准入控制的参数。
+ */
+struct AdmissionOptions {
+  // 是否启用准入控制
+  bool enabled = false;
+  // 目标排队延迟：一个观察窗口内的最小排队延迟超过它时，认为发生了拥塞
+  std::chrono::microseconds target_delay{5000};
+  // 观察窗口的长度，每个窗口结束时调整一次上限
+  std::chrono::microseconds interval{100000};
+  // 初始上限，0 表示线程数的 4 倍
+  size_t initial_limit = 0;
+  // 上限的下界，0 表示线程数
+  size_t min_limit = 0;
+  // 上限的上界，0 表示不限制
+  size_t max_limit = 0;
+  // 拥塞时上限乘以这个系数（乘性减）
+  double backoff = 0.9;
+  // 不拥塞且上限被用满时，每个窗口增加的数量（加性增）
+  size_t increase = 1;
+};
+
+/**
+ * @brief 准入控制的统计。
+ */
+struct AdmissionStats {
+  std::uint64_t admitted = 0;  // 被接纳的任务数
+  std::uint64_t rejected = 0;  // 被拒绝的任务数
+  size_t limit = 0;            // 当前上限
+  size_t in_flight = 0;        // 当前已接纳而未执行完的任务数
+};
+
+/**
+ * @brief 自适应准入控制器：限制已接纳而未执行完（排队中加执行中）的任务数。
+ *
+ * 上限按 AIMD 调整，拥塞信号来自排队延迟，做法与 CoDel 相同：
+ * 只看一个窗口内的最小排队延迟，短暂的突发不会触发降级，
+ * 而持续形成的队列（最小延迟也超过目标）会让上限按 backoff 乘性减小；
+ * 没有拥塞且上限被用满过时，上限加性增加 increase，逐步探测可用的容量。
+ * 超过上限的提交被立即拒绝，使过载时延迟保持有界，而不是无限排队。
+ */
+class AdmissionController {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief 构造函数。
+   * @param options 准入参数，其中为 0 的上限按 num_threads 计算。
+   * @param num_threads 执行任务的线程数。
+   * @throws std::invalid_argument 如果 backoff 不在 (0, 1) 内，或上下界矛盾。
+   */
+  AdmissionController(const AdmissionOptions& options, size_t num_threads);
+
+  // 禁止拷贝和移动
+  AdmissionController(const AdmissionController&) = delete;
+  AdmissionController& operator=(const AdmissionController&) = delete;
+  AdmissionController(AdmissionController&&) = delete;
+  AdmissionController& operator=(AdmissionController&&) = delete;
+
+  /**
+   * @brief 尝试接纳一个任务。
+   * @return 未达到上限时占用一个名额并返回 true，否则返回 false。
+   */
+  bool try_acquire();
+
+  /**
+   * @brief 归还一个名额（任务执行完毕或被丢弃）。
+   */
+  void release();
+
+  /**
+   * @brief 报告一个任务开始执行前的排队延迟。
+   * @param queue_delay 从提交到开始执行的时长。
+   * @param now 当前时间，窗口结束时据此调整上限。
+   */
+  void on_start(Clock::duration queue_delay,
+                Clock::time_point now = Clock::now());
+
+  /**
+   * @brief 获取当前上限。
+   */
+  size_t current_limit() const {
+    return limit_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 获取统计。
+   */
+  AdmissionStats stats() const;
+
+ private:
+  // 窗口结束：根据窗口内的最小排队延迟调整上限
+  void adjust(Clock::duration min_delay);
+
+  const Clock::duration target_delay_;
+  const Clock::duration interval_;
+  const size_t min_limit_;
+  const size_t max_limit_;
+  const double backoff_;
+  const size_t increase_;
+
+  std::atomic<size_t> limit_;
+  std::atomic<size_t> in_flight_{0};
+  std::atomic<std::uint64_t> admitted_{0};
+  std::atomic<std::uint64_t> rejected_{0};
+
+  // 当前窗口的结束时间与最小排队延迟（以 Clock::rep 计）
+  std::atomic<Clock::rep> window_end_;
+  std::atomic<Clock::rep> window_min_delay_;
+  // 当前窗口内名额是否被用满过，只有用满过才有理由增加上限
+  std::atomic<bool> saturated_{false};
+};
+
+}  // namespace cppthreadflow
@@ -49,4 +49,33 @@ void Barrier::arrive_and_wait() {
   }
 }
 
+bool Barrier::arrive_and_wait(const CancellationToken& token) {
+  // 先注册唤醒回调再加锁：已取消时回调会立即执行并获取同一把锁
+  CancellationRegistration registration =
+      detail::notify_on_cancel(token, mutex_, cv_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (token.is_cancellation_requested()) {
+    return false;
+  }
+
+  const int my_generation = generation_;
+  current_count_++;
+  if (current_count_ == party_count_) {
+    generation_++;
+    current_count_ = 0;
+    lock.unlock();
+    cv_.notify_all();
+    return true;
+  }
+
+  if (detail::wait_unless_cancelled(lock, cv_, token, [this, my_generation] {
+        return generation_ != my_generation;
+      })) {
+    return true;
+  }
+  // 被取消且这一代尚未完成：撤销本次到达
+  current_count_--;
+  return false;
+}
+
 } // namespace cppthreadflow
\ No newline at end of file
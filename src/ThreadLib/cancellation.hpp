@@ -0,0 +1,298 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace cppthreadflow {
+
+/**
+ * @brief 操作因取消或超过截止时间而被放弃时抛出的异常。
+ * 例如用已取消的令牌提交的任务，其 future 会收到这个异常。
+ */
+class OperationCancelled : public std::runtime_error {
+ public:
+  OperationCancelled() : std::runtime_error("operation cancelled") {}
+};
+
+namespace detail {
+
+/**
+ * @brief 一个取消源的共享状态。
+ *
+ * 子状态在父状态上注册一个回调，父状态被取消时同步取消子状态，
+ * 因此查询只需要读一个原子变量，回调也会沿父子关系向下触发。
+ */
+class CancellationState {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  CancellationState(std::shared_ptr<CancellationState> parent,
+                    TimePoint deadline);
+  ~CancellationState();
+
+  // 禁止拷贝和移动（父状态的回调引用了 this）
+  CancellationState(const CancellationState&) = delete;
+  CancellationState& operator=(const CancellationState&) = delete;
+
+  bool is_cancelled() const {
+    if (cancelled_.load(std::memory_order_acquire)) {
+      return true;
+    }
+    return deadline_ != TimePoint::max() && Clock::now() >= deadline_;
+  }
+
+  TimePoint deadline() const { return deadline_; }
+
+  // 发起取消并依次执行已注册的回调；重复调用无效果
+  void request_cancel();
+
+  // 注册回调并返回其标识；如果已被取消，则立即在当前线程执行回调并返回 0
+  std::uint64_t add_callback(std::function<void()> callback);
+
+  // 注销回调；如果回调正在另一个线程中执行，等待它执行完
+  void remove_callback(std::uint64_t id);
+
+ private:
+  std::atomic<bool> cancelled_{false};
+  const std::shared_ptr<CancellationState> parent_;
+  // 自身与所有祖先中最早的截止时间
+  const TimePoint deadline_;
+  std::uint64_t parent_callback_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable callback_done_;
+  std::map<std::uint64_t, std::function<void()> > callbacks_;
+  std::uint64_t next_id_ = 1;
+  std::uint64_t running_callback_ = 0;
+  std::thread::id callback_thread_;
+};
+
+}  // namespace detail
+
+/**
+ * @brief 取消回调的注册句柄：析构（或调用 unregister）时注销回调。
+ *
+ * 注销保证返回之后回调不会再被执行；如果回调正在另一个线程中执行，会等待它结束，
+ * 因此回调可以安全地引用注册者栈上的对象。
+ */
+class CancellationRegistration {
+ public:
+  CancellationRegistration() = default;
+  ~CancellationRegistration() { unregister(); }
+
+  CancellationRegistration(CancellationRegistration&& other) noexcept
+      : state_(std::move(other.state_)), id_(std::exchange(other.id_, 0)) {}
+
+  CancellationRegistration& operator=(
+      CancellationRegistration&& other) noexcept {
+    if (this != &other) {
+      unregister();
+      state_ = std::move(other.state_);
+      id_ = std::exchange(other.id_, 0);
+    }
+    return *this;
+  }
+
+  CancellationRegistration(const CancellationRegistration&) = delete;
+  CancellationRegistration& operator=(const CancellationRegistration&) = delete;
+
+  /**
+   * @brief 注销回调。可以重复调用。
+   */
+  void unregister() {
+    if (state_ != nullptr && id_ != 0) {
+      state_->remove_callback(id_);
+    }
+    state_.reset();
+    id_ = 0;
+  }
+
+ private:
+  friend class CancellationToken;
+
+  CancellationRegistration(std::shared_ptr<detail::CancellationState> state,
+                           std::uint64_t id)
+      : state_(std::move(state)), id_(id) {}
+
+  std::shared_ptr<detail::CancellationState> state_;
+  std::uint64_t id_ = 0;
+};
+
+/**
+ * @brief 协作式取消的令牌：只能查询，不能发起取消。
+ *
+ * 长时间运行的任务应当定期检查 is_cancellation_requested()，并尽快返回；
+ * 阻塞等待（队列、信号量、门闩、屏障）可以接收令牌，被取消或到达截止时间时提前返回。
+ * 默认构造的令牌永远不会被取消。令牌可以自由拷贝，拷贝之间共享状态。
+ */
+class CancellationToken {
+ public:
+  using Clock = detail::CancellationState::Clock;
+  using TimePoint = detail::CancellationState::TimePoint;
+
+  CancellationToken() = default;
+
+  /**
+   * @brief 是否已经请求取消（自身的源或任何一个祖先源被取消，或已过截止时间）。
+   */
+  bool is_cancellation_requested() const {
+    return state_ != nullptr && state_->is_cancelled();
+  }
+
+  /**
+   * @brief 如果已经请求取消，抛出 OperationCancelled。
+   */
+  void throw_if_cancellation_requested() const {
+    if (is_cancellation_requested()) {
+      throw OperationCancelled();
+    }
+  }
+
+  /**
+   * @brief 这个令牌是否关联到某个取消源。
+   */
+  bool can_be_cancelled() const { return state_ != nullptr; }
+
+  /**
+   * @brief 是否有截止时间。
+   */
+  bool has_deadline() const { return deadline() != TimePoint::max(); }
+
+  /**
+   * @brief 获取截止时间；没有截止时间时返回 TimePoint::max()。
+   */
+  TimePoint deadline() const {
+    return state_ != nullptr ? state_->deadline() : TimePoint::max();
+  }
+
+  /**
+   * @brief 注册一个在 cancel() 时执行的回调，通常用于唤醒阻塞的等待者。
+   *
+   * 回调在调用 cancel() 的线程中执行；如果已经被取消，则立即在当前线程执行。
+   * 仅仅到达截止时间不会触发回调，需要截止时间的等待应当使用 deadline()。
+   * @return 注册句柄，析构时注销回调。
+   */
+  [[nodiscard]] CancellationRegistration register_callback(
+      std::function<void()> callback) const {
+    if (state_ == nullptr) {
+      return CancellationRegistration();
+    }
+    const std::uint64_t id = state_->add_callback(std::move(callback));
+    return CancellationRegistration(state_, id);
+  }
+
+ private:
+  friend class CancellationSource;
+
+  explicit CancellationToken(std::shared_ptr<detail::CancellationState> state)
+      : state_(std::move(state)) {}
+
+  std::shared_ptr<detail::CancellationState> state_;
+};
+
+/**
+ * @brief 取消源：发起取消，并分发与之关联的令牌。
+ *
+ * 可以用父令牌构造一个子源：父源被取消时，子源也被取消（并触发子源的回调），
+ * 而取消子源不会影响父源。这样取消可以沿任务的嵌套结构向下传播。
+ * 还可以指定截止时间：过了截止时间，令牌即报告已取消。
+ */
+class CancellationSource {
+ public:
+  using TimePoint = CancellationToken::TimePoint;
+
+  CancellationSource();
+
+  /**
+   * @brief 构造一个与父令牌关联的子源。
+   */
+  explicit CancellationSource(const CancellationToken& parent);
+
+  /**
+   * @brief 构造一个带截止时间的源。
+   */
+  explicit CancellationSource(TimePoint deadline);
+
+  /**
+   * @brief 构造一个与父令牌关联、并带有截止时间的子源。
+   * 实际的截止时间取自身与父令牌中较早的一个。
+   */
+  CancellationSource(const CancellationToken& parent, TimePoint deadline);
+
+  /**
+   * @brief 构造一个在 timeout 之后到期的源。
+   */
+  template <typename Rep, typename Period>
+  static CancellationSource with_timeout(
+      const std::chrono::duration<Rep, Period>& timeout) {
+    using Clock = CancellationToken::Clock;
+    return CancellationSource(
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout));
+  }
+
+  /**
+   * @brief 请求取消，并在当前线程中执行所有已注册的回调。
+   * 可以重复调用，也可以在任意线程中调用。
+   */
+  void cancel();
+
+  /**
+   * @brief 是否已经请求取消（包括父源被取消或已过截止时间）。
+   */
+  bool is_cancellation_requested() const;
+
+  /**
+   * @brief 获取与这个源关联的令牌。
+   */
+  CancellationToken token() const;
+
+ private:
+  std::shared_ptr<detail::CancellationState> state_;
+};
+
+namespace detail {
+
+/**
+ * @brief 注册一个回调：令牌被取消时，在 mutex 保护下唤醒 cv 上的所有等待者。
+ * 必须在锁定 mutex 之前调用，因为已取消时回调会立即执行。
+ */
+inline CancellationRegistration notify_on_cancel(
+    const CancellationToken& token, std::mutex& mutex,
+    std::condition_variable& cv) {
+  return token.register_callback([&mutex, &cv] {
+    std::lock_guard<std::mutex> lock(mutex);
+    cv.notify_all();
+  });
+}
+
+/**
+ * @brief 在 cv 上等待，直到 pred() 成立，或令牌被取消/到达截止时间。
+ * 调用者需要先用 notify_on_cancel 注册唤醒回调。
+ * @return pred() 的最终结果；条件与取消同时成立时，条件优先。
+ */
+template <typename Pred>
+bool wait_unless_cancelled(std::unique_lock<std::mutex>& lock,
+                           std::condition_variable& cv,
+                           const CancellationToken& token, Pred pred) {
+  auto done = [&] { return pred() || token.is_cancellation_requested(); };
+  if (token.has_deadline()) {
+    cv.wait_until(lock, token.deadline(), done);
+  } else {
+    cv.wait(lock, done);
+  }
+  return pred();
+}
+
+}  // namespace detail
+
+}  // namespace cppthreadflow
@@ -0,0 +1,469 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include "hash_utils.hpp"
+
+namespace cppthreadflow {
+
+template <typename T>
+class Channel;
+
+// select 超时（或非阻塞 select 没有就绪的分支）时的返回值
+inline constexpr int kSelectTimeout = -1;
+
+namespace detail {
+
+/**
+ * @brief 一次阻塞的 send/recv/select 在各通道上登记的共享等待者。
+ *
+ * 一个 select 在多个通道上登记同一个等待者，第一个把 fired 从 kPending
+ * 改为分支下标的对端操作“赢得”它，并在通道锁内完成数据交接；
+ * 其余通道上的登记随后被 select 撤销。线程只在 cv 上挂起一次。
+ */
+struct ChannelWaiter {
+  static constexpr int kPending = -1;
+  static constexpr int kTimedOut = -2;
+
+  bool try_fire(int index) {
+    int expected = kPending;
+    return fired.compare_exchange_strong(expected, index,
+                                         std::memory_order_acq_rel);
+  }
+
+  // 数据交接完成后由对端调用。必须在持有 mutex 时通知：
+  // 等待方一旦看到 done 就可能返回并销毁本对象
+  void complete() {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+    cv.notify_one();
+  }
+
+  std::atomic<int> fired{kPending};
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+};
+
+}  // namespace detail
+
+/**
+ * @brief select 中的接收分支，由 on_recv() 创建。
+ */
+template <typename T>
+class RecvCase {
+ public:
+  RecvCase(Channel<T>& channel, T& out, bool* ok)
+      : channel_(channel), out_(out), ok_(ok) {}
+
+  std::mutex* mutex() const { return &channel_.mutex_; }
+  bool try_complete_locked() { return channel_.try_recv_locked(out_, ok_); }
+  void enqueue_locked(detail::ChannelWaiter* waiter, int index) {
+    channel_.recv_waiters_.push_back({waiter, index, &out_, ok_});
+  }
+  void dequeue(detail::ChannelWaiter* waiter) { channel_.dequeue(waiter); }
+
+ private:
+  Channel<T>& channel_;
+  T& out_;
+  bool* ok_;
+};
+
+/**
+ * @brief select 中的发送分支，由 on_send() 创建。
+ */
+template <typename T>
+class SendCase {
+ public:
+  SendCase(Channel<T>& channel, T& value, bool* ok)
+      : channel_(channel), value_(value), ok_(ok) {}
+
+  std::mutex* mutex() const { return &channel_.mutex_; }
+  bool try_complete_locked() { return channel_.try_send_locked(value_, ok_); }
+  void enqueue_locked(detail::ChannelWaiter* waiter, int index) {
+    channel_.send_waiters_.push_back({waiter, index, &value_, ok_});
+  }
+  void dequeue(detail::ChannelWaiter* waiter) { channel_.dequeue(waiter); }
+
+ private:
+  Channel<T>& channel_;
+  T& value_;
+  bool* ok_;
+};
+
+/**
+ * @brief 创建一个接收分支：就绪时把收到的值写入 out。
+ * 通道已关闭且为空时分支同样就绪，此时 out 不变。
+ */
+template <typename T>
+RecvCase<T> on_recv(Channel<T>& channel, T& out) {
+  return RecvCase<T>(channel, out, nullptr);
+}
+
+/**
+ * @brief 创建一个接收分支，ok 表示是否收到了值（false 表示通道已关闭且为空）。
+ */
+template <typename T>
+RecvCase<T> on_recv(Channel<T>& channel, T& out, bool& ok) {
+  return RecvCase<T>(channel, out, &ok);
+}
+
+/**
+ * @brief 创建一个发送分支：只有该分支被选中时，value 才会被移走。
+ * 通道已关闭时分支同样就绪，但值不会被发送。
+ */
+template <typename T>
+SendCase<T> on_send(Channel<T>& channel, T& value) {
+  return SendCase<T>(channel, value, nullptr);
+}
+
+/**
+ * @brief 创建一个发送分支，ok 表示值是否被发送（false 表示通道已关闭）。
+ */
+template <typename T>
+SendCase<T> on_send(Channel<T>& channel, T& value, bool& ok) {
+  return SendCase<T>(channel, value, &ok);
+}
+
+namespace detail {
+
+template <typename Tuple, size_t... I>
+int try_select_cases(Tuple& cases, size_t start, std::index_sequence<I...>) {
+  constexpr size_t kCount = sizeof...(I);
+  int result = kSelectTimeout;
+  // 从随机位置开始轮询，避免总是偏向排在前面的分支
+  for (size_t k = 0; k < kCount && result == kSelectTimeout; ++k) {
+    const size_t index = (start + k) % kCount;
+    ((result == kSelectTimeout && index == I &&
+              std::get<I>(cases).try_complete_locked()
+          ? (result = static_cast<int>(I), 0)
+          : 0),
+     ...);
+  }
+  return result;
+}
+
+template <typename Clock, typename Duration, typename... Cases>
+int select_impl(
+    const std::optional<std::chrono::time_point<Clock, Duration> >& deadline,
+    Cases&... cases) {
+  static_assert(sizeof...(Cases) > 0, "select requires at least one case");
+  auto tuple = std::tie(cases...);
+  constexpr auto kIndices = std::index_sequence_for<Cases...>();
+
+  // 按地址顺序锁住所有涉及的通道，避免多个 select 之间死锁
+  std::array<std::mutex*, sizeof...(Cases)> mutexes = {cases.mutex()...};
+  std::sort(mutexes.begin(), mutexes.end());
+  auto end = std::unique(mutexes.begin(), mutexes.end());
+  auto unlock_all = [&mutexes, end]() {
+    for (auto it = mutexes.begin(); it != end; ++it) {
+      (*it)->unlock();
+    }
+  };
+  for (auto it = mutexes.begin(); it != end; ++it) {
+    (*it)->lock();
+  }
+
+  const int ready = try_select_cases(
+      tuple, detail::thread_random() % sizeof...(Cases), kIndices);
+  if (ready != kSelectTimeout ||
+      (deadline.has_value() && *deadline <= Clock::now())) {
+    unlock_all();
+    return ready;
+  }
+
+  // 没有就绪的分支：在所有通道上登记同一个等待者，然后只挂起一次
+  ChannelWaiter waiter;
+  int index = 0;
+  ((cases.enqueue_locked(&waiter, index++)), ...);
+  unlock_all();
+
+  bool timed_out = false;
+  {
+    std::unique_lock<std::mutex> lock(waiter.mutex);
+    auto is_done = [&waiter] { return waiter.done; };
+    if (deadline.has_value()) {
+      if (!waiter.cv.wait_until(lock, *deadline, is_done)) {
+        if (waiter.try_fire(ChannelWaiter::kTimedOut)) {
+          timed_out = true;
+        } else {
+          // 对端已经赢得了等待者，正在完成交接
+          waiter.cv.wait(lock, is_done);
+        }
+      }
+    } else {
+      waiter.cv.wait(lock, is_done);
+    }
+  }
+
+  // 撤销其他通道上的登记，之后才能销毁 waiter
+  ((cases.dequeue(&waiter)), ...);
+  return timed_out ? kSelectTimeout
+                   : waiter.fired.load(std::memory_order_acquire);
+}
+
+}  // namespace detail
+
+/**
+ * @brief 等待多个发送/接收分支中的任意一个就绪，并执行它。
+ *
+ * 如果有多个分支同时就绪，随机选择一个。没有分支就绪时，线程在所有通道上登记
+ * 同一个等待者后挂起一次，不会忙等。
+ * @return 被执行的分支的下标（从 0 开始）。
+ */
+template <typename... Cases>
+int select(Cases&&... cases) {
+  using TimePoint = std::chrono::steady_clock::time_point;
+  return detail::select_impl(std::optional<TimePoint>(), cases...);
+}
+
+/**
+ * @brief 与 select 相同，但最多等待 timeout。
+ * timeout 为 0 时只检查一次，不会阻塞（相当于带 default 分支的 select）。
+ * @return 被执行的分支的下标；超时返回 kSelectTimeout。
+ */
+template <typename Rep, typename Period, typename... Cases>
+int select_for(const std::chrono::duration<Rep, Period>& timeout,
+               Cases&&... cases) {
+  return detail::select_impl(
+      std::optional<std::chrono::steady_clock::time_point>(
+          std::chrono::steady_clock::now() +
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              timeout)),
+      cases...);
+}
+
+/**
+ * @brief 一个类型化的 Go 风格通道。
+ *
+ * capacity 为 0 时是无缓冲（同步）通道：send 会一直阻塞，直到有接收者取走这个值；
+ * capacity 大于 0 时是缓冲通道：缓冲区未满时 send 立即返回。
+ *
+ * 关闭之后，send 返回 false；recv 仍能取完缓冲区中剩余的值，之后返回 false。
+ * 通道可以与 select/select_for 搭配，在一个线程中等待多个通道。
+ *
+ * @tparam T 通道中传递的元素类型。
+ */
+template <typename T>
+class Channel {
+ public:
+  /**
+   * @brief 构造一个通道。
+   * @param capacity 缓冲区大小，0 表示无缓冲（同步交接）。
+   */
+  explicit Channel(size_t capacity = 0) : capacity_(capacity) {}
+
+  // 禁止拷贝和移动（等待者持有通道的地址）
+  Channel(const Channel&) = delete;
+  Channel& operator=(const Channel&) = delete;
+
+  /**
+   * @brief 发送一个值，必要时阻塞。
+   * @return 如果值被发送，返回 true；如果通道已关闭，返回 false。
+   */
+  bool send(T value) {
+    bool ok = false;
+    select(on_send(*this, value, ok));
+    return ok;
+  }
+
+  /**
+   * @brief 尝试发送一个值，不会阻塞。
+   * @param value 要发送的值，只有发送成功时才会被移走。
+   * @return 如果值被发送，返回 true；如果需要等待或通道已关闭，返回 false。
+   */
+  bool try_send(T& value) {
+    bool ok = false;
+    return select_for(std::chrono::nanoseconds::zero(),
+                      on_send(*this, value, ok)) != kSelectTimeout &&
+           ok;
+  }
+
+  /**
+   * @brief 接收一个值，必要时阻塞。
+   * @return 如果收到值，返回 true；如果通道已关闭且为空，返回 false。
+   */
+  bool recv(T& out) {
+    bool ok = false;
+    select(on_recv(*this, out, ok));
+    return ok;
+  }
+
+  /**
+   * @brief 尝试接收一个值，不会阻塞。
+   * @return 如果收到值，返回 true；否则返回 false。
+   */
+  bool try_recv(T& out) {
+    bool ok = false;
+    return select_for(std::chrono::nanoseconds::zero(),
+                      on_recv(*this, out, ok)) != kSelectTimeout &&
+           ok;
+  }
+
+  /**
+   * @brief 关闭通道，唤醒所有阻塞的发送者和接收者。
+   */
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    for (RecvWaiter& waiter : recv_waiters_) {
+      if (waiter.waiter->try_fire(waiter.index)) {
+        set_ok(waiter.ok, false);
+        waiter.waiter->complete();
+      }
+    }
+    for (SendWaiter& waiter : send_waiters_) {
+      if (waiter.waiter->try_fire(waiter.index)) {
+        set_ok(waiter.ok, false);
+        waiter.waiter->complete();
+      }
+    }
+    recv_waiters_.clear();
+    send_waiters_.clear();
+  }
+
+  /**
+   * @brief 通道是否已关闭。
+   */
+  bool is_closed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+  }
+
+  /**
+   * @brief 获取缓冲区中的元素数量。
+   */
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buffer_.size();
+  }
+
+  /**
+   * @brief 获取缓冲区大小。
+   */
+  size_t capacity() const { return capacity_; }
+
+ private:
+  friend class RecvCase<T>;
+  friend class SendCase<T>;
+
+  struct RecvWaiter {
+    detail::ChannelWaiter* waiter;
+    int index;
+    T* out;
+    bool* ok;
+  };
+
+  struct SendWaiter {
+    detail::ChannelWaiter* waiter;
+    int index;
+    T* value;
+    bool* ok;
+  };
+
+  static void set_ok(bool* ok, bool value) {
+    if (ok != nullptr) {
+      *ok = value;
+    }
+  }
+
+  // 以下函数都在持有 mutex_ 的情况下调用，返回分支是否已就绪并完成
+
+  bool try_recv_locked(T& out, bool* ok) {
+    if (!buffer_.empty()) {
+      out = std::move(buffer_.front());
+      buffer_.pop_front();
+      // 缓冲区腾出了位置，接收一个正在等待的发送者的值
+      while (!send_waiters_.empty()) {
+        SendWaiter sender = send_waiters_.front();
+        send_waiters_.pop_front();
+        if (sender.waiter->try_fire(sender.index)) {
+          buffer_.push_back(std::move(*sender.value));
+          set_ok(sender.ok, true);
+          sender.waiter->complete();
+          break;
+        }
+      }
+      set_ok(ok, true);
+      return true;
+    }
+    // 缓冲区为空（或无缓冲通道）：直接从等待的发送者手中取值
+    while (!send_waiters_.empty()) {
+      SendWaiter sender = send_waiters_.front();
+      send_waiters_.pop_front();
+      if (sender.waiter->try_fire(sender.index)) {
+        out = std::move(*sender.value);
+        set_ok(sender.ok, true);
+        sender.waiter->complete();
+        set_ok(ok, true);
+        return true;
+      }
+    }
+    if (closed_) {
+      set_ok(ok, false);
+      return true;
+    }
+    return false;
+  }
+
+  bool try_send_locked(T& value, bool* ok) {
+    if (closed_) {
+      set_ok(ok, false);
+      return true;
+    }
+    // 有接收者在等待：直接交给它
+    while (!recv_waiters_.empty()) {
+      RecvWaiter receiver = recv_waiters_.front();
+      recv_waiters_.pop_front();
+      if (receiver.waiter->try_fire(receiver.index)) {
+        *receiver.out = std::move(value);
+        set_ok(receiver.ok, true);
+        receiver.waiter->complete();
+        set_ok(ok, true);
+        return true;
+      }
+    }
+    if (buffer_.size() < capacity_) {
+      buffer_.push_back(std::move(value));
+      set_ok(ok, true);
+      return true;
+    }
+    return false;
+  }
+
+  // 撤销某个等待者在本通道上的所有登记
+  void dequeue(detail::ChannelWaiter* waiter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    recv_waiters_.erase(
+        std::remove_if(recv_waiters_.begin(), recv_waiters_.end(),
+                       [waiter](const RecvWaiter& w) {
+                         return w.waiter == waiter;
+                       }),
+        recv_waiters_.end());
+    send_waiters_.erase(
+        std::remove_if(send_waiters_.begin(), send_waiters_.end(),
+                       [waiter](const SendWaiter& w) {
+                         return w.waiter == waiter;
+                       }),
+        send_waiters_.end());
+  }
+
+  const size_t capacity_;
+  mutable std::mutex mutex_;
+  std::deque<T> buffer_;
+  std::deque<RecvWaiter> recv_waiters_;
+  std::deque<SendWaiter> send_waiters_;
+  bool closed_ = false;
+};
+
+}  // namespace cppthreadflow
@@ -1,20 +1,60 @@
 ﻿#pragma once
 
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <queue>
 #include <utility>
+
+#include "cancellation.hpp"
 namespace cppthreadflow {
 
+/**
+ * @brief 有界队列已满时，push 的处理方式。
+ */
+enum class OverflowPolicy {
+  kBlock,       // 阻塞生产者，直到有空位（背压）
+  kFailFast,    // 立即拒绝新元素，push 返回 false
+  kDropOldest,  // 丢弃队首最旧的元素，为新元素腾出位置
+  kDropNewest,  // 丢弃新元素，push 返回 false
+};
+
+/**
+ * @brief 有界队列的溢出统计。
+ */
+struct OverflowStats {
+  std::uint64_t rejected = 0;  // kFailFast 拒绝的元素数
+  std::uint64_t dropped = 0;   // kDropOldest/kDropNewest 丢弃的元素数
+  std::uint64_t blocked_pushes = 0;            // 因队列已满而阻塞过的 push 次数
+  std::chrono::nanoseconds blocked_time{0};    // 生产者阻塞的总时长
+};
+
 /**
  * @brief 一个基础的线程安全阻塞队列。
  *
+ * 默认无界；也可以指定容量和溢出策略，在消费者跟不上时对生产者施加背压，
+ * 或按策略丢弃元素，避免内存无限增长。
+ *
  * @tparam T 队列中存储的元素类型。
  */
 template <typename T>
 class ConcurrentQueue {
  public:
+  // 表示无界队列的容量值
+  static constexpr size_t kUnbounded = 0;
+
   ConcurrentQueue() = default;
+
+  /**
+   * @brief 构造一个有界队列。
+   * @param capacity 容量上限，kUnbounded (0) 表示无界。
+   * @param policy 队列已满时 push 的处理方式。
+   */
+  explicit ConcurrentQueue(size_t capacity,
+                           OverflowPolicy policy = OverflowPolicy::kBlock)
+      : capacity_(capacity), policy_(policy) {}
+
   ~ConcurrentQueue() = default;
 
   // 禁止拷贝构造和赋值
@@ -23,14 +63,37 @@ class ConcurrentQueue {
 
   /**
    * @brief 向队列尾部添加一个元素。
+   * 队列已满时按溢出策略处理；无界队列总是成功。
    * @param item 要添加的元素，将通过移动语义传入。
+   * @return 如果元素被放入队列，返回 true；如果因 kFailFast/kDropNewest 被拒绝，
+   * 或在 kBlock 下等待空位时队列被停止，返回 false。
    */
-  void push(T item) {
+  bool push(T item) {
     {
       std::unique_lock<std::mutex> lock(mutex_);
+      if (full()) {
+        switch (policy_) {
+          case OverflowPolicy::kBlock:
+            if (!wait_for_space(lock)) {
+              return false;
+            }
+            break;
+          case OverflowPolicy::kFailFast:
+            ++stats_.rejected;
+            return false;
+          case OverflowPolicy::kDropOldest:
+            queue_.pop();
+            ++stats_.dropped;
+            break;
+          case OverflowPolicy::kDropNewest:
+            ++stats_.dropped;
+            return false;
+        }
+      }
       queue_.push(std::move(item));
     }  // 提前释放锁，再通知，以减少锁的持有时间
     cond_.notify_one();
+    return true;
   }
 
   /**
@@ -51,12 +114,138 @@ class ConcurrentQueue {
 
     item = std::move(queue_.front());
     queue_.pop();
+    notify_space();
+    return true;
+  }
+
+  /**
+   * @brief 从队列头部弹出一个元素，等待期间可以被取消。
+   * 令牌被取消或到达其截止时间时，等待立即结束。
+   * @param item 用于接收弹出元素的引用。
+   * @param token 取消令牌。
+   * @return 如果成功弹出一个元素，返回 true；如果被取消，或队列被停止且为空，返回 false。
+   */
+  bool pop(T& item, const CancellationToken& token) {
+    // 先注册唤醒回调再加锁：已取消时回调会立即执行并获取同一把锁
+    CancellationRegistration registration =
+        detail::notify_on_cancel(token, mutex_, cond_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!detail::wait_unless_cancelled(
+            lock, cond_, token, [this] { return !queue_.empty() || stop_; }) ||
+        queue_.empty()) {
+      return false;  // 被取消，或队列被停止且为空
+    }
+    item = std::move(queue_.front());
+    queue_.pop();
+    notify_space();
+    return true;
+  }
+
+  /**
+   * @brief 尝试从队列头部弹出一个元素，不会阻塞。
+   * @param item 用于接收弹出元素的引用。
+   * @return 如果成功弹出一个元素，返回 true；如果队列为空，返回 false。
+   */
+  bool try_pop(T& item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (queue_.empty()) {
+      return false;
+    }
+    item = std::move(queue_.front());
+    queue_.pop();
+    notify_space();
+    return true;
+  }
+
+  /**
+   * @brief 从队列头部弹出一个元素，最多等待 timeout。
+   * @param item 用于接收弹出元素的引用。
+   * @param timeout 最长等待时间。
+   * @return 如果成功弹出一个元素，返回 true；如果超时，或队列被停止且为空，返回 false。
+   */
+  template <typename Rep, typename Period>
+  bool pop_for(T& item, const std::chrono::duration<Rep, Period>& timeout) {
+    return pop_until(item, std::chrono::steady_clock::now() + timeout);
+  }
+
+  /**
+   * @brief 从队列头部弹出一个元素，最多等待到 deadline。
+   * @param item 用于接收弹出元素的引用。
+   * @param deadline 等待的截止时间点。
+   * @return 如果成功弹出一个元素，返回 true；如果超时，或队列被停止且为空，返回 false。
+   */
+  template <typename Clock, typename Duration>
+  bool pop_until(T& item,
+                 const std::chrono::time_point<Clock, Duration>& deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!cond_.wait_until(lock, deadline,
+                          [this] { return !queue_.empty() || stop_; })) {
+      return false;  // 超时
+    }
+    if (queue_.empty()) {
+      return false;  // 队列被停止且为空
+    }
+    item = std::move(queue_.front());
+    queue_.pop();
+    notify_space();
     return true;
   }
 
+  /**
+   * @brief 一次性取出队列中的所有元素，不会阻塞。
+   *
+   * 只加一次锁，并通过交换内部缓冲区完成，不逐个移动元素，
+   * 适合一个消费者轮询多个队列、批量处理的场景。
+   * @return 取出的所有元素，按入队顺序排列；队列为空时返回空队列。
+   */
+  std::queue<T> pop_all() {
+    std::queue<T> items;
+    std::unique_lock<std::mutex> lock(mutex_);
+    items.swap(queue_);
+    if (blocked_producers_ > 0) {
+      not_full_.notify_all();
+    }
+    return items;
+  }
+
+  /**
+   * @brief 获取队列中当前的元素数量。
+   */
+  size_t size() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return queue_.size();
+  }
+
+  /**
+   * @brief 检查队列是否为空。
+   */
+  bool empty() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return queue_.empty();
+  }
+
+  /**
+   * @brief 获取容量上限，kUnbounded (0) 表示无界。
+   */
+  size_t capacity() const { return capacity_; }
+
+  /**
+   * @brief 获取溢出策略。
+   */
+  OverflowPolicy overflow_policy() const { return policy_; }
+
+  /**
+   * @brief 获取溢出统计。
+   */
+  OverflowStats overflow_stats() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
   /**
    * @brief 停止队列。
-   * 这将唤醒所有因等待元素而阻塞的线程。一旦队列被停止，pop操作将在队列为空时立即返回false。
+   * 这将唤醒所有因等待元素或空位而阻塞的线程。一旦队列被停止，pop操作将在队列为空时立即返回false，
+   * 阻塞在 push 上的生产者返回 false。
    */
   void stop() {
     {
@@ -64,13 +253,43 @@ class ConcurrentQueue {
       stop_ = true;
     }
     cond_.notify_all();
+    not_full_.notify_all();
   }
 
  private:
+  // 在持有锁的情况下调用
+  bool full() const {
+    return capacity_ != kUnbounded && queue_.size() >= capacity_;
+  }
+
+  // 在持有锁的情况下等待空位；队列被停止时返回 false
+  bool wait_for_space(std::unique_lock<std::mutex>& lock) {
+    const auto start = std::chrono::steady_clock::now();
+    ++blocked_producers_;
+    not_full_.wait(lock, [this] { return !full() || stop_; });
+    --blocked_producers_;
+    ++stats_.blocked_pushes;
+    stats_.blocked_time += std::chrono::steady_clock::now() - start;
+    return !stop_;
+  }
+
+  // 在持有锁的情况下，弹出一个元素后唤醒一个等待空位的生产者
+  void notify_space() {
+    if (blocked_producers_ > 0) {
+      not_full_.notify_one();
+    }
+  }
+
   std::queue<T> queue_;
-  std::mutex mutex_;
+  mutable std::mutex mutex_;
   std::condition_variable cond_;
+  std::condition_variable not_full_;
   bool stop_ = false;
+
+  const size_t capacity_ = kUnbounded;
+  const OverflowPolicy policy_ = OverflowPolicy::kBlock;
+  size_t blocked_producers_ = 0;
+  OverflowStats stats_;
 };
 
 }  // namespace cppthreadflow
\ No newline at end of file
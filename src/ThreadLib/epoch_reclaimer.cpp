@@ -0,0 +1,258 @@
+﻿#include "epoch_reclaimer.hpp"
+
+namespace cppthreadflow {
+
+namespace detail {
+
+struct EpochThreadRecord {
+  // 高位为线程观察到的纪元，最低位表示是否处于临界区。
+  // 独占一条缓存行，避免不同线程进出临界区时相互干扰。
+  alignas(64) std::atomic<std::uint64_t> state{0};
+  std::atomic<bool> in_use{false};
+  // 链表指针在记录发布后不再修改
+  EpochThreadRecord* next = nullptr;
+
+  // 以下字段只由拥有该记录的线程访问
+  unsigned nesting = 0;
+  std::size_t retired_since_scan = 0;
+  std::deque<EpochReclaimer::RetiredNode> retired;
+};
+
+}  // namespace detail
+
+namespace {
+
+// 线程退出时自动注销，把剩余节点交给孤儿列表
+struct LocalHandle {
+  detail::EpochThreadRecord* record = nullptr;
+  ~LocalHandle() {
+    if (record != nullptr) {
+      EpochReclaimer::instance().unregister_thread();
+    }
+  }
+};
+
+thread_local LocalHandle t_local;
+
+}  // namespace
+
+EpochReclaimer& EpochReclaimer::instance() {
+  static EpochReclaimer reclaimer;
+  return reclaimer;
+}
+
+EpochReclaimer::~EpochReclaimer() {
+  // 进程退出时不再有并发访问，释放所有剩余节点和线程记录
+  detail::EpochThreadRecord* record = records_.load();
+  while (record != nullptr) {
+    for (RetiredNode& node : record->retired) {
+      node.deleter(node.ptr);
+    }
+    detail::EpochThreadRecord* next = record->next;
+    delete record;
+    record = next;
+  }
+  for (RetiredNode& node : orphans_) {
+    node.deleter(node.ptr);
+  }
+}
+
+void EpochReclaimer::register_thread() { local_record(); }
+
+void EpochReclaimer::unregister_thread() {
+  detail::EpochThreadRecord* record = t_local.record;
+  if (record == nullptr) {
+    return;
+  }
+  // 先尽力回收一次，剩下的移交到孤儿列表
+  try_advance();
+  reclaim(record->retired);
+  if (!record->retired.empty()) {
+    std::lock_guard<std::mutex> lock(orphans_mutex_);
+    for (RetiredNode& node : record->retired) {
+      orphans_.push_back(node);
+    }
+  }
+  record->retired.clear();
+  record->retired_since_scan = 0;
+  record->nesting = 0;
+  record->state.store(0, std::memory_order_release);
+  record->in_use.store(false, std::memory_order_release);
+  registered_.fetch_sub(1, std::memory_order_relaxed);
+  t_local.record = nullptr;
+}
+
+void EpochReclaimer::enter() {
+  detail::EpochThreadRecord* record = local_record();
+  if (record->nesting++ > 0) {
+    return;  // 嵌套进入，外层已经宣告过纪元
+  }
+  std::uint64_t epoch = global_epoch_.load(std::memory_order_relaxed);
+  while (true) {
+    // 宣告与随后的重读都使用 seq_cst，与 try_advance() 构成全序：
+    // 推进纪元的线程要么看到本次宣告，要么本线程重读到新纪元
+    record->state.store((epoch << 1) | 1, std::memory_order_seq_cst);
+    const std::uint64_t current =
+        global_epoch_.load(std::memory_order_seq_cst);
+    if (current == epoch) {
+      break;
+    }
+    epoch = current;
+  }
+}
+
+void EpochReclaimer::leave() {
+  detail::EpochThreadRecord* record = t_local.record;
+  if (record == nullptr || record->nesting == 0) {
+    return;
+  }
+  if (--record->nesting == 0) {
+    record->state.store(0, std::memory_order_release);
+  }
+}
+
+bool EpochReclaimer::in_critical_section() const {
+  const detail::EpochThreadRecord* record = t_local.record;
+  return record != nullptr && record->nesting > 0;
+}
+
+void EpochReclaimer::retire(void* ptr, Deleter deleter) {
+  detail::EpochThreadRecord* record = local_record();
+  record->retired.push_back(
+      {ptr, deleter, global_epoch_.load(std::memory_order_acquire)});
+  pending_.fetch_add(1, std::memory_order_relaxed);
+
+  // 均摊扫描：每退休 kScanThreshold 个节点才尝试一次
+  if (++record->retired_since_scan >= kScanThreshold) {
+    record->retired_since_scan = 0;
+    try_advance();
+    reclaim(record->retired);
+    reclaim_orphans(false);
+  }
+}
+
+bool EpochReclaimer::try_advance() {
+  std::uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+
+  for (detail::EpochThreadRecord* record =
+           records_.load(std::memory_order_acquire);
+       record != nullptr; record = record->next) {
+    const std::uint64_t state = record->state.load(std::memory_order_seq_cst);
+    // 有线程仍停留在旧纪元的临界区内，不能推进
+    if ((state & 1) != 0 && (state >> 1) != epoch) {
+      return false;
+    }
+  }
+
+  return global_epoch_.compare_exchange_strong(epoch, epoch + 1,
+                                               std::memory_order_seq_cst);
+}
+
+std::size_t EpochReclaimer::collect() {
+  try_advance();
+  std::size_t freed = 0;
+  if (detail::EpochThreadRecord* record = t_local.record) {
+    freed += reclaim(record->retired);
+  }
+  freed += reclaim_orphans(true);
+  return freed;
+}
+
+std::uint64_t EpochReclaimer::epoch() const {
+  return global_epoch_.load(std::memory_order_acquire);
+}
+
+std::size_t EpochReclaimer::pending_count() const {
+  return pending_.load(std::memory_order_relaxed);
+}
+
+std::size_t EpochReclaimer::registered_threads() const {
+  return registered_.load(std::memory_order_relaxed);
+}
+
+detail::EpochThreadRecord* EpochReclaimer::local_record() {
+  if (t_local.record == nullptr) {
+    t_local.record = acquire_record();
+    registered_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return t_local.record;
+}
+
+detail::EpochThreadRecord* EpochReclaimer::acquire_record() {
+  // 1. 优先复用已退出线程留下的记录
+  for (detail::EpochThreadRecord* record =
+           records_.load(std::memory_order_acquire);
+       record != nullptr; record = record->next) {
+    bool expected = false;
+    if (!record->in_use.load(std::memory_order_relaxed) &&
+        record->in_use.compare_exchange_strong(expected, true,
+                                               std::memory_order_acq_rel)) {
+      return record;
+    }
+  }
+
+  // 2. 没有可复用的记录，新建一个并插入链表头部
+  auto* record = new detail::EpochThreadRecord();
+  record->in_use.store(true, std::memory_order_relaxed);
+  detail::EpochThreadRecord* head = records_.load(std::memory_order_relaxed);
+  do {
+    record->next = head;
+  } while (!records_.compare_exchange_weak(head, record,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+  return record;
+}
+
+std::size_t EpochReclaimer::reclaim(std::deque<RetiredNode>& retired) {
+  const std::uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+  std::size_t freed = 0;
+  // 列表按退休纪元递增排列，只需从头部开始释放
+  while (!retired.empty() && retired.front().epoch + 2 <= epoch) {
+    RetiredNode node = retired.front();
+    retired.pop_front();
+    node.deleter(node.ptr);
+    ++freed;
+  }
+  pending_.fetch_sub(freed, std::memory_order_relaxed);
+  return freed;
+}
+
+std::size_t EpochReclaimer::reclaim_orphans(bool blocking) {
+  std::unique_lock<std::mutex> lock(orphans_mutex_, std::defer_lock);
+  if (blocking) {
+    lock.lock();
+  } else if (!lock.try_lock()) {
+    return 0;  // 其他线程正在处理孤儿列表，本次跳过
+  }
+  if (orphans_.empty()) {
+    return 0;
+  }
+  // 在锁外执行释放函数，避免其中再次退休节点时发生重入
+  std::deque<RetiredNode> orphans;
+  orphans.swap(orphans_);
+  lock.unlock();
+
+  // 孤儿列表来自多个线程，纪元不保证有序，需要完整扫描
+  const std::uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+  std::deque<RetiredNode> survivors;
+  std::size_t freed = 0;
+  for (RetiredNode& node : orphans) {
+    if (node.epoch + 2 <= epoch) {
+      node.deleter(node.ptr);
+      ++freed;
+    } else {
+      survivors.push_back(node);
+    }
+  }
+  pending_.fetch_sub(freed, std::memory_order_relaxed);
+
+  if (!survivors.empty()) {
+    lock.lock();
+    for (RetiredNode& node : survivors) {
+      orphans_.push_back(node);
+    }
+  }
+  return freed;
+}
+
+}  // namespace cppthreadflow
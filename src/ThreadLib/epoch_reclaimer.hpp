@@ -0,0 +1,169 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace cppthreadflow {
+
+namespace detail {
+// 每个线程在回收域中的登记记录，定义见 epoch_reclaimer.cpp
+struct EpochThreadRecord;
+}  // namespace detail
+
+/**
+ * @brief 基于纪元 (Epoch-Based Reclamation, EBR) 的安全内存回收器。
+ *
+ * 无锁数据结构在摘除节点后不能立即释放它，因为其他线程可能仍持有该节点的指针。
+ * 本回收器的使用方式是：
+ *  1. 线程在访问共享结构前进入临界区（推荐使用 EpochGuard）；
+ *  2. 节点被摘除后调用 retire()，放入当前线程的退休列表；
+ *  3. 当全局纪元相对退休时推进了两次以上，说明所有可能看到该节点的临界区
+ *     都已结束，此时节点才会被真正释放。
+ *
+ * 退休列表是每个线程私有的，每退休 kScanThreshold 个节点才尝试推进纪元并扫描一次，
+ * 从而将回收开销均摊到各次 retire() 上。
+ * 线程在首次使用时会被自动登记；ThreadPool 的工作线程在启动时即完成登记。
+ * 线程退出时，其尚未回收的节点会被移交给全局的孤儿列表，由其他线程继续回收。
+ */
+class EpochReclaimer {
+ public:
+  using Deleter = void (*)(void*);
+
+  // 每退休多少个节点尝试一次纪元推进和扫描
+  static constexpr std::size_t kScanThreshold = 64;
+
+  /**
+   * @brief 获取进程内唯一的回收域。
+   */
+  static EpochReclaimer& instance();
+
+  // 回收域是全局唯一的资源，禁止拷贝和移动
+  EpochReclaimer(const EpochReclaimer&) = delete;
+  EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+  EpochReclaimer(EpochReclaimer&&) = delete;
+  EpochReclaimer& operator=(EpochReclaimer&&) = delete;
+
+  /**
+   * @brief 将当前线程登记到回收域。重复调用无副作用。
+   */
+  void register_thread();
+
+  /**
+   * @brief 注销当前线程。未回收的节点会被移交到孤儿列表。
+   * 线程退出时会自动调用，通常无需手动调用。
+   */
+  void unregister_thread();
+
+  /**
+   * @brief 进入临界区（可嵌套）。在临界区内读到的节点不会被释放。
+   */
+  void enter();
+
+  /**
+   * @brief 离开临界区。必须与 enter() 成对调用。
+   */
+  void leave();
+
+  /**
+   * @brief 当前线程是否处于临界区内。
+   */
+  bool in_critical_section() const;
+
+  /**
+   * @brief 退休一个已从共享结构中摘除的节点，待安全时调用 deleter 释放。
+   * @param ptr 要释放的指针。
+   * @param deleter 释放函数。
+   */
+  void retire(void* ptr, Deleter deleter);
+
+  /**
+   * @brief 退休一个通过 new 分配的对象，安全时使用 delete 释放。
+   */
+  template <typename T>
+  void retire(T* ptr) {
+    retire(static_cast<void*>(ptr),
+           [](void* p) { delete static_cast<T*>(p); });
+  }
+
+  /**
+   * @brief 尝试推进全局纪元。
+   * @return 如果所有处于临界区的线程都已观察到当前纪元并推进成功，返回 true。
+   */
+  bool try_advance();
+
+  /**
+   * @brief 尝试推进纪元，并回收当前线程及孤儿列表中已安全的节点。
+   * @return 本次释放的节点数量。
+   */
+  std::size_t collect();
+
+  /**
+   * @brief 获取当前的全局纪元。
+   */
+  std::uint64_t epoch() const;
+
+  /**
+   * @brief 获取已退休但尚未释放的节点总数（估算值）。
+   */
+  std::size_t pending_count() const;
+
+  /**
+   * @brief 获取当前登记在回收域中的线程数量（估算值）。
+   */
+  std::size_t registered_threads() const;
+
+ private:
+  struct RetiredNode {
+    void* ptr;
+    Deleter deleter;
+    std::uint64_t epoch;  // 退休时的全局纪元
+  };
+
+  EpochReclaimer() = default;
+  ~EpochReclaimer();
+
+  // 获取当前线程的记录，如未登记则自动登记
+  detail::EpochThreadRecord* local_record();
+  detail::EpochThreadRecord* acquire_record();
+
+  // 释放线程退休列表头部所有已安全的节点，返回释放数量
+  std::size_t reclaim(std::deque<RetiredNode>& retired);
+  // 释放孤儿列表中已安全的节点；非阻塞模式下抢不到锁则直接返回
+  std::size_t reclaim_orphans(bool blocking);
+
+  friend struct detail::EpochThreadRecord;
+
+  std::atomic<std::uint64_t> global_epoch_{0};
+  // 线程记录组成的单向链表，只增不减，记录在线程退出后被复用
+  std::atomic<detail::EpochThreadRecord*> records_{nullptr};
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<std::size_t> registered_{0};
+
+  std::mutex orphans_mutex_;
+  std::deque<RetiredNode> orphans_;
+};
+
+/**
+ * @brief EBR 临界区的 RAII 守卫。
+ *
+ * 在守卫的生命周期内，当前线程读取到的节点不会被回收器释放。
+ */
+class EpochGuard {
+ public:
+  EpochGuard() : reclaimer_(EpochReclaimer::instance()) { reclaimer_.enter(); }
+  ~EpochGuard() { reclaimer_.leave(); }
+
+  // 守卫绑定在当前线程上，禁止拷贝和移动
+  EpochGuard(const EpochGuard&) = delete;
+  EpochGuard& operator=(const EpochGuard&) = delete;
+  EpochGuard(EpochGuard&&) = delete;
+  EpochGuard& operator=(EpochGuard&&) = delete;
+
+ private:
+  EpochReclaimer& reclaimer_;
+};
+
+}  // namespace cppthreadflow
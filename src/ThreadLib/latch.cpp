@@ -42,4 +42,13 @@ void Latch::wait() const {
   cv_.wait(lock, [this] { return count_ == 0; });
 }
 
+bool Latch::wait(const CancellationToken& token) const {
+  // 先注册唤醒回调再加锁：已取消时回调会立即执行并获取同一把锁
+  CancellationRegistration registration =
+      detail::notify_on_cancel(token, mutex_, cv_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  return detail::wait_unless_cancelled(lock, cv_, token,
+                                       [this] { return count_ == 0; });
+}
+
 } // namespace cppthreadflow
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <condition_variable>
 #include <mutex>
 
+#include "cancellation.hpp"
+
 namespace cppthreadflow {
 
 /**
@@ -41,6 +43,13 @@ class Latch {
    */
   void wait() const;
 
+  /**
+   * @brief 阻塞当前线程，直到计数器达到 0，等待期间可以被取消。
+   * @param token 取消令牌；被取消或到达其截止时间时立即停止等待。
+   * @return 如果门闩已打开，返回 true；如果被取消，返回 false。
+   */
+  bool wait(const CancellationToken& token) const;
+
  private:
   int count_;
   // 关键：mutex 和 cv 必须是 mutable，
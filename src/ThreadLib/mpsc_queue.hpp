@@ -0,0 +1,206 @@
+﻿#pragma once
+
+#include <atomic>
+#include <thread>
+#include <utility>
+
+#include "cache_line.hpp"
+#include "event_count.hpp"
+
+namespace cppthreadflow {
+
+/**
+ * @brief 侵入式 MPSC 队列的节点基类，需要入队的对象继承它即可。
+ */
+struct MpscNode {
+  std::atomic<MpscNode*> mpsc_next{nullptr};
+};
+
+/**
+ * @brief 侵入式的多生产者/单消费者 (MPSC) 无界队列（Dmitry Vyukov 算法）。
+ *
+ * push 只有一次原子交换，不会失败也不会重试（无等待）；try_pop 只由消费者调用，
+ * 不需要任何原子读-改-写。队列不分配内存，节点的所有权由调用者管理。
+ *
+ * 当某个生产者已经交换了 head_、但还没有链接前驱节点时，
+ * try_pop 可能暂时返回 nullptr，即使队列中还有其他节点；该生产者完成后即可取出。
+ */
+class IntrusiveMpscQueue {
+ public:
+  IntrusiveMpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+  // 禁止拷贝和移动（stub_ 的地址被队列内部引用）
+  IntrusiveMpscQueue(const IntrusiveMpscQueue&) = delete;
+  IntrusiveMpscQueue& operator=(const IntrusiveMpscQueue&) = delete;
+
+  /**
+   * @brief 入队一个节点（任意线程）。
+   */
+  void push(MpscNode* node) {
+    node->mpsc_next.store(nullptr, std::memory_order_relaxed);
+    MpscNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+    // seq_cst：与 EventCount 的等待协议配合，见 event_count.hpp
+    prev->mpsc_next.store(node, std::memory_order_seq_cst);
+  }
+
+  /**
+   * @brief 出队一个节点（仅限消费者线程）。
+   * @return 出队的节点；队列为空（或生产者尚未完成链接）时返回 nullptr。
+   */
+  MpscNode* try_pop() {
+    MpscNode* tail = tail_;
+    MpscNode* next = tail->mpsc_next.load(std::memory_order_seq_cst);
+    if (tail == &stub_) {
+      if (next == nullptr) {
+        return nullptr;
+      }
+      // 跳过哨兵节点
+      tail_ = next;
+      tail = next;
+      next = next->mpsc_next.load(std::memory_order_seq_cst);
+    }
+    if (next != nullptr) {
+      tail_ = next;
+      return tail;
+    }
+    // tail 是最后一个已链接的节点
+    if (tail != head_.load(std::memory_order_seq_cst)) {
+      // 有生产者正在链接新节点
+      return nullptr;
+    }
+    // 把哨兵重新放回队尾，才能在不留下空链表的情况下取出 tail
+    push(&stub_);
+    next = tail->mpsc_next.load(std::memory_order_seq_cst);
+    if (next != nullptr) {
+      tail_ = next;
+      return tail;
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief 队列是否确实为空（仅限消费者线程）。
+   * try_pop 返回 nullptr 而这里返回 false，说明某个生产者尚未完成链接，稍后即可取出。
+   */
+  bool empty() const {
+    // 队尾是哨兵且其后没有任何生产者交换过 head_ 时，队列中没有节点
+    return tail_ == &stub_ && head_.load(std::memory_order_seq_cst) == &stub_;
+  }
+
+ private:
+  // 生产者共享
+  alignas(kCacheLineSize) std::atomic<MpscNode*> head_;
+  // 消费者独占
+  alignas(kCacheLineSize) MpscNode* tail_;
+  MpscNode stub_;
+};
+
+/**
+ * @brief 一个无界的多生产者/单消费者 (MPSC) 队列，适合日志、聚合等多对一的场景。
+ *
+ * 基于 IntrusiveMpscQueue，每个元素包装在一个堆分配的节点中。
+ * push/pop/stop 的语义与 ConcurrentQueue 一致，可直接替换：
+ * pop 在队列为空时阻塞，stop 之后 pop 仍会取完剩余元素，然后返回 false。
+ *
+ * push 可以被任意多个线程同时调用；同一时刻只能有一个线程调用 pop/try_pop。
+ *
+ * @tparam T 队列中存储的元素类型。
+ */
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() = default;
+
+  ~MpscQueue() {
+    while (MpscNode* node = queue_.try_pop()) {
+      delete static_cast<Node*>(node);
+    }
+  }
+
+  // 禁止拷贝和移动
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  /**
+   * @brief 向队列尾部添加一个元素（任意线程）。
+   * @param item 要添加的元素，将通过移动语义传入。
+   */
+  void push(T item) {
+    queue_.push(new Node(std::move(item)));
+    not_empty_.notify();
+  }
+
+  /**
+   * @brief 尝试从队列头部弹出一个元素（仅限消费者线程）。
+   * @return 如果队列为空，返回 false。
+   */
+  bool try_pop(T& item) {
+    MpscNode* node = queue_.try_pop();
+    if (node == nullptr) {
+      return false;
+    }
+    Node* typed = static_cast<Node*>(node);
+    item = std::move(typed->value);
+    delete typed;
+    return true;
+  }
+
+  /**
+   * @brief 从队列头部弹出一个元素，队列为空时阻塞（仅限消费者线程）。
+   * @return 如果成功弹出返回 true；如果队列被停止且为空，返回 false。
+   */
+  bool pop(T& item) {
+    while (!try_pop(item)) {
+      if (stop_.load(std::memory_order_seq_cst)) {
+        // stop 之前入队的元素仍然要取完：try_pop 取不到也可能只是某个生产者尚未完成链接，
+        // 它之后的元素（可能在 stop 之前就已入队）要等它链接后才能取出
+        while (!try_pop(item)) {
+          if (queue_.empty()) {
+            return false;
+          }
+          std::this_thread::yield();
+        }
+        return true;
+      }
+      for (int i = 0; i < kSpinCount; ++i) {
+        if (try_pop(item)) {
+          return true;
+        }
+      }
+      const EventCount::Key key = not_empty_.prepare_wait();
+      if (try_pop(item)) {
+        not_empty_.cancel_wait();
+        return true;
+      }
+      if (stop_.load(std::memory_order_seq_cst)) {
+        not_empty_.cancel_wait();
+        continue;
+      }
+      not_empty_.wait(key);
+    }
+    return true;
+  }
+
+  /**
+   * @brief 停止队列，唤醒阻塞在 pop 上的消费者。
+   */
+  void stop() {
+    stop_.store(true, std::memory_order_seq_cst);
+    not_empty_.notify_all();
+  }
+
+ private:
+  struct Node : MpscNode {
+    explicit Node(T v) : value(std::move(v)) {}
+    T value;
+  };
+
+  // 阻塞前先自旋重试的次数
+  static constexpr int kSpinCount = 64;
+
+  IntrusiveMpscQueue queue_;
+  std::atomic<bool> stop_{false};
+  EventCount not_empty_;
+};
+
+}  // namespace cppthreadflow
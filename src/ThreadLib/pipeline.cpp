@@ -0,0 +1,233 @@
+﻿#include "pipeline.hpp"
+#include "thread_pool.hpp" // 需要 ThreadPool 的完整定义
+
+#include <limits>
+#include <stdexcept>
+
+namespace cppthreadflow {
+
+Pipeline::Pipeline(ThreadPool& pool, const PipelineOptions& options)
+    : pool_(pool),
+      max_tokens_(options.max_tokens == 0 ? 1 : options.max_tokens),
+      batch_size_(options.batch_size == 0 ? 1 : options.batch_size) {
+    // 被丢弃的任务在队列锁内析构，无法在那里安全地结束令牌（结束时可能还要提交后续令牌）
+    const OverflowPolicy policy = pool.overflow_policy();
+    if (policy == OverflowPolicy::kDropOldest || policy == OverflowPolicy::kDropNewest) {
+        throw std::invalid_argument("Pipeline requires a ThreadPool with kBlock or kFailFast overflow policy");
+    }
+}
+
+Pipeline& Pipeline::source(Source source) {
+    source_ = std::move(source);
+    return *this;
+}
+
+Pipeline& Pipeline::stage(StageMode mode, StageFunction function, size_t parallelism) {
+    auto stage = std::make_unique<Stage>();
+    stage->mode = mode;
+    stage->function = std::move(function);
+    if (mode != StageMode::kParallel) {
+        stage->max_active = 1;
+    } else {
+        stage->max_active = parallelism == 0 ? std::numeric_limits<size_t>::max() : parallelism;
+    }
+    stages_.push_back(std::move(stage));
+    return *this;
+}
+
+size_t Pipeline::run() {
+    if (!source_) {
+        throw std::logic_error("Pipeline::run called without a source");
+    }
+    // 重置上一次运行的状态
+    in_flight_ = 0;
+    error_ = nullptr;
+    failed_.store(false);
+    for (auto& stage : stages_) {
+        stage->next_sequence = 0;
+    }
+
+    std::uint64_t sequence = 0;
+    size_t produced = 0;
+    bool exhausted = false;
+    while (!exhausted) {
+        // 1. 等待一个空闲令牌；令牌数限制了流水线中的元素总数
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return in_flight_ < max_tokens_ || failed_.load(); });
+            if (failed_.load()) {
+                break;
+            }
+            ++in_flight_;
+        }
+
+        // 2. 从源中取出最多 batch_size 个元素
+        Token token{sequence, {}};
+        token.items.reserve(batch_size_);
+        try {
+            while (token.items.size() < batch_size_) {
+                std::any item;
+                if (!source_(item)) {
+                    exhausted = true;
+                    break;
+                }
+                token.items.push_back(std::move(item));
+            }
+        } catch (...) {
+            record_error(std::current_exception());
+            exhausted = true;
+        }
+
+        if (token.items.empty()) {
+            // 没有产生任何元素，归还令牌（序号也不消耗，保持连续）
+            finish_token();
+            break;
+        }
+        produced += token.items.size();
+        ++sequence;
+        try {
+            enqueue(0, std::move(token));
+        } catch (...) {
+            // 提交失败已在 submit_tokens 中处理，这里只可能是内存不足等异常；
+            // 已经在流动的令牌仍持有 this，必须等它们走完后才能离开
+            record_error(std::current_exception());
+            break;
+        }
+    }
+
+    // 3. 等待所有令牌走完全部阶段
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return in_flight_ == 0; });
+    }
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    return produced;
+}
+
+void Pipeline::enqueue(size_t index, Token token) {
+    if (index == stages_.size()) {
+        finish_token();
+        return;
+    }
+    Stage& stage = *stages_[index];
+    std::vector<std::shared_ptr<Token>> ready;
+    {
+        std::unique_lock<std::mutex> lock(stage.mutex);
+        if (stage.mode == StageMode::kSerialInOrder) {
+            const std::uint64_t sequence = token.sequence;
+            stage.reorder.emplace(sequence, std::move(token));
+        } else {
+            stage.queue.push_back(std::move(token));
+        }
+        ready = take_ready_locked(stage);
+    }
+    submit_tokens(index, std::move(ready));
+}
+
+std::vector<std::shared_ptr<Pipeline::Token>> Pipeline::take_ready_locked(Stage& stage) {
+    std::vector<std::shared_ptr<Token>> ready;
+    while (stage.active < stage.max_active) {
+        if (stage.mode == StageMode::kSerialInOrder) {
+            // 只有轮到的序号才能开始处理，其余令牌留在重排缓冲中。
+            // 出错后元素都被丢弃，顺序不再重要；被丢弃的令牌会留下序号空洞，不能再等待
+            auto it = stage.reorder.begin();
+            if (it == stage.reorder.end() ||
+                (it->first != stage.next_sequence && !failed_.load())) {
+                break;
+            }
+            ready.push_back(std::make_shared<Token>(std::move(it->second)));
+            stage.reorder.erase(it);
+        } else {
+            if (stage.queue.empty()) {
+                break;
+            }
+            ready.push_back(std::make_shared<Token>(std::move(stage.queue.front())));
+            stage.queue.pop_front();
+        }
+        ++stage.active;
+    }
+    return ready;
+}
+
+void Pipeline::submit_tokens(size_t index, std::vector<std::shared_ptr<Token>> tokens) {
+    // 在锁外提交：有界线程池的 submit 可能阻塞，而工作线程需要阶段锁才能前进
+    Stage& stage = *stages_[index];
+    size_t dropped = 0;
+    while (!tokens.empty()) {
+        std::vector<std::shared_ptr<Token>> retry;
+        for (auto& token : tokens) {
+            try {
+                pool_.submit([this, index, token]() { process(index, std::move(*token)); });
+            } catch (...) {
+                // 线程池拒绝了提交（已满、准入控制拒绝或已停止）：记录错误并丢弃这个令牌。
+                // 归还阶段的执行位置后，可能又有令牌可以开始，它们同样需要提交
+                record_error(std::current_exception());
+                std::unique_lock<std::mutex> lock(stage.mutex);
+                --stage.active;
+                auto ready = take_ready_locked(stage);
+                retry.insert(retry.end(), ready.begin(), ready.end());
+                ++dropped;
+            }
+        }
+        tokens.swap(retry);
+    }
+    // 最后才归还令牌：in_flight_ 归零后 run() 可能立即返回并销毁流水线
+    for (size_t i = 0; i < dropped; ++i) {
+        finish_token();
+    }
+}
+
+void Pipeline::process(size_t index, Token token) {
+    Stage& stage = *stages_[index];
+    if (failed_.load()) {
+        // 已经出错：丢弃元素，令牌仍需走完剩余阶段以推进序号
+        token.items.clear();
+    } else {
+        try {
+            std::vector<std::any> outputs;
+            outputs.reserve(token.items.size());
+            for (std::any& item : token.items) {
+                std::any output = stage.function(std::move(item));
+                if (output.has_value()) {
+                    outputs.push_back(std::move(output));
+                }
+            }
+            token.items.swap(outputs);
+        } catch (...) {
+            record_error(std::current_exception());
+            token.items.clear();
+        }
+    }
+
+    std::vector<std::shared_ptr<Token>> ready;
+    {
+        std::unique_lock<std::mutex> lock(stage.mutex);
+        --stage.active;
+        if (stage.mode == StageMode::kSerialInOrder) {
+            ++stage.next_sequence;
+        }
+        ready = take_ready_locked(stage);
+    }
+    submit_tokens(index, std::move(ready));
+    enqueue(index + 1, std::move(token));
+}
+
+void Pipeline::finish_token() {
+    // 在锁内通知：run() 返回后流水线可能立即被销毁
+    std::unique_lock<std::mutex> lock(mutex_);
+    --in_flight_;
+    cv_.notify_all();
+}
+
+void Pipeline::record_error(std::exception_ptr error) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!error_) {
+        error_ = error;
+    }
+    failed_.store(true);
+    cv_.notify_all();
+}
+
+} // namespace cppthreadflow
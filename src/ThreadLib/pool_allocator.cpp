@@ -0,0 +1,249 @@
+﻿#include "pool_allocator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace cppthreadflow {
+
+namespace {
+
+// 块大小至少能放下空闲链表指针，并按最大基本对齐向上取整
+std::size_t round_block_size(std::size_t size) {
+  constexpr std::size_t kAlign = alignof(std::max_align_t);
+  size = std::max(size, sizeof(void*));
+  return (size + kAlign - 1) / kAlign * kAlign;
+}
+
+// 池编号索引各线程的缓存表，池析构后编号被复用，缓存表的长度因此只随同时存在的池数增长。
+// 有意泄漏：静态存储期的池可能在本文件的静态对象析构之后才析构
+struct PoolIdRegistry {
+  std::mutex mutex;
+  std::vector<std::size_t> free_ids;
+  std::size_t next_id = 0;
+};
+
+PoolIdRegistry& pool_id_registry() {
+  static PoolIdRegistry* const registry = new PoolIdRegistry;
+  return *registry;
+}
+
+std::size_t acquire_pool_id() {
+  PoolIdRegistry& registry = pool_id_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  if (registry.free_ids.empty()) {
+    return registry.next_id++;
+  }
+  std::size_t id = registry.free_ids.back();
+  registry.free_ids.pop_back();
+  return id;
+}
+
+void release_pool_id(std::size_t id) {
+  PoolIdRegistry& registry = pool_id_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.free_ids.push_back(id);
+}
+
+// 编号会被复用，序号不会：缓存槽据此识别它属于已析构的旧池。从 1 开始，0 表示槽未绑定
+std::atomic<std::uint64_t> next_pool_serial{1};
+
+// 线程退出时，其他 thread_local（例如 EpochReclaimer 的线程状态）析构过程中
+// 仍可能释放块；缓存表销毁后改为直接操作共享链表。平凡析构的标志不受析构顺序影响
+thread_local bool cache_table_destroyed = false;
+
+}  // namespace
+
+struct FixedSizePool::Central {
+  Central(std::size_t block_size, std::size_t blocks_per_chunk)
+      : block_size(block_size), blocks_per_chunk(blocks_per_chunk) {}
+
+  ~Central() {
+    for (void* chunk : chunks) {
+      ::operator delete(chunk);
+    }
+  }
+
+  // 在持有锁的情况下申请一个新的 chunk，并把它切分后挂到空闲链表
+  void grow() {
+    // 先预留位置，避免 push_back 抛出异常时泄漏刚申请的 chunk
+    chunks.reserve(chunks.size() + 1);
+    // operator new 返回的内存满足 max_align_t 对齐，块大小又是其整数倍
+    char* chunk = static_cast<char*>(::operator new(block_size * blocks_per_chunk));
+    chunks.push_back(chunk);
+    // 逆序压入，使分配顺序与地址顺序一致
+    for (std::size_t i = blocks_per_chunk; i > 0; --i) {
+      auto* block = reinterpret_cast<FreeBlock*>(chunk + (i - 1) * block_size);
+      block->next = free_list;
+      free_list = block;
+    }
+    free_count += blocks_per_chunk;
+  }
+
+  // 把一条 count 个块的链表挂回空闲链表
+  void push_chain(FreeBlock* head, FreeBlock* tail, std::size_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tail->next = free_list;
+    free_list = head;
+    free_count += count;
+  }
+
+  const std::size_t block_size;
+  const std::size_t blocks_per_chunk;
+
+  mutable std::mutex mutex;
+  FreeBlock* free_list = nullptr;
+  std::size_t free_count = 0;
+  std::vector<void*> chunks;
+};
+
+struct FixedSizePool::ThreadCache {
+  // 只在线程退出时使用：池已析构则缓存的块已随 chunk 释放，直接丢弃
+  std::weak_ptr<Central> central;
+  // 绑定的池的序号，0 表示未绑定
+  std::uint64_t serial = 0;
+  FreeBlock* head = nullptr;
+  std::size_t count = 0;
+};
+
+struct FixedSizePool::CacheTable {
+  ~CacheTable() {
+    cache_table_destroyed = true;
+    for (ThreadCache& cache : caches) {
+      if (cache.count == 0) {
+        continue;
+      }
+      if (std::shared_ptr<Central> central = cache.central.lock()) {
+        release(*central, cache, cache.count);
+      }
+    }
+  }
+
+  std::vector<ThreadCache> caches;
+};
+
+FixedSizePool::FixedSizePool(std::size_t block_size,
+                             std::size_t blocks_per_chunk,
+                             std::size_t batch_size)
+    : block_size_(round_block_size(block_size)),
+      batch_size_(batch_size == 0 ? 1 : batch_size),
+      serial_(next_pool_serial.fetch_add(1, std::memory_order_relaxed)),
+      id_(acquire_pool_id()),
+      central_(std::make_shared<Central>(
+          block_size_, blocks_per_chunk == 0 ? 1 : blocks_per_chunk)) {}
+
+// chunk 由 Central 持有，最后一个引用（池本身，或正在退出的线程临时持有的引用）释放时归还
+FixedSizePool::~FixedSizePool() {
+  release_pool_id(id_);
+}
+
+FixedSizePool::ThreadCache& FixedSizePool::thread_cache() {
+  thread_local CacheTable table;
+  if (id_ >= table.caches.size()) {
+    table.caches.resize(id_ + 1);
+  }
+  ThreadCache& cache = table.caches[id_];
+  if (cache.serial != serial_) {
+    // 槽未绑定，或属于复用了同一编号的已析构的池：旧池的块已随它的 chunk 释放，直接丢弃
+    cache.central = central_;
+    cache.serial = serial_;
+    cache.head = nullptr;
+    cache.count = 0;
+  }
+  return cache;
+}
+
+void* FixedSizePool::allocate() {
+  if (cache_table_destroyed) {
+    // 线程正在退出，缓存已不可用
+    std::lock_guard<std::mutex> lock(central_->mutex);
+    if (central_->free_list == nullptr) {
+      central_->grow();
+    }
+    FreeBlock* block = central_->free_list;
+    central_->free_list = block->next;
+    --central_->free_count;
+    return block;
+  }
+  ThreadCache& cache = thread_cache();
+  if (cache.head == nullptr) {
+    refill(cache);
+  }
+  FreeBlock* block = cache.head;
+  cache.head = block->next;
+  --cache.count;
+  return block;
+}
+
+void FixedSizePool::deallocate(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto* block = static_cast<FreeBlock*>(ptr);
+  if (cache_table_destroyed) {
+    central_->push_chain(block, block, 1);
+    return;
+  }
+  ThreadCache& cache = thread_cache();
+  block->next = cache.head;
+  cache.head = block;
+  // 缓存过大时归还一半，只保留 batch_size_ 个块供之后的分配使用
+  if (++cache.count >= 2 * batch_size_) {
+    release(*central_, cache, batch_size_);
+  }
+}
+
+void FixedSizePool::flush_thread_cache() {
+  if (cache_table_destroyed) {
+    return;
+  }
+  ThreadCache& cache = thread_cache();
+  if (cache.count != 0) {
+    release(*central_, cache, cache.count);
+  }
+}
+
+void FixedSizePool::refill(ThreadCache& cache) {
+  std::lock_guard<std::mutex> lock(central_->mutex);
+  while (central_->free_count < batch_size_) {
+    central_->grow();
+  }
+  // 从共享链表摘下前 batch_size_ 个块，一次性挂到缓存上
+  FreeBlock* head = central_->free_list;
+  FreeBlock* tail = head;
+  for (std::size_t i = 1; i < batch_size_; ++i) {
+    tail = tail->next;
+  }
+  central_->free_list = tail->next;
+  central_->free_count -= batch_size_;
+  tail->next = cache.head;
+  cache.head = head;
+  cache.count += batch_size_;
+}
+
+void FixedSizePool::release(Central& central, ThreadCache& cache, std::size_t count) {
+  // 在锁外摘下 count 个块，加锁后只需一次链表拼接
+  FreeBlock* head = cache.head;
+  FreeBlock* tail = head;
+  for (std::size_t i = 1; i < count; ++i) {
+    tail = tail->next;
+  }
+  cache.head = tail->next;
+  cache.count -= count;
+  central.push_chain(head, tail, count);
+}
+
+std::size_t FixedSizePool::blocks_in_use() const {
+  std::lock_guard<std::mutex> lock(central_->mutex);
+  return central_->chunks.size() * central_->blocks_per_chunk - central_->free_count;
+}
+
+std::size_t FixedSizePool::blocks_reserved() const {
+  std::lock_guard<std::mutex> lock(central_->mutex);
+  return central_->chunks.size() * central_->blocks_per_chunk;
+}
+
+}  // namespace cppthreadflow
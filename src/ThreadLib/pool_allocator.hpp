@@ -0,0 +1,109 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace cppthreadflow {
+
+/**
+ * @brief 定长内存块池。
+ *
+ * 每次向系统申请一整块 (chunk) 内存并切分为大小相同的块，释放的块挂到空闲链表上，
+ * 之后的分配优先复用它们。与逐个调用 operator new 相比，大量同尺寸节点的分配
+ * 不再进入通用分配器，内存也更紧凑。块只在池析构时归还给系统。
+ *
+ * 每个线程为每个池保留一个小的空闲块缓存：分配与释放通常只操作本线程的缓存，
+ * 不加锁也不写共享内存；缓存空了才从共享空闲链表批量取 batch_size 个块，
+ * 缓存超过 2 * batch_size 个块时批量归还一半，共享链表的互斥锁因此只在
+ * 每 batch_size 次操作中被获取一次。线程退出时，它缓存的块归还给共享链表。
+ * 块按 alignof(std::max_align_t) 对齐。
+ */
+class FixedSizePool {
+ public:
+  // 默认每次申请的块数
+  static constexpr std::size_t kDefaultBlocksPerChunk = 64;
+  // 默认每次在线程缓存与共享链表之间转移的块数
+  static constexpr std::size_t kDefaultBatchSize = 32;
+
+  /**
+   * @brief 构造一个内存池。
+   * @param block_size 每个块的字节数，会向上取整到对齐要求。
+   * @param blocks_per_chunk 每次向系统申请时切分的块数。
+   * @param batch_size 线程缓存每次批量取用或归还的块数。
+   */
+  explicit FixedSizePool(std::size_t block_size,
+                         std::size_t blocks_per_chunk = kDefaultBlocksPerChunk,
+                         std::size_t batch_size = kDefaultBatchSize);
+
+  /**
+   * @brief 析构函数，归还所有内存。此时不应再有块在使用中。
+   * 其他线程缓存中的块随之失效，那些线程之后不会再访问它们。
+   */
+  ~FixedSizePool();
+
+  // 禁止拷贝和移动
+  FixedSizePool(const FixedSizePool&) = delete;
+  FixedSizePool& operator=(const FixedSizePool&) = delete;
+  FixedSizePool(FixedSizePool&&) = delete;
+  FixedSizePool& operator=(FixedSizePool&&) = delete;
+
+  /**
+   * @brief 分配一个块。
+   * @throws std::bad_alloc 如果系统内存不足。
+   */
+  void* allocate();
+
+  /**
+   * @brief 归还一个由本池分配的块。可以在与分配不同的线程中归还。
+   */
+  void deallocate(void* ptr);
+
+  /**
+   * @brief 把当前线程缓存的空闲块全部归还给共享空闲链表。
+   */
+  void flush_thread_cache();
+
+  /**
+   * @brief 获取（对齐后的）块大小。
+   */
+  std::size_t block_size() const { return block_size_; }
+
+  /**
+   * @brief 获取不在共享空闲链表中的块数：正在使用的块，加上缓存在各线程中的空闲块。
+   * 所有线程都调用过 flush_thread_cache()（或已退出）时，等于正在使用的块数。
+   */
+  std::size_t blocks_in_use() const;
+
+  /**
+   * @brief 获取已向系统申请的块总数（使用中 + 空闲）。
+   */
+  std::size_t blocks_reserved() const;
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+  // 共享的空闲链表与 chunk，由 shared_ptr 持有，线程退出时据此判断池是否还活着
+  struct Central;
+  struct ThreadCache;
+  // 一个线程的全部缓存，按池编号索引；线程退出时析构并归还缓存的块
+  struct CacheTable;
+
+  // 当前线程对应本池的缓存
+  ThreadCache& thread_cache();
+  // 缓存为空时从共享链表批量取块
+  void refill(ThreadCache& cache);
+  // 把缓存中的 count 个块批量归还给共享链表
+  static void release(Central& central, ThreadCache& cache, std::size_t count);
+
+  const std::size_t block_size_;
+  const std::size_t batch_size_;
+  // 进程内唯一、不复用的池序号，用于识别线程缓存槽是否属于本池
+  const std::uint64_t serial_;
+  // 索引线程缓存的池编号；池析构后归还并被之后构造的池复用
+  const std::size_t id_;
+  const std::shared_ptr<Central> central_;
+};
+
+}  // namespace cppthreadflow
@@ -0,0 +1,159 @@
+﻿#include "rate_limiter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace cppthreadflow {
+
+namespace detail {
+
+RateLimiterBase::RateLimiterBase(Clock::duration interval, size_t burst)
+    : interval_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count()),
+      tolerance_ns_(interval_ns_ * static_cast<std::int64_t>(burst)),
+      burst_(burst) {
+    if (interval_ns_ <= 0) {
+        throw std::invalid_argument("rate limiter rate must be at most one permit per nanosecond");
+    }
+    if (burst == 0) {
+        throw std::invalid_argument("rate limiter burst must be greater than 0");
+    }
+}
+
+std::int64_t RateLimiterBase::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now().time_since_epoch())
+        .count();
+}
+
+void RateLimiterBase::check_request(size_t n) const {
+    if (n == 0 || n > burst_) {
+        throw std::invalid_argument("rate limiter request must be between 1 and burst");
+    }
+}
+
+bool RateLimiterBase::try_acquire(size_t n) {
+    check_request(n);
+    const std::int64_t now = now_ns();
+    const std::int64_t cost = interval_ns_ * static_cast<std::int64_t>(n);
+    std::int64_t tat = tat_.load(std::memory_order_relaxed);
+    while (true) {
+        // 空闲期间的补充体现为 tat 落后于现在，此时从现在开始计算
+        const std::int64_t new_tat = std::max(tat, now) + cost;
+        if (new_tat - now > tolerance_ns_) {
+            return false;
+        }
+        if (tat_.compare_exchange_weak(tat, new_tat, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+RateLimiterBase::TimePoint RateLimiterBase::reserve(size_t n) {
+    const std::int64_t now = now_ns();
+    const std::int64_t cost = interval_ns_ * static_cast<std::int64_t>(n);
+    std::int64_t tat = tat_.load(std::memory_order_relaxed);
+    std::int64_t new_tat = 0;
+    do {
+        new_tat = std::max(tat, now) + cost;
+    } while (!tat_.compare_exchange_weak(tat, new_tat, std::memory_order_relaxed));
+    // 推后之后的 tat 超出容许提前量的部分，就是需要等待的时间
+    const std::int64_t wait = std::max<std::int64_t>(0, new_tat - now - tolerance_ns_);
+    return TimePoint(std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds(now + wait)));
+}
+
+RateLimiterBase::Clock::duration RateLimiterBase::time_until_available(size_t n) const {
+    const std::int64_t now = now_ns();
+    const std::int64_t cost = interval_ns_ * static_cast<std::int64_t>(n);
+    const std::int64_t tat = tat_.load(std::memory_order_relaxed);
+    const std::int64_t wait = std::max(tat, now) + cost - now - tolerance_ns_;
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds(std::max<std::int64_t>(0, wait)));
+}
+
+void RateLimiterBase::acquire(size_t n) {
+    if (n == 0) {
+        throw std::invalid_argument("rate limiter request must be between 1 and burst");
+    }
+    std::this_thread::sleep_until(reserve(n));
+}
+
+bool RateLimiterBase::acquire(size_t n, const CancellationToken& token) {
+    check_request(n);
+    std::mutex mutex;
+    std::condition_variable cv;
+    auto registration = notify_on_cancel(token, mutex, cv);
+    while (!try_acquire(n)) {
+        std::unique_lock<std::mutex> lock(mutex);
+        // 睡到许可预计可用的时刻（或截止时间），醒来后重新竞争
+        const TimePoint ready = Clock::now() + time_until_available(n);
+        const TimePoint until = std::min(ready, token.deadline());
+        cv.wait_until(lock, until, [&] { return token.is_cancellation_requested(); });
+        if (token.is_cancellation_requested()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Scheduler::TaskId RateLimiterBase::acquire_async(Scheduler& scheduler, Scheduler::Task task,
+                                                 size_t n, const CancellationToken& token) {
+    if (n == 0) {
+        throw std::invalid_argument("rate limiter request must be between 1 and burst");
+    }
+    return scheduler.schedule_at(reserve(n), std::move(task), token);
+}
+
+} // namespace detail
+
+namespace {
+std::chrono::steady_clock::duration interval_from_rate(double tokens_per_second) {
+    if (!(tokens_per_second > 0.0) || !std::isfinite(tokens_per_second)) {
+        throw std::invalid_argument("TokenBucket rate must be greater than 0");
+    }
+    // 就近取整到纳秒：截断总是让间隔偏短，速率系统性地偏高。
+    // 超过每纳秒一个的速率取整为 0，由 RateLimiterBase 拒绝
+    const double interval_ns = std::round(1e9 / tokens_per_second);
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::nanoseconds(static_cast<std::int64_t>(interval_ns)));
+}
+
+std::chrono::steady_clock::duration interval_from_limit(size_t limit,
+                                                        std::chrono::steady_clock::duration period) {
+    if (limit == 0 || period <= std::chrono::steady_clock::duration::zero()) {
+        throw std::invalid_argument("GcraLimiter limit and period must be greater than 0");
+    }
+    // 就近取整，而不是截断
+    const auto count = static_cast<std::chrono::steady_clock::duration::rep>(limit);
+    return (period + std::chrono::steady_clock::duration(count / 2)) / count;
+}
+} // namespace
+
+TokenBucket::TokenBucket(double tokens_per_second, size_t burst)
+    : RateLimiterBase(interval_from_rate(tokens_per_second), burst) {}
+
+size_t TokenBucket::available_tokens() const {
+    const std::int64_t now = now_ns();
+    const std::int64_t tat = tat_.load(std::memory_order_relaxed);
+    // 剩余的提前量能容纳多少个间隔，就有多少个令牌
+    const std::int64_t slack = tolerance_ns_ - (std::max(tat, now) - now);
+    return static_cast<size_t>(std::max<std::int64_t>(0, slack) / interval_ns_);
+}
+
+GcraLimiter::GcraLimiter(size_t limit, Clock::duration period, size_t burst)
+    : RateLimiterBase(interval_from_limit(limit, period), burst != 0 ? burst : limit) {}
+
+bool GcraLimiter::try_acquire(size_t n, Clock::duration& retry_after) {
+    if (try_acquire(n)) {
+        retry_after = Clock::duration::zero();
+        return true;
+    }
+    retry_after = time_until_available(n);
+    return false;
+}
+
+} // namespace cppthreadflow
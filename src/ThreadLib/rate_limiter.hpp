@@ -0,0 +1,155 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "cancellation.hpp"
+#include "scheduler.hpp"
+
+namespace cppthreadflow {
+
+namespace detail {
+
+/**
+ * @brief 基于虚拟调度时间（GCRA）的限流器公共实现。
+ *
+ * 整个状态只有一个原子整数 tat_（theoretical arrival time，理论到达时间）：
+ * 每个许可把 tat_ 推后一个发放间隔，只要推后之后的 tat_ 不超过“现在 + 突发容量”
+ * 即可放行。补充是按单调时钟惰性计算的，不需要后台的补充任务，
+ * 每次获取只有一次 CAS（竞争失败时重试），因此可以同时存在成千上万个限流器。
+ */
+class RateLimiterBase {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  /**
+   * @brief 非阻塞地获取 n 个许可。
+   * @return 许可足够时扣除并返回 true，否则不做任何修改并返回 false。
+   * @throws std::invalid_argument 如果 n 为 0 或超过突发容量（永远不可能成功）。
+   */
+  bool try_acquire(size_t n = 1);
+
+  /**
+   * @brief 阻塞直到获得 n 个许可。
+   *
+   * 许可先被预留（可以透支），再睡眠到预留生效的时刻；等待者按预留顺序放行，
+   * 没有重试与唤醒风暴。
+   */
+  void acquire(size_t n = 1);
+
+  /**
+   * @brief 阻塞直到获得 n 个许可，或令牌被取消/到达截止时间。
+   * 与 acquire(n) 不同，等待期间不预留许可，被取消时不会消耗任何许可。
+   * @return 获得许可返回 true，被取消返回 false。
+   * @throws std::invalid_argument 如果 n 为 0 或超过突发容量。
+   */
+  bool acquire(size_t n, const CancellationToken& token);
+
+  /**
+   * @brief 异步获取：立即预留 n 个许可，并在预留生效时通过 scheduler 执行 task。
+   *
+   * 调用者线程不会阻塞，也不需要为等待占用线程池的线程。
+   * @param token 可选的取消令牌；取消后 task 不再执行，但预留的许可不会退还。
+   * @return scheduler 中的任务标识，可用于 Scheduler::cancel。
+   */
+  Scheduler::TaskId acquire_async(
+      Scheduler& scheduler, Scheduler::Task task, size_t n = 1,
+      const CancellationToken& token = CancellationToken());
+
+  /**
+   * @brief 预留 n 个许可（允许透支），返回预留生效的时刻。
+   * 返回的时刻不晚于现在时，许可已经可以使用。
+   */
+  TimePoint reserve(size_t n = 1);
+
+  /**
+   * @brief 距离 n 个许可可用还需要等待的时长；已经可用时返回 0。
+   */
+  Clock::duration time_until_available(size_t n = 1) const;
+
+  /**
+   * @brief 突发容量：空闲足够久之后，最多可以一次性获取的许可数。
+   */
+  size_t burst() const { return burst_; }
+
+ protected:
+  // interval 为发放一个许可的间隔，burst 为突发容量
+  RateLimiterBase(Clock::duration interval, size_t burst);
+  ~RateLimiterBase() = default;
+
+  // 禁止拷贝和移动
+  RateLimiterBase(const RateLimiterBase&) = delete;
+  RateLimiterBase& operator=(const RateLimiterBase&) = delete;
+
+  static std::int64_t now_ns();
+  void check_request(size_t n) const;
+
+  // 发放一个许可的间隔（纳秒）
+  const std::int64_t interval_ns_;
+  // 容许的提前量：burst 个间隔
+  const std::int64_t tolerance_ns_;
+  const size_t burst_;
+  // 理论到达时间（纳秒，Clock 的纪元起算）；初始为 0，即桶是满的
+  std::atomic<std::int64_t> tat_{0};
+};
+
+}  // namespace detail
+
+/**
+ * @brief 令牌桶限流器：以固定速率向容量为 burst 的桶中补充令牌，每次获取消耗令牌。
+ *
+ * 令牌数不单独存储，而是由理论到达时间推算（见 detail::RateLimiterBase），
+ * 补充完全是惰性的。桶空闲足够久之后可以一次性消耗 burst 个令牌。
+ *
+ * 补充间隔以整纳秒表示（就近取整），实际速率与配置的相对误差最多为 0.5 ns 除以间隔：
+ * 每秒 1e7 个以下时不超过 0.5%；接近每纳秒一个时误差显著（例如每秒 3e8 个的间隔为 3 ns，
+ * 实际速率高约 11%）。
+ */
+class TokenBucket : public detail::RateLimiterBase {
+ public:
+  /**
+   * @brief 构造函数。
+   * @param tokens_per_second 令牌补充速率，必须大于 0 且不超过每纳秒一个。
+   * @param burst 桶的容量，必须大于 0。
+   * @throws std::invalid_argument 如果参数不合法。
+   */
+  TokenBucket(double tokens_per_second, size_t burst);
+
+  /**
+   * @brief 当前可用的令牌数（并发获取时为近似值）。
+   */
+  size_t available_tokens() const;
+};
+
+/**
+ * @brief GCRA（Generic Cell Rate Algorithm，即“作为计量器的漏桶”）限流器：
+ * 长期平均每个 period 放行 limit 个请求；空闲足够久之后，最多可以连续放行 burst 个请求
+ * （burst 是突发的总容量，而不是在 limit 之外额外容许的数量）。
+ *
+ * 与令牌桶等价，但以“多少时间内多少个”表达速率，并能直接给出被拒绝的请求
+ * 应当在多久之后重试（retry_after）。
+ */
+class GcraLimiter : public detail::RateLimiterBase {
+ public:
+  /**
+   * @brief 构造函数。
+   * @param limit 每个 period 内放行的请求数，必须大于 0。
+   * @param period 统计周期，必须大于 0。
+   * @param burst 突发容量，即最多可以连续放行的请求数，0 表示与 limit 相同。
+   * @throws std::invalid_argument 如果参数不合法。
+   */
+  GcraLimiter(size_t limit, Clock::duration period, size_t burst = 0);
+
+  /**
+   * @brief 非阻塞地获取 n 个许可，被拒绝时给出建议的重试间隔。
+   * @param retry_after [输出参数] 被拒绝时设为距离许可可用的时长，放行时设为 0。
+   */
+  bool try_acquire(size_t n, Clock::duration& retry_after);
+
+  using detail::RateLimiterBase::try_acquire;
+};
+
+}  // namespace cppthreadflow
@@ -3,12 +3,16 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include "cancellation.hpp"
+
 namespace cppthreadflow {
 
 // 前向声明，避免循环引用头文件
@@ -16,6 +20,13 @@ class ThreadPool;
 
 /**
  * @brief 一个任务调度器，用于执行延迟或周期性任务。
+ *
+ * 取消任务（cancel 或取消令牌）时立即释放它的闭包及其捕获的资源，而不是等到原定的到期时间；
+ * 堆中残留的条目只有几个字节，累积到超过仍在等待的任务数时整体压缩一次。
+ * 只有截止时间到期（而没有调用 cancel()）的令牌不会触发回调，其任务在到期时才被丢弃。
+ *
+ * 到期的执行被线程池拒绝（队列已满、准入控制拒绝或已停止）时，这一次执行被丢弃，
+ * 周期性任务之后照常执行；被丢弃的次数可以通过 rejected_count() 获取。
  */
 class Scheduler {
  public:
@@ -24,6 +35,8 @@ class Scheduler {
   using Clock = std::chrono::steady_clock;
   using TimePoint = Clock::time_point;
   using Duration = Clock::duration;
+  // 任务标识，可用于取消尚未执行的任务；0 表示无效的任务
+  using TaskId = std::uint64_t;
 
   /**
    * @brief 构造函数。
@@ -47,33 +60,68 @@ class Scheduler {
    * @brief 在指定的时间点执行一次任务。
    * @param time 任务执行的绝对时间点。
    * @param task 要执行的任务。
+   * @param token 可选的取消令牌；到期时令牌已被取消，任务会被丢弃。
+   * @return 任务标识。
    */
-  void schedule_at(const TimePoint& time, Task task);
+  TaskId schedule_at(const TimePoint& time, Task task,
+                     const CancellationToken& token = CancellationToken());
 
   /**
    * @brief 在指定的延迟后执行一次任务。
    * @param delay 相对于现在的延迟时间。
    * @param task 要执行的任务。
+   * @param token 可选的取消令牌；到期时令牌已被取消，任务会被丢弃。
+   * @return 任务标识。
    */
-  void schedule_after(const Duration& delay, Task task);
+  TaskId schedule_after(const Duration& delay, Task task,
+                        const CancellationToken& token = CancellationToken());
 
   /**
    * @brief 安排一个周期性任务。
    * @param first_time 第一次执行的绝对时间点。
    * @param interval 两次执行之间的时间间隔。
    * @param task 要周期性执行的任务。
+   * @param token 可选的取消令牌；令牌被取消后任务不再执行，也不再被重新安排。
+   * @return 任务标识；interval 为 0 时任务不会被安排，返回 0。
+   */
+  TaskId schedule_periodic(const TimePoint& first_time,
+                           const Duration& interval, Task task,
+                           const CancellationToken& token = CancellationToken());
+
+  /**
+   * @brief 取消一个尚未执行的任务，或停止一个周期性任务。
+   * 已经提交到线程池的那一次执行不受影响。
+   * @param id 任务标识。
+   * @return 如果任务仍在等待执行并被成功取消，返回 true，否则返回 false。
+   */
+  bool cancel(TaskId id);
+
+  /**
+   * @brief 获取到期时被线程池拒绝而丢弃的执行次数。
    */
-  void schedule_periodic(const TimePoint& first_time, const Duration& interval,
-                         Task task);
+  std::uint64_t rejected_count() const {
+    return rejected_.load(std::memory_order_relaxed);
+  }
 
  private:
-  // 内部用于存储任务的结构体
+  // 堆中的条目只记录时间，闭包保存在 pending_ 中，取消时即可释放
   struct ScheduledTask {
+    TaskId id;
     TimePoint time;
     Duration interval;  // 对于非周期性任务，此值为0
+  };
+
+  // 仍在等待执行的任务
+  struct PendingTask {
     Task func;
+    CancellationToken token;
+    // 令牌被取消时调用 cancel()；必须在 mutex_ 之外销毁，因为回调本身会获取 mutex_
+    CancellationRegistration registration;
   };
 
+  // 堆中的条目超过这个数，且多于仍在等待的任务数的两倍时，压缩一次
+  static constexpr size_t kCompactThreshold = 64;
+
   // 用于优先队列的比较器，时间早的优先级高
   struct TaskComparer {
     bool operator()(const ScheduledTask& a, const ScheduledTask& b) const {
@@ -83,6 +131,11 @@ class Scheduler {
 
   // 调度器主循环
   void scheduler_loop();
+  // 登记一个任务，并在令牌上注册取消回调
+  TaskId add_task(const TimePoint& time, const Duration& interval, Task task,
+                  const CancellationToken& token);
+  // 丢弃堆中已被取消的条目；调用者需持有 mutex_
+  void compact_locked();
 
   ThreadPool& pool_;
   std::thread scheduler_thread_;
@@ -91,6 +144,10 @@ class Scheduler {
   std::mutex mutex_;
   std::condition_variable cv_;
   std::atomic<bool> stop_{false};
+  // 仍在等待执行的任务；被取消的任务从这里移除，堆中的条目出队时被直接丢弃
+  std::unordered_map<TaskId, PendingTask> pending_;
+  TaskId next_id_ = 1;
+  std::atomic<std::uint64_t> rejected_{0};
 };
 
 }  // namespace cppthreadflow
\ No newline at end of file
@@ -0,0 +1,147 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "cache_line.hpp"
+#include "spin_lock.hpp"
+
+namespace cppthreadflow {
+
+/**
+ * @brief 顺序锁 (seqlock)：为小的、可平凡复制的数据提供无锁的一致快照读取。
+ *
+ * 写者在写入前后各把序号加一（写入期间序号为奇数）；读者先读序号、复制数据、
+ * 再读一次序号，两次相同且为偶数就说明复制到的是一份完整的快照，否则重试。
+ * 读者不写任何共享内存，因此读多少次都不会让缓存行在核间迁移；
+ * 代价是写入频繁时读者可能反复重试，而写者之间需要互斥。
+ *
+ * 数据按 64 位字以原子方式存取，读者与写者并发时也没有数据竞争。
+ *
+ * @tparam T 数据类型，必须可平凡复制，通常不超过几条缓存行。
+ */
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "SeqLock requires a trivially copyable type");
+  static_assert(std::is_default_constructible_v<T>,
+                "SeqLock requires a default constructible type");
+
+ public:
+  /**
+   * @brief 构造函数。
+   * @param value 初始值。
+   */
+  explicit SeqLock(const T& value = T()) { write_words(value); }
+
+  // 禁止拷贝和移动
+  SeqLock(const SeqLock&) = delete;
+  SeqLock& operator=(const SeqLock&) = delete;
+
+  /**
+   * @brief 读取一份一致的快照。写入正在进行时自旋等待并重试。
+   */
+  T load() const {
+    T value;
+    int spins = 0;
+    while (!try_load(value)) {
+      if (++spins >= kSpinsBeforeYield) {
+        std::this_thread::yield();
+        spins = 0;
+      }
+    }
+    return value;
+  }
+
+  /**
+   * @brief 尝试读取一次快照。
+   * @param value_out [输出参数] 成功时写入快照。
+   * @return 没有与写入重叠时返回 true，否则返回 false（value_out 的内容未定义）。
+   */
+  bool try_load(T& value_out) const {
+    const std::uint64_t before = seq_.load(std::memory_order_acquire);
+    if ((before & 1) != 0) {
+      return false;
+    }
+    read_words(value_out);
+    // 保证数据的读取不会被重排到第二次读序号之后
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return seq_.load(std::memory_order_relaxed) == before;
+  }
+
+  /**
+   * @brief 写入新值。写者之间互斥。
+   */
+  void store(const T& value) {
+    std::lock_guard<SpinLock> lock(writer_lock_);
+    begin_write();
+    write_words(value);
+    end_write();
+  }
+
+  /**
+   * @brief 在写锁保护下读-改-写：以当前值调用 f(T&)，再发布修改后的值。
+   */
+  template <typename F>
+  void update(F&& f) {
+    std::lock_guard<SpinLock> lock(writer_lock_);
+    // 持有写锁时没有并发写者，直接读取即可
+    T value;
+    read_words(value);
+    f(value);
+    begin_write();
+    write_words(value);
+    end_write();
+  }
+
+  /**
+   * @brief 获取当前序号，每次写入增加 2。
+   */
+  std::uint64_t sequence() const {
+    return seq_.load(std::memory_order_acquire);
+  }
+
+ private:
+  static constexpr size_t kWordCount =
+      (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+  static constexpr int kSpinsBeforeYield = 64;
+
+  void begin_write() {
+    seq_.store(seq_.load(std::memory_order_relaxed) + 1,
+               std::memory_order_relaxed);
+    // 保证序号变为奇数先于任何数据写入被看到
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void end_write() {
+    seq_.store(seq_.load(std::memory_order_relaxed) + 1,
+               std::memory_order_release);
+  }
+
+  void read_words(T& value) const {
+    std::uint64_t buffer[kWordCount];
+    for (size_t i = 0; i < kWordCount; ++i) {
+      buffer[i] = words_[i].load(std::memory_order_relaxed);
+    }
+    std::memcpy(&value, buffer, sizeof(T));
+  }
+
+  void write_words(const T& value) {
+    std::uint64_t buffer[kWordCount] = {};
+    std::memcpy(buffer, &value, sizeof(T));
+    for (size_t i = 0; i < kWordCount; ++i) {
+      words_[i].store(buffer[i], std::memory_order_relaxed);
+    }
+  }
+
+  alignas(kCacheLineSize) std::atomic<std::uint64_t> seq_{0};
+  std::atomic<std::uint64_t> words_[kWordCount];
+  SpinLock writer_lock_;
+};
+
+}  // namespace cppthreadflow
@@ -0,0 +1,48 @@
+﻿#pragma once
+
+#include <atomic>
+#include <thread>
+
+namespace cppthreadflow {
+
+/**
+ * @brief 一个轻量的自旋锁，满足 Lockable 要求，可与 std::lock_guard 搭配使用。
+ *
+ * 只占一个字节，适合嵌入到大量细粒度对象（如跳表节点）中、临界区只有几条指令的场景。
+ * 等待时先只读地自旋（test-and-test-and-set），减少缓存行在核间来回迁移，
+ * 自旋一定次数后让出 CPU。临界区较长时应使用 std::mutex。
+ */
+class SpinLock {
+ public:
+  SpinLock() = default;
+
+  // 禁止拷贝和移动
+  SpinLock(const SpinLock&) = delete;
+  SpinLock& operator=(const SpinLock&) = delete;
+
+  void lock() {
+    int spins = 0;
+    while (locked_.exchange(true, std::memory_order_acquire)) {
+      while (locked_.load(std::memory_order_relaxed)) {
+        if (++spins >= kSpinsBeforeYield) {
+          std::this_thread::yield();
+          spins = 0;
+        }
+      }
+    }
+  }
+
+  bool try_lock() {
+    return !locked_.load(std::memory_order_relaxed) &&
+           !locked_.exchange(true, std::memory_order_acquire);
+  }
+
+  void unlock() { locked_.store(false, std::memory_order_release); }
+
+ private:
+  static constexpr int kSpinsBeforeYield = 64;
+
+  std::atomic<bool> locked_{false};
+};
+
+}  // namespace cppthreadflow
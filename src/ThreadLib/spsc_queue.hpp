@@ -0,0 +1,208 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "cache_line.hpp"
+#include "event_count.hpp"
+#include "hash_utils.hpp"
+
+namespace cppthreadflow {
+
+/**
+ * @brief 一个有界的单生产者/单消费者 (SPSC) 环形队列。
+ *
+ * try_push/try_pop 是无等待 (wait-free) 的：生产者只写 tail_，消费者只写 head_，
+ * 两个索引分别独占缓存行。双方各自缓存对方索引的最近一次读取值，
+ * 只有在缓存值显示队列已满/已空时才重新读取对方的索引，
+ * 因此在稳定流水线中，大部分操作都不会触碰对方正在写的缓存行。
+ *
+ * push/pop/stop 的语义与 ConcurrentQueue 一致，可直接替换：
+ * pop 在队列为空时阻塞，stop 之后 pop 仍会取完剩余元素，然后返回 false。
+ * 由于队列有界，push 在队列已满时阻塞等待空位。
+ *
+ * 同一时刻只能有一个线程调用 push/try_push，一个线程调用 pop/try_pop。
+ *
+ * @tparam T 队列中存储的元素类型。
+ */
+template <typename T>
+class SpscQueue {
+ public:
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  /**
+   * @brief 构造一个队列。
+   * @param capacity 容量，会向上取整为 2 的幂。
+   */
+  explicit SpscQueue(size_t capacity = kDefaultCapacity)
+      : capacity_(detail::next_power_of_two(capacity)),
+        mask_(capacity_ - 1),
+        slots_(new Slot[capacity_]) {}
+
+  ~SpscQueue() {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    for (size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i) {
+      slot_at(i)->~T();
+    }
+  }
+
+  // 禁止拷贝和移动
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  /**
+   * @brief 尝试向队列尾部添加一个元素（仅限生产者线程）。
+   * @return 如果队列已满，返回 false，item 保持不变。
+   */
+  bool try_push(T& item) { return try_emplace(std::move(item)); }
+
+  /**
+   * @brief 向队列尾部添加一个元素，队列已满时阻塞（仅限生产者线程）。
+   * @return 如果成功入队返回 true；如果在等待空位时队列被停止，返回 false，元素被丢弃。
+   */
+  bool push(T item) {
+    while (!try_emplace(std::move(item))) {
+      if (stop_.load(std::memory_order_seq_cst)) {
+        return false;
+      }
+      wait_for(not_full_, [this] {
+        return stop_.load(std::memory_order_seq_cst) || !full();
+      });
+    }
+    return true;
+  }
+
+  /**
+   * @brief 尝试从队列头部弹出一个元素（仅限消费者线程）。
+   * @return 如果队列为空，返回 false。
+   */
+  bool try_pop(T& item) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_seq_cst);
+      if (head == cached_tail_) {
+        return false;
+      }
+    }
+    T* slot = slot_at(head);
+    item = std::move(*slot);
+    slot->~T();
+    // seq_cst：与 EventCount 的等待协议配合，见 event_count.hpp
+    head_.store(head + 1, std::memory_order_seq_cst);
+    not_full_.notify();
+    return true;
+  }
+
+  /**
+   * @brief 从队列头部弹出一个元素，队列为空时阻塞（仅限消费者线程）。
+   * @return 如果成功弹出返回 true；如果队列被停止且为空，返回 false。
+   */
+  bool pop(T& item) {
+    while (!try_pop(item)) {
+      if (stop_.load(std::memory_order_seq_cst)) {
+        // stop 之前入队的元素仍然要取完
+        return try_pop(item);
+      }
+      wait_for(not_empty_, [this] {
+        return stop_.load(std::memory_order_seq_cst) || !empty();
+      });
+    }
+    return true;
+  }
+
+  /**
+   * @brief 停止队列，唤醒所有阻塞在 push/pop 上的线程。
+   */
+  void stop() {
+    stop_.store(true, std::memory_order_seq_cst);
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+  /**
+   * @brief 队列是否为空（近似值）。
+   */
+  bool empty() const {
+    return head_.load(std::memory_order_seq_cst) ==
+           tail_.load(std::memory_order_seq_cst);
+  }
+
+  /**
+   * @brief 获取元素数量（近似值）。
+   */
+  size_t size() const {
+    return tail_.load(std::memory_order_seq_cst) -
+           head_.load(std::memory_order_seq_cst);
+  }
+
+  /**
+   * @brief 获取容量。
+   */
+  size_t capacity() const { return capacity_; }
+
+ private:
+  struct Slot {
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  // 阻塞前先自旋重试的次数，流水线繁忙时通常无需挂起线程
+  static constexpr int kSpinCount = 64;
+
+  T* slot_at(size_t index) const {
+    return std::launder(reinterpret_cast<T*>(slots_[index & mask_].storage));
+  }
+
+  bool full() const { return size() >= capacity_; }
+
+  template <typename V>
+  bool try_emplace(V&& item) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == capacity_) {
+      cached_head_ = head_.load(std::memory_order_seq_cst);
+      if (tail - cached_head_ == capacity_) {
+        return false;
+      }
+    }
+    new (slots_[tail & mask_].storage) T(std::forward<V>(item));
+    // seq_cst：与 EventCount 的等待协议配合，见 event_count.hpp
+    tail_.store(tail + 1, std::memory_order_seq_cst);
+    not_empty_.notify();
+    return true;
+  }
+
+  // 先自旋，再通过 EventCount 挂起，直到 ready() 成立或被唤醒
+  template <typename Ready>
+  static void wait_for(EventCount& event, Ready ready) {
+    for (int i = 0; i < kSpinCount; ++i) {
+      if (ready()) {
+        return;
+      }
+    }
+    const EventCount::Key key = event.prepare_wait();
+    if (ready()) {
+      event.cancel_wait();
+      return;
+    }
+    event.wait(key);
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  // 消费者独占：读位置，以及对 tail_ 的缓存
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  size_t cached_tail_ = 0;
+  // 生产者独占：写位置，以及对 head_ 的缓存
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+  size_t cached_head_ = 0;
+
+  alignas(kCacheLineSize) std::atomic<bool> stop_{false};
+  EventCount not_empty_;
+  EventCount not_full_;
+};
+
+}  // namespace cppthreadflow
@@ -0,0 +1,46 @@
+﻿#include "strand.hpp"
+#include "thread_pool.hpp" // 需要 ThreadPool 的完整定义
+
+namespace cppthreadflow {
+
+namespace {
+// 当前线程正在执行的 strand，用于 running_in_this_thread()
+thread_local const void* current_strand = nullptr;
+} // namespace
+
+Strand::Strand(ThreadPool& pool, size_t max_batch)
+    : state_(std::make_shared<State>(pool, max_batch)) {}
+
+void Strand::post(std::function<void()> task) {
+    // 只有从“空闲”变为“有任务”的那次 post 负责提交排空任务
+    if (state_->queue_.push(new TaskNode(std::move(task)))) {
+        detail::schedule_serial_drain(state_->pool_, state_->shared_from_this());
+    }
+}
+
+bool Strand::running_in_this_thread() const {
+    return current_strand == state_.get();
+}
+
+Strand::State::~State() {
+    // 只有在线程池丢弃了排空任务时，这里才会剩下任务
+    queue_.clear([](MpscNode* node) { delete static_cast<TaskNode*>(node); });
+}
+
+bool Strand::State::drain() {
+    const void* previous = current_strand;
+    current_strand = this;
+    const bool more = queue_.drain(max_batch_, [](MpscNode* node) {
+        TaskNode* task_node = static_cast<TaskNode*>(node);
+        try {
+            task_node->task();
+        } catch (...) {
+            // post 提交的任务没有人接收异常，忽略它以免影响后续任务
+        }
+        delete task_node;
+    });
+    current_strand = previous;
+    return more;
+}
+
+} // namespace cppthreadflow
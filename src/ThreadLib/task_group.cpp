@@ -0,0 +1,118 @@
+﻿#include "task_group.hpp"
+#include "thread_pool.hpp" // 需要 ThreadPool 的完整定义
+
+#include <stdexcept>
+#include <string>
+
+namespace cppthreadflow {
+
+TaskGroupError::TaskGroupError(std::vector<std::exception_ptr> exceptions)
+    : std::runtime_error(std::to_string(exceptions.size()) + " task(s) in TaskGroup failed"),
+      exceptions_(std::move(exceptions)) {}
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+    : pool_(checked_pool(pool)), state_(std::make_shared<State>(CancellationSource())) {}
+
+TaskGroup::TaskGroup(ThreadPool& pool, const CancellationToken& parent)
+    : pool_(checked_pool(pool)), state_(std::make_shared<State>(CancellationSource(parent))) {}
+
+ThreadPool& TaskGroup::checked_pool(ThreadPool& pool) {
+    // 被丢弃的任务在队列锁内析构，无法在那里安全地记录失败（会触发取消回调）
+    const OverflowPolicy policy = pool.overflow_policy();
+    if (policy == OverflowPolicy::kDropOldest || policy == OverflowPolicy::kDropNewest) {
+        throw std::invalid_argument("TaskGroup requires a ThreadPool with kBlock or kFailFast overflow policy");
+    }
+    return pool;
+}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+        // 析构函数中不能抛出异常，调用者应当显式调用 wait() 获取错误
+    }
+}
+
+void TaskGroup::run_impl(std::function<void()> task) {
+    {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        ++state_->pending;
+    }
+    auto state = state_;
+    try {
+        pool_.submit([state, task = std::move(task)]() { state->execute(task); });
+    } catch (...) {
+        // 线程池拒绝了任务（已满或已停止），按任务失败处理
+        state_->record_error(std::current_exception());
+        state_->finish_one();
+    }
+}
+
+void TaskGroup::wait() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(state_->mutex);
+            if (state_->pending == 0) {
+                break;
+            }
+        }
+        // 帮忙执行排队的任务（可能是自己的子任务，也可能是其他任务），而不是挂起
+        if (pool_.try_run_pending_task()) {
+            continue;
+        }
+        // 队列为空：剩余的子任务都在其他线程上执行，短暂等待后再检查队列
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->cv.wait_for(lock, kHelpPollInterval, [this] { return state_->pending == 0; });
+    }
+
+    std::vector<std::exception_ptr> errors;
+    {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        errors.swap(state_->errors);
+    }
+    if (!errors.empty()) {
+        throw TaskGroupError(std::move(errors));
+    }
+}
+
+void TaskGroup::cancel() {
+    state_->source.cancel();
+}
+
+bool TaskGroup::is_cancelled() const {
+    return state_->source.is_cancellation_requested();
+}
+
+CancellationToken TaskGroup::token() const {
+    return state_->source.token();
+}
+
+void TaskGroup::State::execute(const std::function<void()>& task) {
+    // 任务组已被取消时，尚未开始的子任务直接跳过
+    if (!source.is_cancellation_requested()) {
+        try {
+            task();
+        } catch (...) {
+            record_error(std::current_exception());
+        }
+    }
+    finish_one();
+}
+
+void TaskGroup::State::record_error(std::exception_ptr error) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        errors.push_back(error);
+    }
+    // 一个子任务失败，取消其余的子任务
+    source.cancel();
+}
+
+void TaskGroup::State::finish_one() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (--pending == 0) {
+        cv.notify_all();
+    }
+}
+
+} // namespace cppthreadflow
@@ -0,0 +1,182 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cppthreadflow {
+
+// 前向声明，避免循环引用头文件
+class ThreadPool;
+
+/**
+ * @brief 租户的调度参数。
+ */
+struct TenantOptions {
+  // 租户名称，仅用于诊断
+  std::string name;
+  // 权重：每轮调度中这个租户最多连续获得的任务数，必须大于 0
+  size_t weight = 1;
+  // 同时在线程池上执行的任务数上限，0 表示不限制
+  size_t max_concurrency = 0;
+};
+
+/**
+ * @brief 单个租户的统计。
+ */
+struct TenantStats {
+  std::uint64_t submitted = 0;  // 提交的任务数
+  std::uint64_t completed = 0;  // 执行完毕的任务数
+  std::uint64_t rejected = 0;   // 被线程池拒绝提交而丢弃的任务数
+  size_t queued = 0;            // 当前排队等待的任务数
+  size_t running = 0;           // 当前正在执行的任务数
+  // 任务从提交到开始执行的累计等待时间
+  std::chrono::nanoseconds total_wait_time{0};
+  // 单个任务的最长等待时间
+  std::chrono::nanoseconds max_wait_time{0};
+};
+
+/**
+ * @brief 多租户公平调度器：多个租户共享一个 ThreadPool，按权重公平地分配执行机会。
+ *
+ * 每个租户有自己的 FIFO 队列。调度器同时提交到线程池的任务数不超过 max_in_flight
+ * （默认为线程池的线程数），空出位置时用赤字轮询（Deficit Round Robin）选出下一个任务：
+ * 有任务的租户排成一个环，轮到某个租户时它获得 weight 个额度，每执行一个任务消耗一个，
+ * 额度用完或队列变空后轮到下一个租户。因此某个租户一次提交大量任务，只会让它自己的
+ * 队列变长，其他租户的任务仍然按权重比例得到执行，而不会排在突发任务之后。
+ *
+ * 达到 max_concurrency 的租户在轮询中被跳过，直到它的某个任务执行完毕。
+ *
+ * 线程池拒绝提交（QueueFullError、AdmissionRejected 或已停止）的任务按失败处理：
+ * 它被丢弃并计入租户的 rejected 统计，submit 返回的 future 收到 broken_promise 错误。
+ * 被拒绝的任务不会在调用 post/submit 的线程上执行。之后由执行中的任务完成时继续调度；
+ * 调度器没有任务在执行时，其余排队的任务立即继续尝试提交，以免永远停滞。
+ *
+ * 线程池应当使用 kBlock（默认）或 kFailFast 溢出策略：使用丢弃策略时，
+ * 被丢弃的任务不会归还执行位置。
+ */
+class TenantScheduler {
+ public:
+  using TenantId = size_t;
+
+  /**
+   * @brief 构造函数。
+   * @param pool 执行任务的线程池，必须比这个调度器以及它的所有任务活得更久。
+   * @param max_in_flight 同时提交到线程池的任务数上限，0 表示使用线程池的线程数。
+   *        上限越小，调度越公平；上限越大，越不容易让线程空闲。
+   */
+  explicit TenantScheduler(ThreadPool& pool, size_t max_in_flight = 0);
+
+  /**
+   * @brief 析构函数。
+   * 已提交的任务仍会在线程池上按调度顺序执行完。
+   */
+  ~TenantScheduler() = default;
+
+  // 禁止拷贝和移动
+  TenantScheduler(const TenantScheduler&) = delete;
+  TenantScheduler& operator=(const TenantScheduler&) = delete;
+  TenantScheduler(TenantScheduler&&) = delete;
+  TenantScheduler& operator=(TenantScheduler&&) = delete;
+
+  /**
+   * @brief 注册一个租户。
+   * @throws std::invalid_argument 如果 weight 为 0。
+   * @return 租户标识，用于提交任务和查询统计。
+   */
+  TenantId add_tenant(TenantOptions options = TenantOptions());
+
+  /**
+   * @brief 以某个租户的身份提交一个任务，不关心结果。任务抛出的异常会被忽略。
+   * @throws std::out_of_range 如果租户不存在。
+   */
+  void post(TenantId tenant, std::function<void()> task);
+
+  /**
+   * @brief 以某个租户的身份提交一个任务，并通过 future 获取其结果或异常。
+   * @throws std::out_of_range 如果租户不存在。
+   */
+  template <class F, class... Args>
+  auto submit(TenantId tenant, F&& f, Args&&... args)
+      -> std::future<std::invoke_result_t<F, Args...>>;
+
+  /**
+   * @brief 获取某个租户的统计。
+   * @throws std::out_of_range 如果租户不存在。
+   */
+  TenantStats tenant_stats(TenantId tenant) const;
+
+  /**
+   * @brief 获取租户数量。
+   */
+  size_t tenant_count() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Job {
+    std::function<void()> task;
+    Clock::time_point enqueued;
+  };
+
+  struct Tenant {
+    explicit Tenant(TenantOptions o) : options(std::move(o)) {}
+
+    const TenantOptions options;
+    std::deque<Job> queue;
+    // 本轮剩余的额度
+    size_t deficit = 0;
+    // 是否在轮询环中
+    bool active = false;
+    TenantStats stats;
+  };
+
+  // 由 shared_ptr 持有：提交到线程池的任务保存一份引用，
+  // 因此调度器析构后，剩余的任务仍能安全地执行完
+  struct State : std::enable_shared_from_this<State> {
+    State(ThreadPool& pool, size_t max_in_flight)
+        : pool_(pool), max_in_flight_(max_in_flight) {}
+
+    // 只要还有空位且有可调度的任务，就把任务提交到线程池
+    void dispatch();
+    // 按赤字轮询选出下一个可执行的租户，没有时返回 nullptr；调用者需持有 mutex_
+    Tenant* pick_locked();
+    // 执行一个任务，然后归还执行位置
+    void execute(const std::function<void()>& task, Tenant* tenant);
+    Tenant& tenant_locked(TenantId id) const;
+
+    ThreadPool& pool_;
+    const size_t max_in_flight_;
+
+    mutable std::mutex mutex_;
+    // 租户只增不减，用 unique_ptr 保证地址稳定
+    std::vector<std::unique_ptr<Tenant>> tenants_;
+    // 有任务排队的租户组成的轮询环，队首是当前轮到的租户
+    std::deque<Tenant*> active_;
+    size_t in_flight_ = 0;
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+template <class F, class... Args>
+auto TenantScheduler::submit(TenantId tenant, F&& f, Args&&... args)
+    -> std::future<std::invoke_result_t<F, Args...>> {
+  using return_type = std::invoke_result_t<F, Args...>;
+  auto task = std::make_shared<std::packaged_task<return_type()>>(
+      std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+  std::future<return_type> future = task->get_future();
+  post(tenant, [task]() { (*task)(); });
+  return future;
+}
+
+}  // namespace cppthreadflow
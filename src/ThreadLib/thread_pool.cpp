@@ -1,8 +1,30 @@
 ﻿#include "thread_pool.hpp"
+#include "epoch_reclaimer.hpp"
+
+#include <algorithm>
 
 namespace cppthreadflow {
 
-ThreadPool::ThreadPool(size_t num_threads) {
+namespace {
+ThreadPoolOptions options_with_threads(size_t num_threads) {
+ ThreadPoolOptions options;
+ options.num_threads = num_threads;
+ return options;
+}
+} // namespace
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : ThreadPool(options_with_threads(num_threads)) {}
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options)
+    : deadline_queue_(options.deadline_ordering),
+      drop_expired_tasks_(options.drop_expired_tasks),
+      admission_(options.admission.enabled
+                     ? std::make_unique<AdmissionController>(
+                           options.admission, std::max<size_t>(1, options.num_threads))
+                     : nullptr),
+      task_queue_(options.queue_capacity, options.overflow_policy) {
+ size_t num_threads = options.num_threads;
  if (num_threads == 0) {
   // 保证至少有一个线程
   num_threads = 1;
@@ -29,13 +51,122 @@ ThreadPool::~ThreadPool() {
  }
 }
 
+namespace {
+// 准入名额：随任务一起析构时归还，因此执行完、被溢出策略丢弃或提交失败的任务都会归还名额
+class AdmissionSlot {
+public:
+ explicit AdmissionSlot(AdmissionController* controller) : controller_(controller) {}
+ ~AdmissionSlot() { controller_->release(); }
+
+ // 禁止拷贝和移动
+ AdmissionSlot(const AdmissionSlot&) = delete;
+ AdmissionSlot& operator=(const AdmissionSlot&) = delete;
+
+private:
+ AdmissionController* controller_;
+};
+} // namespace
+
+void ThreadPool::enqueue(std::function<void()> task) {
+ if (admission_) {
+  if (!admission_->try_acquire()) {
+   throw AdmissionRejected();
+  }
+  task = [controller = admission_.get(), inner = std::move(task),
+          slot = std::make_shared<AdmissionSlot>(admission_.get()),
+          enqueued = Clock::now()]() {
+   // 开始执行时报告排队延迟，作为拥塞信号
+   controller->on_start(Clock::now() - enqueued);
+   inner();
+  };
+ }
+ if (!task_queue_.push(std::move(task))) {
+  switch (task_queue_.overflow_policy()) {
+   case OverflowPolicy::kFailFast:
+    throw QueueFullError();
+   case OverflowPolicy::kBlock:
+    // 等待空位时线程池被停止
+    throw std::runtime_error("submit on a stopped ThreadPool");
+   default:
+    // kDropNewest：任务被丢弃，future 将收到 broken_promise 错误
+    break;
+  }
+ }
+}
+
+DeadlineStats ThreadPool::deadline_stats() const {
+ DeadlineStats stats;
+ stats.submitted = deadline_sequence_.load(std::memory_order_relaxed);
+ stats.expired = deadline_expired_.load(std::memory_order_relaxed);
+ stats.late = deadline_late_.load(std::memory_order_relaxed);
+ return stats;
+}
+
+ThreadPool::DeadlineTaskPtr ThreadPool::claim_deadline_task(const DeadlineTaskPtr& own) {
+ DeadlineTaskPtr task;
+ int misses = 0;
+ while (true) {
+  if (deadline_queue_.try_pop(task)) {
+   // 已被认领（被丢弃或被 FIFO 退回路径执行）的任务直接跳过
+   if (!task->claimed.exchange(true, std::memory_order_acq_rel)) {
+    return task;
+   }
+   continue;
+  }
+  // 宽松队列的 try_pop 可能与并发的 push/pop 错过：有限次重试后不再等待最早截止的任务，
+  // 退回 FIFO 顺序，认领票据自己对应的任务
+  if (++misses < kDeadlineClaimAttempts) {
+   continue;
+  }
+  if (!own->claimed.exchange(true, std::memory_order_acq_rel)) {
+   return own;
+  }
+  // 自己的任务已被其他票据执行：未认领的任务数不少于票据数，
+  // 队列中一定还有一个，只是暂时与其他线程的出队错过，让出后再取
+  misses = 0;
+  std::this_thread::yield();
+ }
+}
+
+void ThreadPool::run_deadline_task(const DeadlineTaskPtr& own) {
+ DeadlineTaskPtr task = claim_deadline_task(own);
+ task->run();
+}
+
+void ThreadPool::drop_deadline_task(const DeadlineTaskPtr& own) noexcept {
+ DeadlineTaskPtr task = own;
+ if (task->claimed.exchange(true, std::memory_order_acq_rel)) {
+  // 自己对应的任务已被其他票据执行，改为丢弃一个最早截止的未认领任务
+  task = claim_deadline_task(own);
+ }
+ // 销毁 packaged_task，future 将收到 broken_promise 错误；
+ // 仍留在截止时间队列中的条目之后被取出时会因已认领而跳过
+ task->run = nullptr;
+}
+
+bool ThreadPool::try_run_pending_task() {
+ std::function<void()> task;
+ if (!task_queue_.try_pop(task)) {
+  return false;
+ }
+ if (task) {
+  task();
+ }
+ return true;
+}
+
 void ThreadPool::worker_thread() {
+ // 工作线程启动时即登记到内存回收域，任务中可直接使用无锁结构
+ EpochReclaimer& reclaimer = EpochReclaimer::instance();
+ reclaimer.register_thread();
+
  while (true) {
   std::function<void()> task;
 
   // 从任务队列中获取任务，如果队列为空则阻塞
   if (!task_queue_.pop(task)) {
    // 如果 pop 返回 false，意味着队列已停止且为空，线程可以安全退出
+   reclaimer.unregister_thread();
    return;
   }
 
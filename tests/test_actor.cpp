@@ -0,0 +1,171 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/actor.hpp"
+#include <atomic>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 按顺序累加收到的数字；收到负数时通过 promise 报告当前状态
+class Accumulator : public cppthreadflow::Actor<int> {
+public:
+    explicit Accumulator(std::promise<std::vector<int>>* done) : done_(done) {}
+
+protected:
+    void receive(int& message) override {
+        if (message < 0) {
+            done_->set_value(received_);
+            return;
+        }
+        if (message == 13) {
+            throw std::runtime_error("unlucky message");
+        }
+        received_.push_back(message); // 私有状态，无需加锁
+    }
+
+private:
+    std::promise<std::vector<int>>* done_;
+    std::vector<int> received_;
+};
+
+// 乒乓消息：携带剩余次数和回复地址
+struct Ball {
+    int remaining;
+    cppthreadflow::ActorRef<Ball> reply_to;
+};
+
+// 把剩余次数减一后回复给发送者，直到次数为 0
+class Player : public cppthreadflow::Actor<Ball> {
+public:
+    explicit Player(std::promise<int>* done) : done_(done) {}
+
+protected:
+    void receive(Ball& ball) override {
+        ++hits_;
+        if (ball.remaining == 0) {
+            done_->set_value(hits_);
+            return;
+        }
+        ball.reply_to.tell(Ball{ball.remaining - 1, self()});
+    }
+
+private:
+    std::promise<int>* done_;
+    int hits_ = 0;
+};
+
+// 累加收到的数字，收到 0 时把本地计数汇总到 total
+class Counter : public cppthreadflow::Actor<int> {
+public:
+    explicit Counter(std::atomic<int>* total) : total_(total) {}
+
+protected:
+    void receive(int& value) override {
+        local_ += value;
+        if (value == 0) {
+            total_->fetch_add(local_);
+        }
+    }
+
+private:
+    std::atomic<int>* total_;
+    int local_ = 0;
+};
+
+} // namespace
+
+// 1. 测试消息按顺序处理，receive 的异常不影响后续消息
+TEST(ActorTest, ProcessesMessagesInOrder) {
+    cppthreadflow::ThreadPool pool(4);
+    std::promise<std::vector<int>> done;
+    auto actor = cppthreadflow::spawn<Accumulator>(pool, {}, &done);
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(actor.tell(i));
+    }
+    actor.tell(-1);
+
+    std::vector<int> received = done.get_future().get();
+    ASSERT_EQ(received.size(), 999u); // 13 触发异常，被跳过
+    int expected = 0;
+    for (int value : received) {
+        if (expected == 13) {
+            ++expected;
+        }
+        EXPECT_EQ(value, expected++);
+    }
+}
+
+// 2. 测试有界邮箱：已满时 tell 返回 false 并计数
+TEST(ActorTest, MailboxCapacityRejectsOverflow) {
+    cppthreadflow::ThreadPool pool(1);
+    std::promise<std::vector<int>> done;
+    cppthreadflow::ActorOptions options;
+    options.mailbox_capacity = 4;
+    auto actor = cppthreadflow::spawn<Accumulator>(pool, options, &done);
+
+    // 占住唯一的工作线程，让消息留在邮箱中
+    std::promise<void> gate;
+    pool.submit([opened = gate.get_future().share()]() { opened.wait(); });
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(actor.tell(i));
+    }
+    EXPECT_FALSE(actor.tell(4));
+    EXPECT_EQ(actor.rejected_count(), 1u);
+    EXPECT_EQ(actor.mailbox_size(), 4u);
+
+    gate.set_value();
+    // 邮箱腾出空间后可以继续发送
+    while (!actor.tell(-1)) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(done.get_future().get(), (std::vector<int>{0, 1, 2, 3}));
+}
+
+// 3. 测试两个 actor 之间通过回复地址来回传递消息
+TEST(ActorTest, PingPong) {
+    cppthreadflow::ThreadPool pool(2);
+    std::promise<int> done;
+    auto ping = cppthreadflow::spawn<Player>(pool, {}, &done);
+    auto pong = cppthreadflow::spawn<Player>(pool, {}, &done);
+
+    // pong 先收到消息，共 1001 次传递，最后一次由 pong 收到
+    pong.tell(Ball{1000, ping});
+    EXPECT_EQ(done.get_future().get(), 501);
+}
+
+// 4. 测试大量 actor 共享少量工作线程
+TEST(ActorTest, ManyActorsShareWorkers) {
+    cppthreadflow::ThreadPool pool(4);
+    std::atomic<int> total(0);
+    const int num_actors = 10000;
+    const int messages_per_actor = 10;
+    std::vector<cppthreadflow::ActorRef<int>> actors;
+    actors.reserve(num_actors);
+    for (int i = 0; i < num_actors; ++i) {
+        actors.push_back(cppthreadflow::spawn<Counter>(pool, {}, &total));
+    }
+
+    std::vector<std::thread> senders;
+    for (int t = 0; t < 4; ++t) {
+        senders.emplace_back([&, t]() {
+            for (int i = t; i < num_actors; i += 4) {
+                for (int j = 1; j < messages_per_actor; ++j) {
+                    actors[i].tell(1);
+                }
+                actors[i].tell(0); // 最后一条消息：汇报本 actor 的计数
+            }
+        });
+    }
+    for (auto& t : senders) {
+        t.join();
+    }
+    while (total.load() < num_actors * (messages_per_actor - 1)) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(total.load(), num_actors * (messages_per_actor - 1));
+}
@@ -0,0 +1,120 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/admission_controller.hpp"
+#include "../src/ThreadLib/thread_pool.hpp"
+#include <chrono>
+#include <future>
+#include <stdexcept>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+cppthreadflow::AdmissionOptions make_options(size_t initial, size_t min_limit, size_t max_limit) {
+    cppthreadflow::AdmissionOptions options;
+    options.enabled = true;
+    options.target_delay = 5ms;
+    options.interval = 100ms;
+    options.initial_limit = initial;
+    options.min_limit = min_limit;
+    options.max_limit = max_limit;
+    options.backoff = 0.5;
+    options.increase = 2;
+    return options;
+}
+
+} // namespace
+
+// 1. 测试名额的申请与归还
+TEST(AdmissionControllerTest, AcquireUpToLimit) {
+    cppthreadflow::AdmissionController controller(make_options(3, 1, 10), 1);
+    EXPECT_EQ(controller.current_limit(), 3u);
+    EXPECT_TRUE(controller.try_acquire());
+    EXPECT_TRUE(controller.try_acquire());
+    EXPECT_TRUE(controller.try_acquire());
+    EXPECT_FALSE(controller.try_acquire());
+    controller.release();
+    EXPECT_TRUE(controller.try_acquire());
+
+    auto stats = controller.stats();
+    EXPECT_EQ(stats.admitted, 4u);
+    EXPECT_EQ(stats.rejected, 1u);
+    EXPECT_EQ(stats.in_flight, 3u);
+}
+
+// 2. 测试 AIMD：窗口内最小延迟超过目标时乘性减，不拥塞且用满时加性增
+TEST(AdmissionControllerTest, AdjustsLimitPerWindow) {
+    using Clock = cppthreadflow::AdmissionController::Clock;
+    cppthreadflow::AdmissionController controller(make_options(16, 2, 20), 1);
+    auto now = Clock::now();
+
+    // 窗口内有一个短延迟：按最小值判断，不算拥塞；名额没有用满，上限不变
+    controller.on_start(20ms, now);
+    controller.on_start(1ms, now);
+    controller.on_start(20ms, now + 150ms);
+    EXPECT_EQ(controller.current_limit(), 16u);
+
+    // 整个窗口的延迟都超过目标：上限减半
+    controller.on_start(20ms, now + 200ms);
+    controller.on_start(30ms, now + 300ms);
+    EXPECT_EQ(controller.current_limit(), 8u);
+
+    // 减小不会低于 min_limit
+    for (int i = 4; i < 10; ++i) {
+        controller.on_start(50ms, now + i * 110ms);
+    }
+    EXPECT_EQ(controller.current_limit(), 2u);
+
+    // 名额被用满过且没有拥塞：每个窗口加 increase
+    EXPECT_TRUE(controller.try_acquire());
+    EXPECT_TRUE(controller.try_acquire());
+    controller.on_start(1ms, now + 2s);
+    EXPECT_EQ(controller.current_limit(), 4u);
+}
+
+// 3. 测试参数检查
+TEST(AdmissionControllerTest, RejectsInvalidOptions) {
+    auto bad_backoff = make_options(4, 1, 10);
+    bad_backoff.backoff = 1.0;
+    EXPECT_THROW(cppthreadflow::AdmissionController(bad_backoff, 1), std::invalid_argument);
+    EXPECT_THROW(cppthreadflow::AdmissionController(make_options(4, 8, 4), 1), std::invalid_argument);
+}
+
+// 4. 测试 ThreadPool 接入：超过上限的 submit 抛出 AdmissionRejected，执行完的任务归还名额
+TEST(AdmissionControllerTest, ThreadPoolRejectsWhenOverLimit) {
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.admission = make_options(2, 1, 10);
+    cppthreadflow::ThreadPool pool(options);
+    EXPECT_EQ(pool.admission_limit(), 2u);
+
+    std::promise<void> started;
+    std::promise<void> release;
+    auto blocker = pool.submit([&started, opened = release.get_future().share()]() {
+        started.set_value();
+        opened.wait();
+    });
+    started.get_future().wait();
+    auto queued = pool.submit([]() { return 1; });
+    EXPECT_THROW(pool.submit([]() { return 2; }), cppthreadflow::AdmissionRejected);
+
+    release.set_value();
+    blocker.get();
+    EXPECT_EQ(queued.get(), 1);
+    // future 就绪时任务可能还没归还名额
+    while (pool.admission_stats().in_flight != 0) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(pool.submit([]() { return 3; }).get(), 3);
+
+    auto stats = pool.admission_stats();
+    EXPECT_EQ(stats.admitted, 3u);
+    EXPECT_EQ(stats.rejected, 1u);
+}
+
+// 5. 测试未启用准入控制时不限制提交
+TEST(AdmissionControllerTest, DisabledByDefault) {
+    cppthreadflow::ThreadPool pool(1);
+    EXPECT_EQ(pool.admission_limit(), 0u);
+    EXPECT_EQ(pool.submit([]() { return 1; }).get(), 1);
+    EXPECT_EQ(pool.admission_stats().admitted, 0u);
+}
@@ -97,4 +97,28 @@ TEST(BarrierTest, IsReusable) {
 
   // 验证：所有 5 个线程都成功退出了循环，没有发生死锁
   EXPECT_EQ(completed_threads.load(), num_threads);
-}
\ No newline at end of file
+}
+
+
+// 4. 测试被取消的到达会被撤回，不影响后续的同步
+TEST(BarrierTest, CancelledArrivalIsWithdrawn) {
+  cppthreadflow::Barrier barrier(2);
+  cppthreadflow::CancellationSource source;
+
+  std::thread waiter([&]() { EXPECT_FALSE(barrier.arrive_and_wait(source.token())); });
+  std::this_thread::sleep_for(30ms);
+  source.cancel();
+  waiter.join();
+
+  // 撤回之后，仍然需要两个参与者才能完成这一代
+  std::atomic<int> passed = 0;
+  std::thread first([&]() {
+    barrier.arrive_and_wait();
+    passed++;
+  });
+  std::this_thread::sleep_for(30ms);
+  EXPECT_EQ(passed.load(), 0);
+  barrier.arrive_and_wait();
+  first.join();
+  EXPECT_EQ(passed.load(), 1);
+}
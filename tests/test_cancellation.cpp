@@ -0,0 +1,106 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/cancellation.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// 1. 测试 cancel 执行已注册的回调，且只执行一次
+TEST(CancellationTest, CancelRunsCallbacksOnce) {
+    cppthreadflow::CancellationSource source;
+    auto token = source.token();
+    std::atomic<int> calls(0);
+
+    auto registration = token.register_callback([&calls]() { calls++; });
+    EXPECT_TRUE(token.can_be_cancelled());
+    EXPECT_FALSE(token.is_cancellation_requested());
+
+    source.cancel();
+    source.cancel(); // 重复取消不会再次执行回调
+    EXPECT_TRUE(token.is_cancellation_requested());
+    EXPECT_EQ(calls.load(), 1);
+    EXPECT_THROW(token.throw_if_cancellation_requested(), cppthreadflow::OperationCancelled);
+}
+
+// 2. 测试在已取消的令牌上注册回调会立即执行，注销后的回调不再执行
+TEST(CancellationTest, RegisterAfterCancelAndUnregister) {
+    cppthreadflow::CancellationSource source;
+    std::atomic<int> calls(0);
+
+    auto registration = source.token().register_callback([&calls]() { calls++; });
+    registration.unregister();
+    source.cancel();
+    EXPECT_EQ(calls.load(), 0);
+
+    auto late = source.token().register_callback([&calls]() { calls++; });
+    EXPECT_EQ(calls.load(), 1);
+}
+
+// 3. 测试取消沿父子关系向下传播，但不会向上传播
+TEST(CancellationTest, ParentCancelPropagatesToChildren) {
+    cppthreadflow::CancellationSource parent;
+    cppthreadflow::CancellationSource child(parent.token());
+    cppthreadflow::CancellationSource grandchild(child.token());
+    std::atomic<int> calls(0);
+    auto registration = grandchild.token().register_callback([&calls]() { calls++; });
+
+    cppthreadflow::CancellationSource sibling(parent.token());
+    sibling.cancel();
+    EXPECT_FALSE(parent.is_cancellation_requested());
+    EXPECT_FALSE(child.is_cancellation_requested());
+
+    parent.cancel();
+    EXPECT_TRUE(child.is_cancellation_requested());
+    EXPECT_TRUE(grandchild.is_cancellation_requested());
+    EXPECT_EQ(calls.load(), 1);
+}
+
+// 4. 测试截止时间：到期后令牌报告已取消，子源继承较早的截止时间
+TEST(CancellationTest, DeadlineExpires) {
+    auto source = cppthreadflow::CancellationSource::with_timeout(50ms);
+    auto token = source.token();
+    EXPECT_TRUE(token.has_deadline());
+    EXPECT_FALSE(token.is_cancellation_requested());
+
+    cppthreadflow::CancellationSource child(token, cppthreadflow::CancellationToken::Clock::now() + 1h);
+    EXPECT_EQ(child.token().deadline(), token.deadline());
+
+    std::this_thread::sleep_for(80ms);
+    EXPECT_TRUE(token.is_cancellation_requested());
+    EXPECT_TRUE(child.is_cancellation_requested());
+}
+
+// 5. 测试默认构造的令牌永远不会被取消
+TEST(CancellationTest, DefaultTokenNeverCancels) {
+    cppthreadflow::CancellationToken token;
+    EXPECT_FALSE(token.can_be_cancelled());
+    EXPECT_FALSE(token.has_deadline());
+    EXPECT_FALSE(token.is_cancellation_requested());
+    EXPECT_NO_THROW(token.throw_if_cancellation_requested());
+
+    bool called = false;
+    auto registration = token.register_callback([&called]() { called = true; });
+    EXPECT_FALSE(called);
+}
+
+// 6. 测试注销会等待正在另一个线程中执行的回调结束
+TEST(CancellationTest, UnregisterWaitsForRunningCallback) {
+    cppthreadflow::CancellationSource source;
+    std::atomic<bool> entered(false);
+    std::atomic<bool> finished(false);
+
+    auto registration = source.token().register_callback([&]() {
+        entered = true;
+        std::this_thread::sleep_for(50ms);
+        finished = true;
+    });
+
+    std::thread canceller([&source]() { source.cancel(); });
+    while (!entered) {
+        std::this_thread::yield();
+    }
+    registration.unregister();
+    EXPECT_TRUE(finished.load());
+    canceller.join();
+}
@@ -0,0 +1,156 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/channel.hpp"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// 1. 测试缓冲通道：缓冲区未满时 send 不阻塞，按 FIFO 顺序接收
+TEST(ChannelTest, BufferedSendRecv) {
+    cppthreadflow::Channel<int> channel(3);
+    EXPECT_EQ(channel.capacity(), 3u);
+
+    EXPECT_TRUE(channel.send(1));
+    EXPECT_TRUE(channel.send(2));
+    int value = 3;
+    EXPECT_TRUE(channel.try_send(value));
+    EXPECT_EQ(channel.size(), 3u);
+
+    value = 4;
+    EXPECT_FALSE(channel.try_send(value)); // 缓冲区已满
+    EXPECT_EQ(value, 4);                   // 发送失败时值不会被移走
+
+    int out = 0;
+    for (int expected = 1; expected <= 3; ++expected) {
+        ASSERT_TRUE(channel.try_recv(out));
+        EXPECT_EQ(out, expected);
+    }
+    EXPECT_FALSE(channel.try_recv(out));
+}
+
+// 2. 测试无缓冲通道：send 阻塞到接收者取走值为止
+TEST(ChannelTest, RendezvousHandsOffDirectly) {
+    cppthreadflow::Channel<std::string> channel;
+    std::string value = "hello";
+    EXPECT_FALSE(channel.try_send(value)); // 没有接收者
+
+    std::atomic<bool> sent(false);
+    std::thread sender([&]() {
+        EXPECT_TRUE(channel.send("ping"));
+        sent = true;
+    });
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(sent.load()); // 仍在等待接收者
+    std::string out;
+    ASSERT_TRUE(channel.recv(out));
+    EXPECT_EQ(out, "ping");
+    sender.join();
+    EXPECT_TRUE(sent.load());
+}
+
+// 3. 测试关闭语义：唤醒阻塞的接收者，缓冲区中的值仍可取出
+TEST(ChannelTest, CloseWakesWaitersAndDrainsBuffer) {
+    cppthreadflow::Channel<int> empty_channel;
+    std::thread receiver([&]() {
+        int out = 0;
+        EXPECT_FALSE(empty_channel.recv(out));
+    });
+    std::this_thread::sleep_for(20ms);
+    empty_channel.close();
+    receiver.join();
+    EXPECT_TRUE(empty_channel.is_closed());
+    EXPECT_FALSE(empty_channel.send(1));
+
+    cppthreadflow::Channel<int> buffered(4);
+    buffered.send(1);
+    buffered.send(2);
+    buffered.close();
+    int out = 0;
+    ASSERT_TRUE(buffered.recv(out));
+    EXPECT_EQ(out, 1);
+    ASSERT_TRUE(buffered.recv(out));
+    EXPECT_EQ(out, 2);
+    EXPECT_FALSE(buffered.recv(out));
+}
+
+// 4. 测试 select：在多个不同类型的通道上等待，返回就绪分支的下标
+TEST(ChannelTest, SelectWaitsOnHeterogeneousChannels) {
+    cppthreadflow::Channel<int> numbers;
+    cppthreadflow::Channel<std::string> words;
+
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(20ms);
+        words.send("event");
+    });
+
+    int number = 0;
+    std::string word;
+    int index = cppthreadflow::select(cppthreadflow::on_recv(numbers, number),
+                                      cppthreadflow::on_recv(words, word));
+    EXPECT_EQ(index, 1);
+    EXPECT_EQ(word, "event");
+    producer.join();
+
+    // select 返回后，另一个通道上的登记已被撤销
+    int value = 5;
+    EXPECT_FALSE(numbers.try_send(value));
+}
+
+// 5. 测试 select_for 的超时，以及超时为 0 时的非阻塞轮询
+TEST(ChannelTest, SelectForTimesOut) {
+    cppthreadflow::Channel<int> a;
+    cppthreadflow::Channel<int> b(1);
+    int out = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    int index = cppthreadflow::select_for(30ms, cppthreadflow::on_recv(a, out),
+                                          cppthreadflow::on_recv(b, out));
+    EXPECT_EQ(index, cppthreadflow::kSelectTimeout);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 30ms);
+
+    int value = 9;
+    index = cppthreadflow::select_for(0ms, cppthreadflow::on_recv(a, out),
+                                      cppthreadflow::on_send(b, value));
+    EXPECT_EQ(index, 1); // b 的缓冲区有空位
+    ASSERT_TRUE(b.try_recv(out));
+    EXPECT_EQ(out, 9);
+}
+
+// 6. 扇入压力测试：多个生产者，一个线程通过 select 接收所有值
+TEST(ChannelTest, ConcurrentFanIn) {
+    const int num_producers = 4;
+    const int items_per_producer = 5000;
+    cppthreadflow::Channel<int> unbuffered;
+    cppthreadflow::Channel<int> buffered(16);
+    std::vector<std::thread> producers;
+
+    for (int i = 0; i < num_producers; ++i) {
+        producers.emplace_back([&, i]() {
+            auto& channel = (i % 2 == 0) ? unbuffered : buffered;
+            for (int j = 1; j <= items_per_producer; ++j) {
+                channel.send(j);
+            }
+        });
+    }
+
+    long long sum = 0;
+    int received = 0;
+    while (received < num_producers * items_per_producer) {
+        int value = 0;
+        cppthreadflow::select(cppthreadflow::on_recv(unbuffered, value),
+                              cppthreadflow::on_recv(buffered, value));
+        sum += value;
+        ++received;
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+
+    const long long per_producer =
+        static_cast<long long>(items_per_producer) * (items_per_producer + 1) / 2;
+    EXPECT_EQ(sum, per_producer * num_producers);
+}
@@ -0,0 +1,179 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/concurrent_cache.hpp"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// 1. 测试基本的 put/get 与容量上限
+TEST(ConcurrentCacheTest, PutGetAndCapacity) {
+    cppthreadflow::ConcurrentCache<int, std::string> cache(100, 4);
+
+    cache.put(1, "one");
+    std::string value;
+    ASSERT_TRUE(cache.get(1, value));
+    EXPECT_EQ(value, "one");
+    EXPECT_FALSE(cache.get(2, value));
+
+    for (int i = 0; i < 1000; ++i) {
+        cache.put(i, std::to_string(i));
+    }
+    // 条目数永远不会超过容量
+    EXPECT_LE(cache.size(), cache.capacity());
+    EXPECT_GT(cache.stats().evictions, 0u);
+}
+
+// 2. 测试 CLOCK 淘汰：被访问过的条目获得第二次机会
+TEST(ConcurrentCacheTest, ClockGivesReferencedEntriesSecondChance) {
+    // 单分片，便于确定淘汰顺序
+    cppthreadflow::ConcurrentCache<std::string, int> cache(3, 1);
+    cache.put("a", 1);
+    cache.put("b", 2);
+    cache.put("c", 3);
+
+    int value = 0;
+    ASSERT_TRUE(cache.get("a", value)); // 设置 a 的引用位
+
+    cache.put("d", 4); // 需要淘汰一个条目：a 被跳过，b 被淘汰
+    EXPECT_TRUE(cache.get("a", value));
+    EXPECT_FALSE(cache.get("b", value));
+    EXPECT_TRUE(cache.get("c", value));
+    EXPECT_TRUE(cache.get("d", value));
+    EXPECT_EQ(cache.stats().evictions, 1u);
+}
+
+// 3. 测试按权重计算容量
+TEST(ConcurrentCacheTest, WeightBasedCapacity) {
+    cppthreadflow::ConcurrentCache<int, std::string> cache(
+        100, 1, [](const int&, const std::string& v) { return v.size(); });
+
+    cache.put(1, std::string(40, 'x'));
+    cache.put(2, std::string(40, 'y'));
+    EXPECT_EQ(cache.stats().weight, 80u);
+
+    cache.put(3, std::string(40, 'z')); // 超过 100，需要淘汰
+    auto stats = cache.stats();
+    EXPECT_LE(stats.weight, 100u);
+    EXPECT_EQ(stats.size, 2u);
+
+    // 单个条目超过容量时不会被缓存
+    cache.put(4, std::string(200, 'w'));
+    std::string value;
+    EXPECT_FALSE(cache.get(4, value));
+}
+
+// 4. 测试命中/未命中统计与 erase
+TEST(ConcurrentCacheTest, StatsAndErase) {
+    cppthreadflow::ConcurrentCache<int, int> cache(10, 1);
+    cache.put(1, 10);
+
+    int value = 0;
+    cache.get(1, value);
+    cache.get(1, value);
+    cache.get(2, value);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 1u);
+
+    EXPECT_TRUE(cache.erase(1));
+    EXPECT_FALSE(cache.erase(1));
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+// 5. 测试 get_or_load 合并同一个键的并发未命中
+TEST(ConcurrentCacheTest, GetOrLoadCoalescesConcurrentMisses) {
+    cppthreadflow::ConcurrentCache<int, int> cache(100, 4);
+    std::atomic<int> load_calls(0);
+    const int num_threads = 8;
+    std::vector<std::thread> threads;
+    std::vector<int> results(num_threads);
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i]() {
+            results[i] = cache.get_or_load(42, [&](const int& key) {
+                load_calls++;
+                std::this_thread::sleep_for(100ms); // 模拟慢速加载
+                return key * 2;
+            });
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(load_calls.load(), 1);
+    for (int r : results) {
+        EXPECT_EQ(r, 84);
+    }
+    EXPECT_EQ(cache.stats().loads, 1u);
+
+    // 之后的访问直接命中
+    EXPECT_EQ(cache.get_or_load(42, [](const int&) { return -1; }), 84);
+}
+
+// 6. 测试加载失败时异常被传播，且结果不会被缓存
+TEST(ConcurrentCacheTest, GetOrLoadPropagatesExceptions) {
+    cppthreadflow::ConcurrentCache<int, int> cache(100, 1);
+
+    EXPECT_THROW(cache.get_or_load(1, [](const int&) -> int {
+        throw std::runtime_error("load failed");
+    }), std::runtime_error);
+
+    int value = 0;
+    EXPECT_FALSE(cache.get(1, value));
+    // 失败之后可以重新加载
+    EXPECT_EQ(cache.get_or_load(1, [](const int&) { return 7; }), 7);
+}
+
+// 7. 并发读写压力测试
+TEST(ConcurrentCacheTest, ConcurrentMixedWorkload) {
+    cppthreadflow::ConcurrentCache<int, int> cache(256, 8);
+    const int num_threads = 8;
+    const int ops_per_thread = 20000;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i]() {
+            for (int j = 0; j < ops_per_thread; ++j) {
+                int key = (j * 31 + i) % 1024;
+                int value = 0;
+                if (j % 4 == 0) {
+                    cache.put(key, key);
+                } else if (cache.get(key, value)) {
+                    EXPECT_EQ(value, key);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_LE(cache.size(), cache.capacity());
+}
+
+// 8. 测试加载期间的 put/erase 使加载失效，加载的旧值不会覆盖它们
+TEST(ConcurrentCacheTest, PutOrEraseDuringLoadWins) {
+    cppthreadflow::ConcurrentCache<int, int> cache(100, 1);
+
+    // 慢速加载期间写入了新值：调用者拿到加载的值，缓存保留 put 的值
+    EXPECT_EQ(cache.get_or_load(1, [&](const int&) {
+        cache.put(1, 100);
+        return 1;
+    }), 1);
+    int value = 0;
+    ASSERT_TRUE(cache.get(1, value));
+    EXPECT_EQ(value, 100);
+
+    // 加载期间键被删除：加载的值不写入缓存
+    EXPECT_EQ(cache.get_or_load(2, [&](const int&) {
+        cache.erase(2);
+        return 2;
+    }), 2);
+    EXPECT_FALSE(cache.get(2, value));
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <atomic>
+#include <algorithm>
 
 // 1. 測試基本的單線程操作 (Insert, Find)
 TEST(ConcurrentHashMapTest, BasicInsertAndFind) {
@@ -168,4 +169,259 @@ TEST(ConcurrentHashMapTest, ConcurrentMixedWorkload) {
     // 2. 檢測是否存在內存訪問沖突 (Data Race) -> 需要用 ThreadSanitizer 運行。
     // 3. 檢測是否崩潰 (Crash) -> 如果程序沒崩潰，就通過。
     SUCCEED() << "Chaos test completed without deadlock or crash.";
-}
\ No newline at end of file
+}
+
+// 8. 測試 insert_or_assign 和 try_emplace 的返回值與語義
+TEST(ConcurrentHashMapTest, InsertOrAssignAndTryEmplace) {
+    cppthreadflow::ConcurrentHashMap<int, std::string> map(4);
+
+    EXPECT_TRUE(map.insert_or_assign(1, "one"));
+    EXPECT_FALSE(map.insert_or_assign(1, "uno")); // 覆蓋已有的值
+
+    std::string value;
+    ASSERT_TRUE(map.find(1, value));
+    EXPECT_EQ(value, "uno");
+
+    EXPECT_TRUE(map.try_emplace(2, 3, 'x'));      // 原地構造 "xxx"
+    EXPECT_FALSE(map.try_emplace(2, "ignored"));  // 已存在，不覆蓋
+    ASSERT_TRUE(map.find(2, value));
+    EXPECT_EQ(value, "xxx");
+}
+
+// 9. 測試 compute_if_absent 只在鍵不存在時調用計算函數
+TEST(ConcurrentHashMapTest, ComputeIfAbsent) {
+    cppthreadflow::ConcurrentHashMap<int, int> map(4);
+    int calls = 0;
+
+    EXPECT_EQ(map.compute_if_absent(7, [&] { ++calls; return 49; }), 49);
+    EXPECT_EQ(map.compute_if_absent(7, [&] { ++calls; return 0; }), 49);
+    EXPECT_EQ(calls, 1);
+}
+
+// 10. 測試 update、upsert 和 erase_if
+TEST(ConcurrentHashMapTest, UpdateUpsertAndEraseIf) {
+    cppthreadflow::ConcurrentHashMap<int, std::vector<int>> map(4);
+
+    // update 對不存在的鍵無效
+    EXPECT_FALSE(map.update(1, [](std::vector<int>& v) { v.push_back(0); }));
+
+    // upsert：第一次插入默認值，之後原地追加
+    auto append = [](std::vector<int>& v) { v.push_back(2); };
+    EXPECT_TRUE(map.upsert(1, append, std::vector<int>{1}));
+    EXPECT_FALSE(map.upsert(1, append, std::vector<int>{}));
+    EXPECT_TRUE(map.update(1, [](std::vector<int>& v) { v.push_back(3); }));
+
+    std::vector<int> value;
+    ASSERT_TRUE(map.find(1, value));
+    EXPECT_EQ(value, (std::vector<int>{1, 2, 3}));
+
+    // erase_if：謂詞不滿足時不刪除
+    EXPECT_FALSE(map.erase_if(1, [](const std::vector<int>& v) { return v.size() > 3; }));
+    EXPECT_TRUE(map.erase_if(1, [](const std::vector<int>& v) { return v.size() == 3; }));
+    EXPECT_FALSE(map.find(1, value));
+}
+
+// 11. 並發計數測試：upsert 的讀-改-寫是原子的，不會丟失更新
+TEST(ConcurrentHashMapTest, ConcurrentUpsertCounter) {
+    const int num_threads = 8;
+    const int increments_per_thread = 10000;
+    const int key_range = 16;
+    cppthreadflow::ConcurrentHashMap<int, long> map(4);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&map]() {
+            for (int j = 0; j < increments_per_thread; ++j) {
+                map.upsert(j % key_range, [](long& v) { ++v; }, 1L);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    long total = 0;
+    for (int key = 0; key < key_range; ++key) {
+        long value = 0;
+        ASSERT_TRUE(map.find(key, value));
+        total += value;
+    }
+    EXPECT_EQ(total, static_cast<long>(num_threads) * increments_per_thread);
+}
+
+// 12. 測試 visit/cvisit 在鎖內直接訪問值，不拷貝
+TEST(ConcurrentHashMapTest, VisitWithoutCopy) {
+    cppthreadflow::ConcurrentHashMap<int, std::unique_ptr<int>> map(4);
+    map.insert(1, std::make_unique<int>(10));
+
+    // move-only 的值無法通過 find 拷貝出來，但可以被訪問
+    int observed = 0;
+    EXPECT_TRUE(map.cvisit(1, [&](const std::unique_ptr<int>& p) { observed = *p; }));
+    EXPECT_EQ(observed, 10);
+
+    EXPECT_TRUE(map.visit(1, [](std::unique_ptr<int>& p) { *p += 5; }));
+    EXPECT_TRUE(map.cvisit(1, [&](const std::unique_ptr<int>& p) { observed = *p; }));
+    EXPECT_EQ(observed, 15);
+
+    EXPECT_FALSE(map.visit(2, [](std::unique_ptr<int>&) { FAIL(); }));
+}
+
+// 13. 測試使用 string_view 進行異構查找
+TEST(ConcurrentHashMapTest, HeterogeneousLookup) {
+    cppthreadflow::ConcurrentHashMap<std::string, int,
+                                     cppthreadflow::TransparentStringHash,
+                                     std::equal_to<>> map(4);
+    map.insert("alpha", 1);
+    map.insert("beta", 2);
+
+    std::string_view key = "alpha";
+    int value = 0;
+    ASSERT_TRUE(map.find(key, value));
+    EXPECT_EQ(value, 1);
+
+    EXPECT_TRUE(map.visit(std::string_view("beta"), [](int& v) { v *= 10; }));
+    EXPECT_TRUE(map.cvisit(std::string_view("beta"), [&](const int& v) { value = v; }));
+    EXPECT_EQ(value, 20);
+
+    EXPECT_FALSE(map.find(std::string_view("gamma"), value));
+}
+
+// 14. 測試批量插入與預分配
+TEST(ConcurrentHashMapTest, InsertBulkAndReserve) {
+    cppthreadflow::ConcurrentHashMap<int, std::string> map(8);
+    map.reserve(1000);
+
+    std::vector<std::pair<int, std::string>> items;
+    for (int i = 0; i < 1000; ++i) {
+        items.emplace_back(i, std::to_string(i));
+    }
+    map.insert_bulk(items.begin(), items.end());
+    EXPECT_EQ(map.size(), 1000u);
+
+    // 使用 move_iterator 時值被移動，已有的鍵被覆蓋
+    std::vector<std::pair<int, std::string>> updates = {{1, "one"}, {2000, "two thousand"}};
+    map.insert_bulk(std::make_move_iterator(updates.begin()),
+                    std::make_move_iterator(updates.end()));
+    EXPECT_TRUE(updates[0].second.empty());
+    EXPECT_EQ(map.size(), 1001u);
+
+    std::string value;
+    ASSERT_TRUE(map.find(1, value));
+    EXPECT_EQ(value, "one");
+    ASSERT_TRUE(map.find(999, value));
+    EXPECT_EQ(value, "999");
+}
+
+// 15. 測試 for_each 遍歷與按條件批量刪除
+TEST(ConcurrentHashMapTest, ForEachAndEraseIfPredicate) {
+    cppthreadflow::ConcurrentHashMap<int, int> map(4);
+    for (int i = 0; i < 100; ++i) {
+        map.insert(i, i);
+    }
+
+    // 可修改的遍歷
+    map.for_each([](const int&, int& v) { v *= 2; });
+
+    // 只讀遍歷
+    const auto& const_map = map;
+    long sum = 0;
+    const_map.for_each([&sum](const int&, const int& v) { sum += v; });
+    EXPECT_EQ(sum, 2L * (99 * 100 / 2));
+
+    // 刪除所有鍵為奇數的元素
+    EXPECT_EQ(map.erase_if([](const int& k, const int&) { return k % 2 == 1; }), 50u);
+    EXPECT_EQ(map.size(), 50u);
+}
+
+// 16. 測試在線程池上並行遍歷所有分片
+TEST(ConcurrentHashMapTest, ParallelForEach) {
+    cppthreadflow::ThreadPool pool(4);
+    cppthreadflow::ConcurrentHashMap<int, int> map(16);
+    const int count = 10000;
+    for (int i = 0; i < count; ++i) {
+        map.insert(i, 1);
+    }
+
+    std::atomic<int> visited(0);
+    map.parallel_for_each(pool, [&visited](const int&, int& v) {
+        v += 1;
+        visited++;
+    });
+    EXPECT_EQ(visited.load(), count);
+
+    long sum = 0;
+    map.for_each([&sum](const int&, int& v) { sum += v; });
+    EXPECT_EQ(sum, 2L * count);
+
+    // 遍歷函數拋出的異常會被重新拋出
+    EXPECT_THROW(map.parallel_for_each(pool, [](const int& k, int&) {
+        if (k == 42) throw std::runtime_error("boom");
+    }), std::runtime_error);
+}
+
+// 17. 測試分片數向上取整為 2 的冪，連續鍵均勻分布到各分片
+TEST(ConcurrentHashMapTest, PowerOfTwoShardsAndEvenDistribution) {
+    cppthreadflow::ConcurrentHashMap<int, int> odd_map(6);
+    EXPECT_EQ(odd_map.shard_count(), 8u);
+
+    cppthreadflow::ConcurrentHashMap<int, int> map(16);
+    const int count = 16000;
+    for (int i = 0; i < count; ++i) {
+        map.insert(i, i);
+    }
+
+    // 連續的整數鍵（std::hash<int> 為恆等函數）經過位混合後不應產生傾斜
+    size_t min_size = count, max_size = 0;
+    for (const auto& stats : map.shard_stats()) {
+        min_size = std::min(min_size, stats.size);
+        max_size = std::max(max_size, stats.size);
+    }
+    EXPECT_LT(max_size, min_size * 3 / 2);
+}
+
+// 18. 測試分片鎖統計
+TEST(ConcurrentHashMapTest, ShardLockStatistics) {
+    cppthreadflow::ConcurrentHashMap<int, int> map(4);
+    for (int i = 0; i < 100; ++i) {
+        map.insert(i, i);
+    }
+
+    uint64_t acquisitions = 0, contentions = 0;
+    for (const auto& stats : map.shard_stats()) {
+        acquisitions += stats.lock_acquisitions;
+        contentions += stats.lock_contentions;
+    }
+    // 單線程下每次插入獲取一次鎖，且不會發生爭用
+    EXPECT_EQ(acquisitions, 100u);
+    EXPECT_EQ(contentions, 0u);
+
+    map.reset_stats();
+    for (const auto& stats : map.shard_stats()) {
+        EXPECT_EQ(stats.lock_acquisitions, 0u);
+    }
+}
+
+// 19. 測試線程池拒絕提交時，parallel_for_each 等已提交的任務結束後才拋出
+TEST(ConcurrentHashMapTest, ParallelForEachWaitsWhenSubmitRejected) {
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.queue_capacity = 1;
+    options.overflow_policy = cppthreadflow::OverflowPolicy::kFailFast;
+    cppthreadflow::ThreadPool pool(options);
+    cppthreadflow::ConcurrentHashMap<int, int> map(16);
+    for (int i = 0; i < 64; ++i) {
+        map.insert(i, i);
+    }
+
+    std::atomic<int> calls(0);
+    EXPECT_THROW(map.parallel_for_each(pool, [&calls](const int&, int&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        calls++;
+    }), cppthreadflow::QueueFullError);
+
+    // 返回之後不再有任務調用 fn
+    const int calls_at_return = calls.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(calls.load(), calls_at_return);
+    EXPECT_GT(calls_at_return, 0);
+}
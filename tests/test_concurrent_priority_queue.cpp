@@ -0,0 +1,108 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/concurrent_priority_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using cppthreadflow::ConcurrentPriorityQueue;
+using cppthreadflow::PriorityOrdering;
+
+// 1. 测试严格模式下的出队顺序与 std::priority_queue 一致
+TEST(ConcurrentPriorityQueueTest, StrictModePopsInPriorityOrder) {
+    ConcurrentPriorityQueue<int> queue(PriorityOrdering::kStrict);
+    EXPECT_EQ(queue.queue_count(), 1u);
+
+    std::vector<int> values = {5, 1, 9, 3, 7, 2, 8};
+    for (int v : values) {
+        queue.push(v);
+    }
+    EXPECT_EQ(queue.size(), values.size());
+
+    std::vector<int> popped;
+    int value = 0;
+    while (queue.try_pop(value)) {
+        popped.push_back(value);
+    }
+    EXPECT_EQ(popped, (std::vector<int>{9, 8, 7, 5, 3, 2, 1}));
+    EXPECT_TRUE(queue.empty());
+}
+
+// 2. 测试自定义比较函数（最小堆）
+TEST(ConcurrentPriorityQueueTest, CustomComparator) {
+    ConcurrentPriorityQueue<int, std::greater<int> > queue(PriorityOrdering::kStrict);
+    for (int v : {4, 2, 6}) {
+        queue.push(v);
+    }
+    int value = 0;
+    ASSERT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, 2);
+}
+
+// 3. 测试宽松模式：元素不丢失，且出队顺序接近优先级顺序
+TEST(ConcurrentPriorityQueueTest, RelaxedModeIsApproximatelyOrdered) {
+    ConcurrentPriorityQueue<int> queue(PriorityOrdering::kRelaxed, 4);
+    EXPECT_EQ(queue.queue_count(), 4u);
+    const int count = 10000;
+    for (int i = 0; i < count; ++i) {
+        queue.push(i);
+    }
+
+    std::vector<int> popped;
+    int value = 0;
+    while (queue.try_pop(value)) {
+        popped.push_back(value);
+    }
+    ASSERT_EQ(popped.size(), static_cast<size_t>(count));
+
+    // 前 100 个出队的元素都应来自最高优先级的一小部分
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_GE(popped[i], count - 1000);
+    }
+    std::sort(popped.begin(), popped.end());
+    for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(popped[i], i);
+    }
+}
+
+// 4. 多生产者多消费者：每个元素恰好被取出一次
+TEST(ConcurrentPriorityQueueTest, ConcurrentProducersAndConsumers) {
+    ConcurrentPriorityQueue<int> queue;
+    const int num_producers = 8;
+    const int num_consumers = 8;
+    const int items_per_producer = 10000;
+    const int total = num_producers * items_per_producer;
+    std::atomic<int> consumed(0);
+    std::vector<std::atomic<int> > seen(total);
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < num_producers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < items_per_producer; ++i) {
+                queue.push(p * items_per_producer + i);
+            }
+        });
+    }
+    for (int c = 0; c < num_consumers; ++c) {
+        threads.emplace_back([&]() {
+            int value = 0;
+            while (consumed.load() < total) {
+                if (queue.try_pop(value)) {
+                    seen[value]++;
+                    consumed++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_TRUE(queue.empty());
+    for (int i = 0; i < total; ++i) {
+        EXPECT_EQ(seen[i].load(), 1);
+    }
+}
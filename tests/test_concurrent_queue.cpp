@@ -100,4 +100,146 @@ TEST(ConcurrentQueueTest, MPMCStressTest) {
     // 最终断言：生产和消费的物品数量必须相等
     EXPECT_EQ(items_produced, num_producers * items_per_producer);
     EXPECT_EQ(items_consumed, items_produced.load());
-}
\ No newline at end of file
+}
+// 测试非阻塞的 try_pop、size 与 empty
+TEST(ConcurrentQueueTest, TryPopSizeAndEmpty) {
+    cppthreadflow::ConcurrentQueue<int> q;
+    int val = 0;
+    EXPECT_TRUE(q.empty());
+    EXPECT_FALSE(q.try_pop(val));
+
+    q.push(1);
+    q.push(2);
+    EXPECT_EQ(q.size(), 2u);
+    EXPECT_FALSE(q.empty());
+
+    ASSERT_TRUE(q.try_pop(val));
+    EXPECT_EQ(val, 1);
+    EXPECT_EQ(q.size(), 1u);
+}
+
+// 测试带超时的 pop_for / pop_until
+TEST(ConcurrentQueueTest, TimedPop) {
+    using namespace std::chrono_literals;
+    cppthreadflow::ConcurrentQueue<int> q;
+    int val = 0;
+
+    // 队列为空时等待超时
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(q.pop_for(val, 50ms));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 50ms);
+
+    // 在超时前到达的元素可以被取出
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(20ms);
+        q.push(7);
+    });
+    EXPECT_TRUE(q.pop_until(val, std::chrono::steady_clock::now() + 2s));
+    EXPECT_EQ(val, 7);
+    producer.join();
+
+    // 队列停止后立即返回
+    q.stop();
+    start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(q.pop_for(val, 2s));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+}
+
+// 测试 pop_all 一次取出所有元素并保持顺序
+TEST(ConcurrentQueueTest, PopAllDrainsInOrder) {
+    cppthreadflow::ConcurrentQueue<int> q;
+    EXPECT_TRUE(q.pop_all().empty());
+
+    for (int i = 0; i < 5; ++i) {
+        q.push(i);
+    }
+    auto items = q.pop_all();
+    EXPECT_TRUE(q.empty());
+    ASSERT_EQ(items.size(), 5u);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(items.front(), i);
+        items.pop();
+    }
+}
+
+// 测试有界队列的各种溢出策略
+TEST(ConcurrentQueueTest, BoundedOverflowPolicies) {
+    using cppthreadflow::OverflowPolicy;
+    int val = 0;
+
+    cppthreadflow::ConcurrentQueue<int> fail_fast(2, OverflowPolicy::kFailFast);
+    EXPECT_TRUE(fail_fast.push(1));
+    EXPECT_TRUE(fail_fast.push(2));
+    EXPECT_FALSE(fail_fast.push(3));
+    EXPECT_EQ(fail_fast.size(), 2u);
+    EXPECT_EQ(fail_fast.overflow_stats().rejected, 1u);
+
+    cppthreadflow::ConcurrentQueue<int> drop_oldest(2, OverflowPolicy::kDropOldest);
+    drop_oldest.push(1);
+    drop_oldest.push(2);
+    EXPECT_TRUE(drop_oldest.push(3)); // 1 被丢弃
+    ASSERT_TRUE(drop_oldest.try_pop(val));
+    EXPECT_EQ(val, 2);
+    EXPECT_EQ(drop_oldest.overflow_stats().dropped, 1u);
+
+    cppthreadflow::ConcurrentQueue<int> drop_newest(2, OverflowPolicy::kDropNewest);
+    drop_newest.push(1);
+    drop_newest.push(2);
+    EXPECT_FALSE(drop_newest.push(3)); // 3 被丢弃
+    ASSERT_TRUE(drop_newest.try_pop(val));
+    EXPECT_EQ(val, 1);
+    EXPECT_EQ(drop_newest.overflow_stats().dropped, 1u);
+}
+
+// 测试 kBlock 策略：队列满时生产者阻塞，直到消费者腾出空位
+TEST(ConcurrentQueueTest, BoundedBlockAppliesBackpressure) {
+    using namespace std::chrono_literals;
+    cppthreadflow::ConcurrentQueue<int> q(1, cppthreadflow::OverflowPolicy::kBlock);
+    q.push(1);
+
+    std::atomic<bool> pushed(false);
+    std::thread producer([&]() {
+        EXPECT_TRUE(q.push(2));
+        pushed = true;
+        EXPECT_FALSE(q.push(3)); // 队列又满了，stop 后返回 false
+    });
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(pushed);
+
+    int val = 0;
+    ASSERT_TRUE(q.pop(val));
+    EXPECT_EQ(val, 1);
+    while (!pushed) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(20ms);
+    q.stop();
+    producer.join();
+
+    auto stats = q.overflow_stats();
+    EXPECT_EQ(stats.blocked_pushes, 2u);
+    EXPECT_GE(stats.blocked_time, 50ms);
+    EXPECT_EQ(q.size(), 1u);
+}
+
+// 测试带令牌的 pop：取消或到达截止时间时返回 false
+TEST(ConcurrentQueueTest, PopWithTokenIsCancellable) {
+    using namespace std::chrono_literals;
+    cppthreadflow::ConcurrentQueue<int> q;
+    cppthreadflow::CancellationSource source;
+    int val = 0;
+
+    std::thread canceller([&source]() {
+        std::this_thread::sleep_for(30ms);
+        source.cancel();
+    });
+    EXPECT_FALSE(q.pop(val, source.token()));
+    canceller.join();
+
+    auto timed = cppthreadflow::CancellationSource::with_timeout(20ms);
+    EXPECT_FALSE(q.pop(val, timed.token()));
+
+    q.push(5);
+    EXPECT_TRUE(q.pop(val, cppthreadflow::CancellationToken()));
+    EXPECT_EQ(val, 5);
+}
@@ -0,0 +1,177 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/concurrent_skip_list.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 1. 测试基本的单线程操作 (Insert, Find, Erase)
+TEST(ConcurrentSkipListTest, BasicOperations) {
+    cppthreadflow::ConcurrentSkipListMap<int, std::string> map;
+    EXPECT_TRUE(map.empty());
+
+    EXPECT_TRUE(map.insert(2, "two"));
+    EXPECT_TRUE(map.insert(1, "one"));
+    EXPECT_FALSE(map.insert(1, "uno")); // 不覆盖已存在的键
+    EXPECT_EQ(map.size(), 2u);
+
+    std::string value;
+    ASSERT_TRUE(map.find(1, value));
+    EXPECT_EQ(value, "one");
+    EXPECT_TRUE(map.contains(2));
+    EXPECT_FALSE(map.find(3, value));
+
+    EXPECT_TRUE(map.erase(1));
+    EXPECT_FALSE(map.erase(1));
+    EXPECT_FALSE(map.contains(1));
+    EXPECT_EQ(map.size(), 1u);
+
+    // 删除后可以重新插入
+    EXPECT_TRUE(map.insert(1, "again"));
+    ASSERT_TRUE(map.find(1, value));
+    EXPECT_EQ(value, "again");
+}
+
+// 2. 测试有序遍历、lower_bound 与区间查询
+TEST(ConcurrentSkipListTest, OrderedTraversalAndRangeQueries) {
+    cppthreadflow::ConcurrentSkipListMap<int, int> map;
+    for (int i = 100; i > 0; --i) {
+        map.insert(i * 10, i);
+    }
+
+    std::vector<int> keys;
+    map.for_each([&keys](const int& key, const int&) { keys.push_back(key); });
+    ASSERT_EQ(keys.size(), 100u);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+
+    int key = 0, value = 0;
+    ASSERT_TRUE(map.lower_bound(255, key, value));
+    EXPECT_EQ(key, 260);
+    EXPECT_EQ(value, 26);
+    ASSERT_TRUE(map.lower_bound(260, key, value));
+    EXPECT_EQ(key, 260);
+    EXPECT_FALSE(map.lower_bound(1001, key, value));
+
+    std::vector<int> range;
+    map.for_each_in_range(100, 150, [&range](const int& k, const int&) { range.push_back(k); });
+    EXPECT_EQ(range, (std::vector<int>{100, 110, 120, 130, 140}));
+
+    // 回调返回 false 时提前结束，例如取前 3 名
+    std::vector<int> top;
+    map.for_each([&top](const int& k, const int&) {
+        top.push_back(k);
+        return top.size() < 3;
+    });
+    EXPECT_EQ(top, (std::vector<int>{10, 20, 30}));
+}
+
+// 3. 测试自定义比较函数与有序集合
+TEST(ConcurrentSkipListTest, SetWithCustomComparator) {
+    cppthreadflow::ConcurrentSkipListSet<int, std::greater<int> > set;
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(set.insert(i));
+    }
+    EXPECT_FALSE(set.insert(5));
+    EXPECT_TRUE(set.erase(5));
+    EXPECT_FALSE(set.contains(5));
+
+    std::vector<int> values;
+    set.for_each([&values](const int& v) { values.push_back(v); });
+    EXPECT_EQ(values, (std::vector<int>{9, 8, 7, 6, 4, 3, 2, 1, 0}));
+
+    int found = -1;
+    ASSERT_TRUE(set.lower_bound(5, found)); // 降序下第一个“不小于” 5 的是 4
+    EXPECT_EQ(found, 4);
+}
+
+// 4. 并发插入测试：每个键只有一个线程能插入成功
+TEST(ConcurrentSkipListTest, ConcurrentInsert) {
+    const int num_threads = 8;
+    const int key_range = 20000;
+    cppthreadflow::ConcurrentSkipListMap<int, int> map;
+    std::atomic<int> successes(0);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i]() {
+            for (int j = 0; j < key_range; ++j) {
+                int key = (j * 7919 + i * 131) % key_range;
+                if (map.insert(key, key * 2)) {
+                    successes++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(successes.load(), key_range);
+    EXPECT_EQ(map.size(), static_cast<size_t>(key_range));
+    int expected = 0;
+    map.for_each([&expected](const int& key, const int& value) {
+        EXPECT_EQ(key, expected);
+        EXPECT_EQ(value, key * 2);
+        expected++;
+    });
+    EXPECT_EQ(expected, key_range);
+}
+
+// 5. 并发读写混合测试：遍历始终有序，最终计数一致
+TEST(ConcurrentSkipListTest, ConcurrentMixedWorkload) {
+    const int num_threads = 8;
+    const int ops_per_thread = 20000;
+    const int key_range = 1000;
+    cppthreadflow::ConcurrentSkipListMap<int, int> map;
+    std::atomic<int> inserted(0);
+    std::atomic<int> erased(0);
+    std::atomic<bool> done(false);
+    std::vector<std::thread> threads;
+
+    // 一个扫描线程在修改期间持续做范围遍历
+    std::thread scanner([&]() {
+        while (!done.load()) {
+            int last = -1;
+            map.for_each_in_range(100, 900, [&last](const int& key, const int& value) {
+                EXPECT_GT(key, last);
+                EXPECT_EQ(value, key);
+                last = key;
+            });
+        }
+    });
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i]() {
+            for (int j = 0; j < ops_per_thread; ++j) {
+                int key = (j * 7 + i) % key_range;
+                switch (j % 3) {
+                    case 0:
+                        if (map.insert(key, key)) inserted++;
+                        break;
+                    case 1: {
+                        int value = -1;
+                        if (map.find(key, value)) {
+                            EXPECT_EQ(value, key);
+                        }
+                        break;
+                    }
+                    case 2:
+                        if (map.erase(key)) erased++;
+                        break;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    done.store(true);
+    scanner.join();
+
+    EXPECT_EQ(map.size(), static_cast<size_t>(inserted.load() - erased.load()));
+    size_t found = 0;
+    map.for_each([&found](const int&, const int&) { found++; });
+    EXPECT_EQ(found, map.size());
+}
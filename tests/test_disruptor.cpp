@@ -0,0 +1,138 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/disruptor.hpp"
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct Event {
+    std::int64_t value = 0;
+    int stage = 0; // 由上游消费者写入，下游消费者读取
+};
+
+} // namespace
+
+// 1. 测试单个消费者按顺序收到所有事件
+TEST(DisruptorTest, SingleConsumerReceivesAllInOrder) {
+    cppthreadflow::Disruptor<Event> disruptor(8);
+    std::vector<std::int64_t> received;
+    disruptor.add_consumer([&](Event& event, std::int64_t sequence, bool) {
+        EXPECT_EQ(event.value, sequence * 10);
+        received.push_back(event.value);
+    });
+    disruptor.start();
+
+    const int count = 100; // 远大于容量，覆盖环绕与生产者等待
+    for (int i = 0; i < count; ++i) {
+        disruptor.publish_event([i](Event& event) { event.value = i * 10; });
+    }
+    disruptor.shutdown();
+
+    ASSERT_EQ(received.size(), static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(received[i], i * 10);
+    }
+    EXPECT_EQ(disruptor.cursor(), count - 1);
+}
+
+// 2. 测试多个消费者都能收到每个事件，且依赖关系得到保证
+TEST(DisruptorTest, DependentConsumerSeesUpstreamResults) {
+    cppthreadflow::Disruptor<Event> disruptor(16, cppthreadflow::WaitStrategy::kYield);
+    std::atomic<std::int64_t> fan_out_sum(0);
+    std::atomic<int> ordering_violations(0);
+    std::int64_t downstream_sum = 0;
+
+    auto& upstream = disruptor.add_consumer([](Event& event, std::int64_t, bool) {
+        event.stage = 1;
+    });
+    disruptor.add_consumer([&](Event& event, std::int64_t, bool) {
+        fan_out_sum += event.value;
+    });
+    disruptor.add_consumer([&](Event& event, std::int64_t, bool) {
+        if (event.stage != 1) {
+            ordering_violations++;
+        }
+        downstream_sum += event.value;
+    }, {&upstream});
+    disruptor.start();
+
+    const int count = 20000;
+    for (int i = 1; i <= count; ++i) {
+        disruptor.publish_event([i](Event& event) {
+            event.value = i;
+            event.stage = 0;
+        });
+    }
+    disruptor.shutdown();
+
+    const std::int64_t expected = static_cast<std::int64_t>(count) * (count + 1) / 2;
+    EXPECT_EQ(fan_out_sum.load(), expected);
+    EXPECT_EQ(downstream_sum, expected);
+    EXPECT_EQ(ordering_violations.load(), 0);
+}
+
+// 3. 测试批量发布与 end_of_batch 标记
+TEST(DisruptorTest, BatchPublishAndEndOfBatch) {
+    cppthreadflow::Disruptor<Event> disruptor(64);
+    std::atomic<int> events(0);
+    std::atomic<int> batches(0);
+    disruptor.add_consumer([&](Event&, std::int64_t, bool end_of_batch) {
+        events++;
+        if (end_of_batch) {
+            batches++;
+        }
+    });
+
+    // 启动前发布一整批：消费者启动后一次取走全部事件
+    disruptor.publish_events(32, [](Event& event, size_t i) {
+        event.value = static_cast<std::int64_t>(i);
+    });
+    disruptor.start();
+    disruptor.shutdown();
+
+    EXPECT_EQ(events.load(), 32);
+    EXPECT_EQ(batches.load(), 1);
+    EXPECT_THROW(disruptor.claim(disruptor.capacity() + 1), std::invalid_argument);
+}
+
+// 4. 测试各种等待策略在小容量、多消费者下都能正确完成
+TEST(DisruptorTest, AllWaitStrategies) {
+    for (auto strategy : {cppthreadflow::WaitStrategy::kBusySpin,
+                          cppthreadflow::WaitStrategy::kYield,
+                          cppthreadflow::WaitStrategy::kBlocking}) {
+        // 单核机器上忙等的线程只能靠时间片轮转推进，因此忙等策略使用较大的容量
+        const size_t capacity =
+            strategy == cppthreadflow::WaitStrategy::kBusySpin ? 2048 : 4;
+        cppthreadflow::Disruptor<Event> disruptor(capacity, strategy);
+        std::atomic<std::int64_t> first_sum(0);
+        std::atomic<std::int64_t> second_sum(0);
+        auto& first = disruptor.add_consumer([&](Event& event, std::int64_t, bool) {
+            first_sum += event.value;
+        });
+        disruptor.add_consumer([&](Event& event, std::int64_t, bool) {
+            second_sum += event.value;
+        }, {&first});
+        disruptor.start();
+
+        const int count = 2000;
+        for (int i = 1; i <= count; ++i) {
+            disruptor.publish_event([i](Event& event) { event.value = i; });
+        }
+        disruptor.shutdown();
+
+        const std::int64_t expected = static_cast<std::int64_t>(count) * (count + 1) / 2;
+        EXPECT_EQ(first_sum.load(), expected);
+        EXPECT_EQ(second_sum.load(), expected);
+    }
+}
+
+// 5. 测试 add_consumer 必须在 start 之前调用
+TEST(DisruptorTest, AddConsumerAfterStartThrows) {
+    cppthreadflow::Disruptor<Event> disruptor;
+    disruptor.add_consumer([](Event&, std::int64_t, bool) {});
+    disruptor.start();
+    EXPECT_THROW(disruptor.add_consumer([](Event&, std::int64_t, bool) {}),
+                 std::logic_error);
+}
@@ -0,0 +1,113 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/distributed_shared_mutex.hpp"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// 1. 测试读者之间可以并发，写者独占
+TEST(DistributedSharedMutexTest, ReadersShareWritersExclude) {
+    cppthreadflow::DistributedSharedMutex mutex;
+    EXPECT_EQ(mutex.slot_count() & (mutex.slot_count() - 1), 0u); // 2 的幂
+
+    std::shared_lock<cppthreadflow::DistributedSharedMutex> first(mutex);
+    EXPECT_TRUE(mutex.try_lock_shared());
+    EXPECT_FALSE(mutex.try_lock());
+    mutex.unlock_shared();
+    first.unlock();
+
+    std::unique_lock<cppthreadflow::DistributedSharedMutex> writer(mutex);
+    auto reader = std::async(std::launch::async, [&mutex]() { return mutex.try_lock_shared(); });
+    EXPECT_FALSE(reader.get());
+    EXPECT_FALSE(std::async(std::launch::async, [&mutex]() { return mutex.try_lock(); }).get());
+}
+
+// 2. 测试写者等待已进入的读者退出，读者等待写者释放
+TEST(DistributedSharedMutexTest, WriterWaitsForReaders) {
+    for (auto preference : {cppthreadflow::RwPreference::kWriter, cppthreadflow::RwPreference::kReader}) {
+        cppthreadflow::DistributedSharedMutex mutex(preference);
+        std::atomic<bool> written(false);
+
+        mutex.lock_shared();
+        std::thread writer([&]() {
+            std::lock_guard<cppthreadflow::DistributedSharedMutex> lock(mutex);
+            written = true;
+        });
+        std::this_thread::sleep_for(30ms);
+        EXPECT_FALSE(written.load());
+        mutex.unlock_shared();
+        writer.join();
+        EXPECT_TRUE(written.load());
+
+        mutex.lock();
+        auto reader = std::async(std::launch::async, [&]() {
+            std::shared_lock<cppthreadflow::DistributedSharedMutex> lock(mutex);
+            return written.load();
+        });
+        EXPECT_EQ(reader.wait_for(30ms), std::future_status::timeout);
+        mutex.unlock();
+        EXPECT_TRUE(reader.get());
+    }
+}
+
+// 3. 测试写者优先：写者开始等待后，新来的读者让路
+TEST(DistributedSharedMutexTest, WriterPreferenceBlocksNewReaders) {
+    cppthreadflow::DistributedSharedMutex mutex(cppthreadflow::RwPreference::kWriter);
+    mutex.lock_shared();
+    std::thread writer([&]() {
+        mutex.lock();
+        mutex.unlock();
+    });
+    std::this_thread::sleep_for(30ms);
+    // 另一个线程上的新读者不能插到等待的写者前面
+    EXPECT_FALSE(std::async(std::launch::async, [&mutex]() {
+        if (mutex.try_lock_shared()) {
+            mutex.unlock_shared();
+            return true;
+        }
+        return false;
+    }).get());
+    mutex.unlock_shared();
+    writer.join();
+}
+
+// 4. 压力测试：多个读者与写者并发，读者看到的两个字段始终一致
+TEST(DistributedSharedMutexTest, ConcurrentReadersAndWriters) {
+    for (auto preference : {cppthreadflow::RwPreference::kWriter, cppthreadflow::RwPreference::kReader}) {
+        cppthreadflow::DistributedSharedMutex mutex(preference, 4);
+        long a = 0;
+        long b = 0;
+        std::atomic<bool> inconsistent(false);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 2000; ++i) {
+                    std::shared_lock<cppthreadflow::DistributedSharedMutex> lock(mutex);
+                    if (a != b) {
+                        inconsistent = true;
+                    }
+                }
+            });
+        }
+        for (int t = 0; t < 2; ++t) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 500; ++i) {
+                    std::lock_guard<cppthreadflow::DistributedSharedMutex> lock(mutex);
+                    ++a;
+                    ++b;
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        EXPECT_FALSE(inconsistent.load());
+        EXPECT_EQ(a, 1000);
+        EXPECT_EQ(b, 1000);
+    }
+}
@@ -0,0 +1,160 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/epoch_reclaimer.hpp"
+#include "../src/ThreadLib/thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// 析构时计数的测试对象
+struct Tracked {
+    explicit Tracked(std::atomic<int>& counter, int v = 0) : destroyed(counter), value(v) {}
+    ~Tracked() { destroyed++; }
+    std::atomic<int>& destroyed;
+    int value;
+};
+
+// 反复推进纪元并回收，直到条件满足或超时
+template <typename Pred>
+bool collect_until(Pred pred) {
+    auto& reclaimer = cppthreadflow::EpochReclaimer::instance();
+    for (int i = 0; i < 1000 && !pred(); ++i) {
+        reclaimer.collect();
+        std::this_thread::sleep_for(1ms);
+    }
+    return pred();
+}
+
+} // namespace
+
+// 1. 测试守卫的进入与离开（包括嵌套）
+TEST(EpochReclaimerTest, GuardEntersAndLeaves) {
+    auto& reclaimer = cppthreadflow::EpochReclaimer::instance();
+    EXPECT_FALSE(reclaimer.in_critical_section());
+    {
+        cppthreadflow::EpochGuard outer;
+        EXPECT_TRUE(reclaimer.in_critical_section());
+        {
+            cppthreadflow::EpochGuard inner;
+            EXPECT_TRUE(reclaimer.in_critical_section());
+        }
+        // 内层离开后仍处于外层临界区
+        EXPECT_TRUE(reclaimer.in_critical_section());
+    }
+    EXPECT_FALSE(reclaimer.in_critical_section());
+}
+
+// 2. 测试退休的节点最终会被释放
+TEST(EpochReclaimerTest, RetiredObjectIsEventuallyFreed) {
+    std::atomic<int> destroyed(0);
+    auto& reclaimer = cppthreadflow::EpochReclaimer::instance();
+
+    reclaimer.retire(new Tracked(destroyed));
+    EXPECT_TRUE(collect_until([&] { return destroyed.load() == 1; }));
+}
+
+// 3. 测试其他线程处于临界区时，节点不会被提前释放
+TEST(EpochReclaimerTest, PinnedReaderBlocksReclamation) {
+    std::atomic<int> destroyed(0);
+    auto& reclaimer = cppthreadflow::EpochReclaimer::instance();
+
+    std::promise<void> pinned;
+    std::promise<void> release;
+    auto release_future = release.get_future();
+
+    std::thread reader([&]() {
+        cppthreadflow::EpochGuard guard;
+        pinned.set_value();
+        release_future.wait(); // 保持在临界区内
+    });
+    pinned.get_future().wait();
+
+    reclaimer.retire(new Tracked(destroyed));
+    for (int i = 0; i < 10; ++i) {
+        reclaimer.collect();
+    }
+    // 读线程停留在旧纪元，节点必须保持存活
+    EXPECT_EQ(destroyed.load(), 0);
+
+    release.set_value();
+    reader.join();
+
+    EXPECT_TRUE(collect_until([&] { return destroyed.load() == 1; }));
+}
+
+// 4. 测试退出线程遗留的节点由其他线程回收
+TEST(EpochReclaimerTest, OrphanedNodesAreReclaimed) {
+    std::atomic<int> destroyed(0);
+    const int count = 10;
+
+    std::thread t([&]() {
+        auto& reclaimer = cppthreadflow::EpochReclaimer::instance();
+        for (int i = 0; i < count; ++i) {
+            reclaimer.retire(new Tracked(destroyed));
+        }
+        // 线程退出，剩余节点进入孤儿列表
+    });
+    t.join();
+
+    EXPECT_TRUE(collect_until([&] { return destroyed.load() == count; }));
+}
+
+// 5. 测试 ThreadPool 的工作线程会被自动登记
+TEST(EpochReclaimerTest, ThreadPoolWorkersAreRegistered) {
+    auto& reclaimer = cppthreadflow::EpochReclaimer::instance();
+    const size_t before = reclaimer.registered_threads();
+    {
+        cppthreadflow::ThreadPool pool(4);
+        EXPECT_TRUE(collect_until([&] { return reclaimer.registered_threads() >= before + 4; }));
+    }
+    // 线程池析构后，工作线程全部注销
+    EXPECT_EQ(reclaimer.registered_threads(), before);
+}
+
+// 6. 并发读写压力测试：读线程在临界区内访问的节点不能被释放
+TEST(EpochReclaimerTest, ConcurrentReadersAndWriters) {
+    std::atomic<int> destroyed(0);
+    std::atomic<Tracked*> shared(new Tracked(destroyed, 42));
+    std::atomic<bool> running(true);
+    std::atomic<int> corrupted(0);
+    const int num_writes = 20000;
+
+    {
+        cppthreadflow::ThreadPool pool(4);
+        std::vector<std::future<void>> readers;
+        for (int i = 0; i < 3; ++i) {
+            readers.push_back(pool.submit([&]() {
+                while (running.load()) {
+                    cppthreadflow::EpochGuard guard;
+                    Tracked* node = shared.load(std::memory_order_acquire);
+                    if (node->value != 42) {
+                        corrupted++;
+                    }
+                }
+            }));
+        }
+
+        auto writer = pool.submit([&]() {
+            auto& reclaimer = cppthreadflow::EpochReclaimer::instance();
+            for (int i = 0; i < num_writes; ++i) {
+                Tracked* old = shared.exchange(new Tracked(destroyed, 42), std::memory_order_acq_rel);
+                reclaimer.retire(old);
+            }
+        });
+        writer.get();
+        running = false;
+        for (auto& f : readers) {
+            f.get();
+        }
+        // 线程池析构后，工作线程未回收的节点移交给孤儿列表
+    }
+
+    EXPECT_EQ(corrupted.load(), 0);
+    EXPECT_TRUE(collect_until([&] { return destroyed.load() == num_writes; }));
+    delete shared.load();
+}
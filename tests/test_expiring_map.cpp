@@ -0,0 +1,111 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/expiring_map.hpp"
+#include "../src/ThreadLib/thread_pool.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// 1. 测试基本操作与惰性过期
+TEST(ExpiringMapTest, LazyExpiryOnAccess) {
+    cppthreadflow::ExpiringMap<int, std::string> map(50ms, 4);
+
+    map.insert(1, "short");
+    map.insert(2, "long", 10s);
+    std::string value;
+    ASSERT_TRUE(map.find(1, value));
+    EXPECT_EQ(value, "short");
+
+    std::this_thread::sleep_for(80ms);
+
+    // 过期条目在被访问前仍占用空间，访问时被回收
+    EXPECT_EQ(map.size(), 2u);
+    EXPECT_FALSE(map.find(1, value));
+    EXPECT_EQ(map.size(), 1u);
+    EXPECT_EQ(map.expired_count(), 1u);
+
+    EXPECT_TRUE(map.contains(2));
+    EXPECT_TRUE(map.erase(2));
+    EXPECT_FALSE(map.contains(2));
+}
+
+// 2. 测试覆盖与续期会推迟过期时间
+TEST(ExpiringMapTest, OverwriteAndRefreshExtendLifetime) {
+    cppthreadflow::ExpiringMap<int, int> map(60ms, 1);
+    map.insert(1, 1);
+    map.insert(2, 2);
+
+    std::this_thread::sleep_for(30ms);
+    map.insert(1, 10, 200ms);      // 覆盖并设置更长的 TTL
+    EXPECT_TRUE(map.refresh(2, 200ms));
+    EXPECT_FALSE(map.refresh(3, 200ms));
+
+    std::this_thread::sleep_for(60ms);
+    // 旧的堆元素已到期，但条目已被续期，清扫不应删除它们
+    EXPECT_EQ(map.sweep(), 0u);
+    int value = 0;
+    ASSERT_TRUE(map.find(1, value));
+    EXPECT_EQ(value, 10);
+    EXPECT_TRUE(map.contains(2));
+}
+
+// 3. 测试手动清扫回收内存，且可以限制每个分片的处理数量
+TEST(ExpiringMapTest, SweepReclaimsExpiredEntries) {
+    cppthreadflow::ExpiringMap<int, int> map(20ms, 1);
+    for (int i = 0; i < 100; ++i) {
+        map.insert(i, i);
+    }
+    map.insert(1000, 1000, 10s);
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(map.sweep(30), 30u); // 单个分片，最多处理 30 个
+    EXPECT_EQ(map.size(), 71u);
+    EXPECT_EQ(map.sweep(), 70u);
+    EXPECT_EQ(map.size(), 1u);
+    EXPECT_EQ(map.expired_count(), 100u);
+}
+
+// 4. 测试由 Scheduler 驱动的后台清扫
+TEST(ExpiringMapTest, BackgroundSweepThroughScheduler) {
+    cppthreadflow::ThreadPool pool(2);
+    cppthreadflow::Scheduler scheduler(pool);
+    {
+        cppthreadflow::ExpiringMap<int, int> map(scheduler, 30ms, 20ms, 4);
+        for (int i = 0; i < 1000; ++i) {
+            map.insert(i, i);
+        }
+        // 没有任何访问，条目也应被后台任务回收
+        auto deadline = std::chrono::steady_clock::now() + 2s;
+        while (map.size() > 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(10ms);
+        }
+        EXPECT_EQ(map.size(), 0u);
+        EXPECT_EQ(map.expired_count(), 1000u);
+    }
+    // 表析构后清扫任务被取消，调度器和线程池继续正常工作
+    std::this_thread::sleep_for(50ms);
+}
+
+// 5. 测试反复覆盖同一批键时，过时的堆元素不会无限增长
+TEST(ExpiringMapTest, RepeatedOverwritesStayBounded) {
+    cppthreadflow::ExpiringMap<int, int> map(10s, 4);
+    const int num_threads = 4;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&map, t]() {
+            for (int j = 0; j < 20000; ++j) {
+                map.insert(j % 16, t);
+                if (j % 7 == 0) {
+                    map.refresh(j % 16, 10s);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(map.size(), 16u);
+    EXPECT_EQ(map.sweep(), 0u);
+}
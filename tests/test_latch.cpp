@@ -121,4 +121,16 @@ TEST(LatchTest, InitializeWithZero) {
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
 
     EXPECT_LT(elapsed.count(), 5);
-}
\ No newline at end of file
+}
+
+// 5. 测试带令牌的 wait：到达截止时间时返回 false，门闩打开后返回 true
+TEST(LatchTest, WaitWithTokenStopsAtDeadline) {
+    cppthreadflow::Latch latch(1);
+    auto source = cppthreadflow::CancellationSource::with_timeout(30ms);
+    EXPECT_FALSE(latch.wait(source.token()));
+
+    latch.count_down();
+    cppthreadflow::CancellationSource cancelled;
+    cancelled.cancel();
+    EXPECT_TRUE(latch.wait(cancelled.token())); // 已打开时条件优先
+}
@@ -0,0 +1,184 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/lock_free_hash_map.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 所有键都映射到同一个哈希值，用于测试哈希冲突
+struct CollidingHash {
+    size_t operator()(int) const { return 7; }
+};
+
+} // namespace
+
+// 1. 测试基本的单线程操作 (Insert, Find, Erase)
+TEST(LockFreeHashMapTest, BasicOperations) {
+    cppthreadflow::LockFreeHashMap<int, std::string> map;
+
+    EXPECT_TRUE(map.insert(1, "one"));
+    EXPECT_TRUE(map.insert(2, "two"));
+    EXPECT_EQ(map.size(), 2u);
+
+    std::string value;
+    ASSERT_TRUE(map.find(1, value));
+    EXPECT_EQ(value, "one");
+    EXPECT_TRUE(map.contains(2));
+    EXPECT_FALSE(map.find(99, value));
+
+    EXPECT_TRUE(map.erase(1));
+    EXPECT_FALSE(map.erase(1));
+    EXPECT_FALSE(map.contains(1));
+    EXPECT_EQ(map.size(), 1u);
+}
+
+// 2. 测试 insert 不会覆盖已存在的键
+TEST(LockFreeHashMapTest, InsertDoesNotOverwrite) {
+    cppthreadflow::LockFreeHashMap<int, int> map;
+    EXPECT_TRUE(map.insert(10, 100));
+    EXPECT_FALSE(map.insert(10, 200));
+
+    int value = 0;
+    ASSERT_TRUE(map.find(10, value));
+    EXPECT_EQ(value, 100);
+
+    // 删除后可以重新插入
+    EXPECT_TRUE(map.erase(10));
+    EXPECT_TRUE(map.insert(10, 300));
+    ASSERT_TRUE(map.find(10, value));
+    EXPECT_EQ(value, 300);
+}
+
+// 3. 测试增量扩容：桶数量随元素增长，所有元素仍可找到
+TEST(LockFreeHashMapTest, GrowsIncrementally) {
+    cppthreadflow::LockFreeHashMap<int, int> map(2, 1.0);
+    const size_t initial_buckets = map.bucket_count();
+    const int count = 50000;
+
+    for (int i = 0; i < count; ++i) {
+        ASSERT_TRUE(map.insert(i, i * 2));
+    }
+    EXPECT_GT(map.bucket_count(), initial_buckets);
+    EXPECT_EQ(map.size(), static_cast<size_t>(count));
+
+    for (int i = 0; i < count; ++i) {
+        int value = 0;
+        ASSERT_TRUE(map.find(i, value));
+        EXPECT_EQ(value, i * 2);
+    }
+}
+
+// 4. 测试哈希冲突的键能够被正确区分
+TEST(LockFreeHashMapTest, HandlesHashCollisions) {
+    cppthreadflow::LockFreeHashMap<int, int, CollidingHash> map;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(map.insert(i, i));
+    }
+    EXPECT_TRUE(map.erase(50));
+    for (int i = 0; i < 100; ++i) {
+        int value = -1;
+        EXPECT_EQ(map.find(i, value), i != 50);
+        if (i != 50) {
+            EXPECT_EQ(value, i);
+        }
+    }
+}
+
+// 5. 并发插入测试，同时触发扩容
+TEST(LockFreeHashMapTest, ConcurrentInsert) {
+    const int num_threads = 8;
+    const int items_per_thread = 10000;
+    cppthreadflow::LockFreeHashMap<int, int> map(4);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&map, i]() {
+            for (int j = 0; j < items_per_thread; ++j) {
+                int key = i * items_per_thread + j;
+                map.insert(key, key + 1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(map.size(), static_cast<size_t>(num_threads * items_per_thread));
+    for (int key = 0; key < num_threads * items_per_thread; ++key) {
+        int value = 0;
+        ASSERT_TRUE(map.find(key, value));
+        EXPECT_EQ(value, key + 1);
+    }
+}
+
+// 6. 并发插入同一批键：每个键只有一个线程能插入成功
+TEST(LockFreeHashMapTest, ConcurrentInsertSameKeys) {
+    const int num_threads = 8;
+    const int key_range = 5000;
+    cppthreadflow::LockFreeHashMap<int, int> map;
+    std::atomic<int> successes(0);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&]() {
+            for (int key = 0; key < key_range; ++key) {
+                if (map.insert(key, key)) {
+                    successes++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(successes.load(), key_range);
+    EXPECT_EQ(map.size(), static_cast<size_t>(key_range));
+}
+
+// 7. 並發讀寫混合測試 (讀/寫/刪)
+TEST(LockFreeHashMapTest, ConcurrentMixedWorkload) {
+    const int num_threads = 8;
+    const int ops_per_thread = 20000;
+    const int key_range = 1000;
+    cppthreadflow::LockFreeHashMap<int, int> map;
+    std::atomic<int> inserted(0);
+    std::atomic<int> erased(0);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i]() {
+            for (int j = 0; j < ops_per_thread; ++j) {
+                int key = (j * 7 + i) % key_range;
+                switch (j % 3) {
+                    case 0:
+                        if (map.insert(key, key)) inserted++;
+                        break;
+                    case 1: {
+                        int value = -1;
+                        if (map.find(key, value)) {
+                            EXPECT_EQ(value, key);
+                        }
+                        break;
+                    }
+                    case 2:
+                        if (map.erase(key)) erased++;
+                        break;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // 成功插入与成功删除之差，等于最终剩余的元素数量
+    EXPECT_EQ(map.size(), static_cast<size_t>(inserted.load() - erased.load()));
+    size_t found = 0;
+    for (int key = 0; key < key_range; ++key) {
+        if (map.contains(key)) found++;
+    }
+    EXPECT_EQ(found, map.size());
+}
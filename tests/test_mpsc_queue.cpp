@@ -0,0 +1,146 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/mpsc_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+struct Message : cppthreadflow::MpscNode {
+    explicit Message(int v) : value(v) {}
+    int value;
+};
+
+} // namespace
+
+// 1. 测试侵入式队列的 FIFO 顺序
+TEST(MpscQueueTest, IntrusiveQueueIsFifo) {
+    cppthreadflow::IntrusiveMpscQueue q;
+    EXPECT_EQ(q.try_pop(), nullptr);
+
+    std::deque<Message> messages; // deque 不会移动已有元素
+    for (int i = 0; i < 5; ++i) {
+        messages.emplace_back(i);
+    }
+    for (auto& m : messages) {
+        q.push(&m);
+    }
+    for (int i = 0; i < 5; ++i) {
+        auto* node = static_cast<Message*>(q.try_pop());
+        ASSERT_NE(node, nullptr);
+        EXPECT_EQ(node->value, i);
+    }
+    EXPECT_EQ(q.try_pop(), nullptr);
+
+    // 取空之后可以继续使用
+    q.push(&messages[0]);
+    EXPECT_EQ(q.try_pop(), &messages[0]);
+}
+
+// 2. 测试基本操作、只能移动的类型与 stop 语义
+TEST(MpscQueueTest, PushPopAndStop) {
+    cppthreadflow::MpscQueue<std::unique_ptr<int> > q;
+    q.push(std::make_unique<int>(1));
+    q.push(std::make_unique<int>(2));
+
+    std::unique_ptr<int> out;
+    ASSERT_TRUE(q.try_pop(out));
+    EXPECT_EQ(*out, 1);
+
+    q.stop();
+    ASSERT_TRUE(q.pop(out)); // stop 之后仍能取出剩余元素
+    EXPECT_EQ(*out, 2);
+    EXPECT_FALSE(q.pop(out));
+}
+
+// 3. 测试阻塞的 pop 会被 push 唤醒
+TEST(MpscQueueTest, PopBlocksUntilPush) {
+    cppthreadflow::MpscQueue<int> q;
+    std::atomic<int> received(-1);
+    std::thread consumer([&]() {
+        int val;
+        if (q.pop(val)) {
+            received = val;
+        }
+    });
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(received.load(), -1);
+    q.push(42);
+    consumer.join();
+    EXPECT_EQ(received.load(), 42);
+}
+
+// 4. 多生产者压力测试：每个生产者的元素保持各自的顺序
+TEST(MpscQueueTest, MultiProducerStress) {
+    cppthreadflow::MpscQueue<std::pair<int, int> > q;
+    const int num_producers = 8;
+    const int items_per_producer = 50000;
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&q, p]() {
+            for (int i = 0; i < items_per_producer; ++i) {
+                q.push({p, i});
+            }
+        });
+    }
+
+    std::vector<int> next_expected(num_producers, 0);
+    std::pair<int, int> item;
+    for (int received = 0; received < num_producers * items_per_producer; ++received) {
+        ASSERT_TRUE(q.pop(item));
+        ASSERT_EQ(item.second, next_expected[item.first]);
+        next_expected[item.first]++;
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    EXPECT_FALSE(q.try_pop(item));
+}
+
+// 5. 测试 stop 与并发的 push 交错时，stop 之前已入队的元素不会丢失
+TEST(MpscQueueTest, StopDrainsItemsBehindUnlinkedPush) {
+    cppthreadflow::IntrusiveMpscQueue intrusive;
+    EXPECT_TRUE(intrusive.empty());
+    Message a(1);
+    intrusive.push(&a);
+    EXPECT_FALSE(intrusive.empty());
+    EXPECT_EQ(intrusive.try_pop(), &a);
+    EXPECT_TRUE(intrusive.empty());
+
+    for (int round = 0; round < 20; ++round) {
+        cppthreadflow::MpscQueue<int> q;
+        std::atomic<bool> done{false};
+        std::atomic<int> pushed{0};
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 4; ++p) {
+            producers.emplace_back([&]() {
+                while (!done.load()) {
+                    q.push(0);
+                    pushed.fetch_add(1);
+                }
+            });
+        }
+        std::this_thread::sleep_for(1ms);
+        // 读取计数之后再 stop：这些元素都在 stop 之前完成了入队
+        const int pushed_before_stop = pushed.load();
+        q.stop();
+        done.store(true);
+
+        // 生产者可能仍在链接最后一个元素，pop 要等它完成，而不是提前返回 false
+        int popped = 0;
+        int item = 0;
+        while (q.pop(item)) {
+            ++popped;
+        }
+        for (auto& t : producers) {
+            t.join();
+        }
+        EXPECT_GE(popped, pushed_before_stop);
+    }
+}
@@ -0,0 +1,203 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/pipeline.hpp"
+#include "../src/ThreadLib/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// 产生 [0, count) 的源
+struct Counter {
+    int next = 0;
+    int count;
+    bool operator()(int& out) {
+        if (next == count) {
+            return false;
+        }
+        out = next++;
+        return true;
+    }
+};
+
+// 记录并发度的最大值
+void update_max(std::atomic<int>& max_value, int value) {
+    int current = max_value.load();
+    while (value > current && !max_value.compare_exchange_weak(current, value)) {
+    }
+}
+
+} // namespace
+
+// 1. 测试并行阶段之后的有序串行阶段仍按输入顺序输出
+TEST(PipelineTest, InOrderStagePreservesInputOrder) {
+    cppthreadflow::ThreadPool pool(4);
+    cppthreadflow::Pipeline pipeline(pool, {8, 4});
+    std::vector<std::string> output;
+
+    pipeline.source<int>(Counter{0, 1000})
+        .stage<int>(cppthreadflow::StageMode::kParallel, [](int value) {
+            if (value % 7 == 0) {
+                std::this_thread::sleep_for(100us); // 打乱完成顺序
+            }
+            return std::to_string(value * 2);
+        })
+        .stage<std::string>(cppthreadflow::StageMode::kSerialInOrder,
+                            [&output](std::string value) { output.push_back(value); });
+
+    EXPECT_EQ(pipeline.run(), 1000u);
+    ASSERT_EQ(output.size(), 1000u);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(output[i], std::to_string(i * 2));
+    }
+}
+
+// 2. 测试返回 std::nullopt 的元素被过滤，乱序串行阶段可以不加锁地聚合
+TEST(PipelineTest, OptionalFiltersAndSerialAggregation) {
+    cppthreadflow::ThreadPool pool(4);
+    cppthreadflow::Pipeline pipeline(pool, {16, 8});
+    long long sum = 0;
+    int count = 0;
+
+    pipeline.source<int>(Counter{0, 10000})
+        .stage<int>(cppthreadflow::StageMode::kParallel, [](int value) -> std::optional<int> {
+            if (value % 2 != 0) {
+                return std::nullopt;
+            }
+            return value;
+        })
+        .stage<int>(cppthreadflow::StageMode::kSerialOutOfOrder, [&](int value) {
+            sum += value; // 串行阶段同一时刻只有一个线程执行
+            ++count;
+        });
+
+    EXPECT_EQ(pipeline.run(), 10000u);
+    EXPECT_EQ(count, 5000);
+    EXPECT_EQ(sum, 24995000LL);
+
+    // 可以再次运行
+    EXPECT_EQ(pipeline.source<int>(Counter{0, 10}).run(), 10u);
+    EXPECT_EQ(count, 5005);
+}
+
+// 3. 测试令牌数限制了流水线中同时存在的元素数
+TEST(PipelineTest, TokensBoundItemsInFlight) {
+    cppthreadflow::ThreadPool pool(4);
+    const size_t max_tokens = 3;
+    const size_t batch_size = 2;
+    cppthreadflow::Pipeline pipeline(pool, {max_tokens, batch_size});
+    std::atomic<int> in_flight(0);
+    std::atomic<int> max_in_flight(0);
+
+    pipeline.source<int>([&, next = 0](int& out) mutable {
+            if (next == 500) {
+                return false;
+            }
+            out = next++;
+            update_max(max_in_flight, ++in_flight);
+            return true;
+        })
+        .stage<int>(cppthreadflow::StageMode::kParallel, [](int value) {
+            std::this_thread::sleep_for(10us);
+            return value;
+        })
+        .stage<int>(cppthreadflow::StageMode::kSerialInOrder, [&](int) { --in_flight; });
+
+    pipeline.run();
+    EXPECT_LE(max_in_flight.load(), static_cast<int>(max_tokens * batch_size));
+    EXPECT_EQ(in_flight.load(), 0);
+}
+
+// 4. 测试并行阶段的并发度上限
+TEST(PipelineTest, ParallelismLimit) {
+    cppthreadflow::ThreadPool pool(8);
+    cppthreadflow::Pipeline pipeline(pool, {16, 1});
+    std::atomic<int> active(0);
+    std::atomic<int> max_active(0);
+
+    pipeline.source<int>(Counter{0, 200})
+        .stage<int>(cppthreadflow::StageMode::kParallel, [&](int) {
+            update_max(max_active, ++active);
+            std::this_thread::sleep_for(100us);
+            --active;
+        }, 2);
+
+    pipeline.run();
+    EXPECT_LE(max_active.load(), 2);
+    EXPECT_GE(max_active.load(), 1);
+}
+
+// 5. 测试阶段抛出的异常由 run() 重新抛出，源停止产生新元素
+TEST(PipelineTest, StageExceptionStopsPipeline) {
+    cppthreadflow::ThreadPool pool(4);
+    cppthreadflow::Pipeline pipeline(pool, {4, 1});
+    std::atomic<int> produced(0);
+
+    pipeline.source<int>([&](int& out) {
+            out = produced++;
+            return true; // 无限的源，只能由异常停止
+        })
+        .stage<int>(cppthreadflow::StageMode::kParallel, [](int value) {
+            if (value == 100) {
+                throw std::runtime_error("bad record");
+            }
+            return value;
+        })
+        .stage<int>(cppthreadflow::StageMode::kSerialInOrder, [](int) {});
+
+    EXPECT_THROW(pipeline.run(), std::runtime_error);
+    EXPECT_GE(produced.load(), 101);
+}
+
+// 6. 测试没有源时 run 抛出 logic_error
+TEST(PipelineTest, RunWithoutSourceThrows) {
+    cppthreadflow::ThreadPool pool(1);
+    cppthreadflow::Pipeline pipeline(pool);
+    EXPECT_THROW(pipeline.run(), std::logic_error);
+}
+
+// 7. 测试线程池拒绝提交时，run() 等所有令牌结束后抛出，而不是挂起
+TEST(PipelineTest, RejectedSubmissionFailsRun) {
+    using namespace std::chrono_literals;
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.queue_capacity = 1;
+    options.overflow_policy = cppthreadflow::OverflowPolicy::kFailFast;
+    cppthreadflow::ThreadPool pool(options);
+    cppthreadflow::Pipeline pipeline(pool, {8, 1});
+    int next = 0;
+
+    pipeline.source<int>([&](int& out) {
+            out = next++;
+            return next <= 1000;
+        })
+        .stage<int>(cppthreadflow::StageMode::kParallel, [](int value) {
+            std::this_thread::sleep_for(1ms);
+            return value;
+        })
+        .stage<int>(cppthreadflow::StageMode::kSerialInOrder, [](int) {});
+
+    EXPECT_THROW(pipeline.run(), cppthreadflow::QueueFullError);
+    EXPECT_LT(next, 1000);
+}
+
+// 8. 测试丢弃策略的线程池会让令牌无法结束，构造时即被拒绝
+TEST(PipelineTest, RejectsDropPolicyPool) {
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.queue_capacity = 1;
+    options.overflow_policy = cppthreadflow::OverflowPolicy::kDropNewest;
+    cppthreadflow::ThreadPool newest(options);
+    EXPECT_THROW(cppthreadflow::Pipeline pipeline(newest), std::invalid_argument);
+
+    options.overflow_policy = cppthreadflow::OverflowPolicy::kDropOldest;
+    cppthreadflow::ThreadPool oldest(options);
+    EXPECT_THROW(cppthreadflow::Pipeline pipeline(oldest), std::invalid_argument);
+}
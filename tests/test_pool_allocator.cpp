@@ -0,0 +1,115 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/pool_allocator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// 1. 测试块的对齐、复用与计数
+TEST(FixedSizePoolTest, AllocatesAlignedBlocksAndReusesThem) {
+    // 线程缓存每次批量取 4 块，20 块恰好取空缓存
+    cppthreadflow::FixedSizePool pool(24, 8, 4);
+    EXPECT_EQ(pool.block_size() % alignof(std::max_align_t), 0u);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 20; ++i) {
+        void* p = pool.allocate();
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % alignof(std::max_align_t), 0u);
+        blocks.push_back(p);
+    }
+    EXPECT_EQ(pool.blocks_in_use(), 20u);
+    EXPECT_EQ(pool.blocks_reserved(), 24u); // 3 个 chunk，每个 8 块
+
+    void* last = blocks.back();
+    pool.deallocate(last);
+    blocks.pop_back();
+    EXPECT_EQ(pool.allocate(), last); // 最近释放的块被优先复用
+    blocks.push_back(last);
+
+    for (void* p : blocks) {
+        pool.deallocate(p);
+    }
+    // 释放的块先留在本线程的缓存中，归还之后才回到共享空闲链表
+    pool.flush_thread_cache();
+    EXPECT_EQ(pool.blocks_in_use(), 0u);
+    EXPECT_EQ(pool.blocks_reserved(), 24u);
+}
+
+// 2. 多线程并发分配与释放
+TEST(FixedSizePoolTest, ConcurrentAllocateAndDeallocate) {
+    cppthreadflow::FixedSizePool pool(sizeof(std::uint64_t));
+    const int num_threads = 8;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&pool, i]() {
+            std::vector<std::uint64_t*> mine;
+            for (int round = 0; round < 100; ++round) {
+                for (int j = 0; j < 50; ++j) {
+                    auto* p = static_cast<std::uint64_t*>(pool.allocate());
+                    *p = static_cast<std::uint64_t>(i);
+                    mine.push_back(p);
+                }
+                for (auto* p : mine) {
+                    EXPECT_EQ(*p, static_cast<std::uint64_t>(i)); // 块不会被其他线程同时持有
+                    pool.deallocate(p);
+                }
+                mine.clear();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(pool.blocks_in_use(), 0u);
+}
+
+// 3. 测试跨线程释放，以及池先于缓存了它的块的线程析构
+TEST(FixedSizePoolTest, CrossThreadFreeAndPoolOutlivedByThread) {
+    auto pool = std::make_unique<cppthreadflow::FixedSizePool>(sizeof(std::uint64_t), 16, 4);
+    std::vector<void*> blocks;
+    for (int i = 0; i < 10; ++i) {
+        blocks.push_back(pool->allocate());
+    }
+
+    // 另一个线程释放这些块；线程退出时缓存归还给共享链表
+    std::thread([&]() {
+        for (void* p : blocks) {
+            pool->deallocate(p);
+        }
+    }).join();
+    pool->flush_thread_cache();
+    EXPECT_EQ(pool->blocks_in_use(), 0u);
+
+    // 线程缓存了块之后池被销毁：线程退出时不能再访问它
+    std::promise<void> cached;
+    std::promise<void> destroyed;
+    std::thread holder([&]() {
+        pool->deallocate(pool->allocate());
+        cached.set_value();
+        destroyed.get_future().wait();
+    });
+    cached.get_future().wait();
+    pool.reset();
+    destroyed.set_value();
+    holder.join();
+}
+
+// 4. 测试池析构后编号被新池复用时，线程缓存中旧池的块不会被新池使用
+TEST(FixedSizePoolTest, ReusedPoolIdDiscardsStaleCache) {
+    for (int round = 0; round < 100; ++round) {
+        auto pool = std::make_unique<cppthreadflow::FixedSizePool>(32, 8, 4);
+        // 让本线程缓存里留下旧池的块
+        pool->deallocate(pool->allocate());
+        pool.reset();
+
+        cppthreadflow::FixedSizePool fresh(32, 8, 4);
+        void* block = fresh.allocate();
+        EXPECT_EQ(fresh.blocks_reserved(), 8u);
+        fresh.deallocate(block);
+        fresh.flush_thread_cache();
+        EXPECT_EQ(fresh.blocks_in_use(), 0u);
+    }
+}
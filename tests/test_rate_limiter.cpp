@@ -0,0 +1,133 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/rate_limiter.hpp"
+#include "../src/ThreadLib/scheduler.hpp"
+#include "../src/ThreadLib/thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// 1. 测试令牌桶的突发容量与惰性补充
+TEST(RateLimiterTest, TokenBucketBurstAndRefill) {
+    cppthreadflow::TokenBucket bucket(20.0, 5);
+    EXPECT_EQ(bucket.burst(), 5u);
+    EXPECT_EQ(bucket.available_tokens(), 5u);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(bucket.try_acquire());
+    }
+    EXPECT_FALSE(bucket.try_acquire());
+    EXPECT_EQ(bucket.available_tokens(), 0u);
+    EXPECT_GT(bucket.time_until_available(), 0ms);
+
+    std::this_thread::sleep_for(120ms);
+    EXPECT_GE(bucket.available_tokens(), 2u);
+    EXPECT_TRUE(bucket.try_acquire(2));
+}
+
+// 2. 测试 GCRA 拒绝时给出重试间隔
+TEST(RateLimiterTest, GcraReportsRetryAfter) {
+    cppthreadflow::GcraLimiter limiter(10, 1s, 2);
+    std::chrono::steady_clock::duration retry_after{};
+    EXPECT_TRUE(limiter.try_acquire(1, retry_after));
+    EXPECT_EQ(retry_after, std::chrono::steady_clock::duration::zero());
+    EXPECT_TRUE(limiter.try_acquire());
+    EXPECT_FALSE(limiter.try_acquire(1, retry_after));
+    EXPECT_GT(retry_after, 0ms);
+    EXPECT_LE(retry_after, 100ms);
+
+    std::this_thread::sleep_for(retry_after);
+    EXPECT_TRUE(limiter.try_acquire());
+}
+
+// 3. 测试阻塞获取按速率放行
+TEST(RateLimiterTest, BlockingAcquirePacesCallers) {
+    cppthreadflow::TokenBucket bucket(100.0, 1);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 11; ++i) {
+        bucket.acquire();
+    }
+    // 第一个许可立即可用，其余 10 个每个间隔 10ms
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 95ms);
+}
+
+// 4. 测试可取消的获取：被取消时返回 false，且不消耗许可
+TEST(RateLimiterTest, CancellableAcquireDoesNotConsume) {
+    cppthreadflow::TokenBucket bucket(10.0, 1);
+    ASSERT_TRUE(bucket.try_acquire());
+
+    auto timed = cppthreadflow::CancellationSource::with_timeout(20ms);
+    EXPECT_FALSE(bucket.acquire(1, timed.token()));
+
+    cppthreadflow::CancellationSource source;
+    auto waiter = std::async(std::launch::async, [&]() { return bucket.acquire(1, source.token()); });
+    EXPECT_EQ(waiter.wait_for(20ms), std::future_status::timeout);
+    source.cancel();
+    EXPECT_FALSE(waiter.get());
+
+    // 两次被取消的等待都没有预留许可，补充之后可以立即获取
+    std::this_thread::sleep_for(bucket.time_until_available());
+    EXPECT_TRUE(bucket.acquire(1, cppthreadflow::CancellationToken()));
+}
+
+// 5. 测试异步获取：许可可用时由 Scheduler 执行后续任务，调用者不阻塞
+TEST(RateLimiterTest, AsyncAcquireRunsContinuationWhenReady) {
+    cppthreadflow::ThreadPool pool(2);
+    cppthreadflow::Scheduler scheduler(pool);
+    cppthreadflow::TokenBucket bucket(20.0, 1);
+    ASSERT_TRUE(bucket.try_acquire());
+
+    auto start = std::chrono::steady_clock::now();
+    std::promise<std::chrono::steady_clock::time_point> fired;
+    bucket.acquire_async(scheduler, [&fired]() { fired.set_value(std::chrono::steady_clock::now()); });
+    auto fired_at = fired.get_future().get();
+    EXPECT_GE(fired_at - start, 40ms);
+
+    // 许可已被异步请求预留
+    EXPECT_FALSE(bucket.try_acquire());
+}
+
+// 6. 测试并发获取不会超发
+TEST(RateLimiterTest, ConcurrentAcquireNeverOvershoots) {
+    cppthreadflow::TokenBucket bucket(0.001, 1000);
+    std::atomic<int> granted(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 500; ++i) {
+                if (bucket.try_acquire()) {
+                    granted++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(granted.load(), 1000);
+}
+
+// 7. 测试参数检查
+TEST(RateLimiterTest, RejectsInvalidArguments) {
+    EXPECT_THROW(cppthreadflow::TokenBucket(0.0, 1), std::invalid_argument);
+    EXPECT_THROW(cppthreadflow::TokenBucket(1.0, 0), std::invalid_argument);
+    EXPECT_THROW(cppthreadflow::GcraLimiter(0, 1s), std::invalid_argument);
+
+    cppthreadflow::TokenBucket bucket(1.0, 2);
+    EXPECT_THROW(bucket.try_acquire(3), std::invalid_argument);
+    EXPECT_THROW(bucket.try_acquire(0), std::invalid_argument);
+}
+
+// 8. 测试补充间隔就近取整，而不是截断（截断会让高速率系统性地偏快）
+TEST(RateLimiterTest, IntervalRoundsToNearestNanosecond) {
+    // 间隔为 2.6 ns：截断为 2 ns，就近取整为 3 ns
+    cppthreadflow::TokenBucket bucket(1e9 / 2.6, 1);
+    const auto start = cppthreadflow::TokenBucket::Clock::now();
+    // 预留一百万个许可：就近取整时约需 3 ms，截断时只需 2 ms
+    const auto ready = bucket.reserve(1000000);
+    EXPECT_GE(ready - start, 2900us);
+    EXPECT_LT(ready - start, 3500us);
+}
@@ -3,6 +3,7 @@
 #include "ThreadLib/thread_pool.hpp"
 #include <chrono>
 #include <future>
+#include <memory>
 #include <atomic>
 #include <vector>
 #include <mutex>
@@ -120,4 +121,111 @@ TEST_F(SchedulerTest, ShutdownIsGraceful) {
 
     // 如果 reset() 操作能够顺利完成而不阻塞或崩溃，则测试通过。
     SUCCEED();
-}
\ No newline at end of file
+}
+
+// 5. 测试取消一次性任务与周期性任务
+TEST_F(SchedulerTest, CancelPreventsExecution) {
+    std::atomic<int> one_shot_count = 0;
+    std::atomic<int> periodic_count = 0;
+
+    auto one_shot = scheduler->schedule_after(100ms, [&]() { one_shot_count++; });
+    auto periodic = scheduler->schedule_periodic(
+        cppthreadflow::Scheduler::Clock::now(), 50ms, [&]() { periodic_count++; });
+
+    EXPECT_TRUE(scheduler->cancel(one_shot));
+    EXPECT_FALSE(scheduler->cancel(one_shot)); // 不能重复取消
+
+    // 让周期性任务执行几次后再取消
+    std::this_thread::sleep_for(180ms);
+    EXPECT_TRUE(scheduler->cancel(periodic));
+    std::this_thread::sleep_for(50ms); // 等待可能已提交的那一次执行完成
+    int count_after_cancel = periodic_count.load();
+    std::this_thread::sleep_for(200ms);
+
+    EXPECT_EQ(one_shot_count.load(), 0);
+    EXPECT_GE(count_after_cancel, 1);
+    EXPECT_EQ(periodic_count.load(), count_after_cancel);
+}
+
+// 6. 测试令牌取消：一次性任务被跳过，周期性任务停止
+TEST_F(SchedulerTest, TokenCancellationStopsTasks) {
+    std::atomic<int> one_shot_count = 0;
+    std::atomic<int> periodic_count = 0;
+    cppthreadflow::CancellationSource source;
+
+    scheduler->schedule_after(100ms, [&]() { one_shot_count++; }, source.token());
+    scheduler->schedule_periodic(
+        cppthreadflow::Scheduler::Clock::now(), 30ms, [&]() { periodic_count++; },
+        source.token());
+
+    std::this_thread::sleep_for(50ms);
+    source.cancel();
+    std::this_thread::sleep_for(50ms);
+    int count_after_cancel = periodic_count.load();
+    std::this_thread::sleep_for(150ms);
+
+    EXPECT_EQ(one_shot_count.load(), 0);
+    EXPECT_GE(count_after_cancel, 1);
+    EXPECT_EQ(periodic_count.load(), count_after_cancel);
+}
+
+// 7. 测试取消（cancel 或令牌）立即释放任务的闭包，而不是等到原定的到期时间
+TEST_F(SchedulerTest, CancelReleasesClosureImmediately) {
+    auto resource = std::make_shared<int>(0);
+    std::weak_ptr<int> by_cancel = resource;
+    const auto id = scheduler->schedule_after(1h, [resource]() {});
+    resource.reset();
+    EXPECT_FALSE(by_cancel.expired());
+    EXPECT_TRUE(scheduler->cancel(id));
+    EXPECT_TRUE(by_cancel.expired());
+
+    cppthreadflow::CancellationSource source;
+    resource = std::make_shared<int>(0);
+    std::weak_ptr<int> by_token = resource;
+    scheduler->schedule_after(1h, [resource]() {}, source.token());
+    resource.reset();
+    source.cancel();
+    EXPECT_TRUE(by_token.expired());
+
+    // 大量被取消的长定时器触发堆的压缩，之后的任务照常执行
+    for (int i = 0; i < 1000; ++i) {
+        scheduler->cancel(scheduler->schedule_after(1h, []() {}));
+    }
+    std::promise<void> done;
+    scheduler->schedule_after(10ms, [&done]() { done.set_value(); });
+    EXPECT_EQ(done.get_future().wait_for(1s), std::future_status::ready);
+}
+
+// 8. 测试被线程池拒绝的执行被计数
+TEST(SchedulerRejectionTest, CountsRejectedExecutions) {
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.queue_capacity = 1;
+    options.overflow_policy = cppthreadflow::OverflowPolicy::kFailFast;
+    cppthreadflow::ThreadPool pool(options);
+
+    // 占住唯一的工作线程，并填满队列
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> started;
+    auto blocker = pool.submit([&started, released]() {
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait();
+    auto filler = pool.submit([]() {});
+
+    {
+        cppthreadflow::Scheduler scheduler(pool);
+        std::atomic<bool> ran = false;
+        scheduler.schedule_after(0ms, [&ran]() { ran = true; });
+        for (int i = 0; i < 1000 && scheduler.rejected_count() == 0; ++i) {
+            std::this_thread::sleep_for(1ms);
+        }
+        EXPECT_EQ(scheduler.rejected_count(), 1u);
+        release.set_value();
+        blocker.get();
+        filler.get();
+        EXPECT_FALSE(ran.load());
+    }
+}
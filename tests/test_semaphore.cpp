@@ -134,4 +134,33 @@ TEST(SemaphoreTest, SingleProducerMultiConsumer) {
 
     // 验证：所有 10 个消费者都应该成功获取了信号量
     EXPECT_EQ(acquired_count.load(), num_consumers);
-}
\ No newline at end of file
+}
+
+// 6. 测试带令牌的 acquire：被取消时返回 false，且不消耗许可
+TEST(SemaphoreTest, AcquireWithTokenIsCancellable) {
+    cppthreadflow::Semaphore sem(0);
+    cppthreadflow::CancellationSource source;
+
+    auto waiter = std::async(std::launch::async, [&]() { return sem.acquire(source.token()); });
+    EXPECT_EQ(waiter.wait_for(50ms), std::future_status::timeout);
+    source.cancel();
+    EXPECT_FALSE(waiter.get());
+
+    sem.release();
+    EXPECT_TRUE(sem.acquire(cppthreadflow::CancellationToken()));
+}
+
+// 7. 测试 try_acquire_for 的超时与成功路径
+TEST(SemaphoreTest, TryAcquireForTimesOut) {
+    cppthreadflow::Semaphore sem(0);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(sem.try_acquire_for(30ms));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 30ms);
+
+    std::thread releaser([&sem]() {
+        std::this_thread::sleep_for(20ms);
+        sem.release();
+    });
+    EXPECT_TRUE(sem.try_acquire_for(5s));
+    releaser.join();
+}
@@ -0,0 +1,91 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/seq_lock.hpp"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 跨越多个 64 位字、且大小不是 8 的倍数的快照
+struct Snapshot {
+    std::uint32_t version;
+    std::uint64_t values[3];
+    std::uint32_t checksum;
+};
+
+Snapshot make_snapshot(std::uint32_t version) {
+    Snapshot s{};
+    s.version = version;
+    for (std::uint64_t i = 0; i < 3; ++i) {
+        s.values[i] = version * 10 + i;
+    }
+    s.checksum = version ^ 0xdeadbeef;
+    return s;
+}
+
+bool is_consistent(const Snapshot& s) {
+    for (std::uint64_t i = 0; i < 3; ++i) {
+        if (s.values[i] != s.version * 10 + i) {
+            return false;
+        }
+    }
+    return s.checksum == (s.version ^ 0xdeadbeef);
+}
+
+} // namespace
+
+// 1. 测试基本的读写与序号
+TEST(SeqLockTest, StoreAndLoad) {
+    cppthreadflow::SeqLock<Snapshot> lock(make_snapshot(1));
+    EXPECT_EQ(lock.load().version, 1u);
+    EXPECT_EQ(lock.sequence(), 0u);
+
+    lock.store(make_snapshot(2));
+    Snapshot s{};
+    ASSERT_TRUE(lock.try_load(s));
+    EXPECT_EQ(s.version, 2u);
+    EXPECT_TRUE(is_consistent(s));
+    EXPECT_EQ(lock.sequence(), 2u);
+
+    lock.update([](Snapshot& value) { value = make_snapshot(value.version + 1); });
+    EXPECT_EQ(lock.load().version, 3u);
+    EXPECT_EQ(lock.sequence(), 4u);
+}
+
+// 2. 压力测试：读者与写者并发时，读到的快照始终完整且版本单调
+TEST(SeqLockTest, ReadersNeverSeeTornSnapshots) {
+    cppthreadflow::SeqLock<Snapshot> lock(make_snapshot(0));
+    std::atomic<bool> done(false);
+    std::atomic<bool> torn(false);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&]() {
+            std::uint32_t last = 0;
+            while (!done.load()) {
+                Snapshot s = lock.load();
+                if (!is_consistent(s) || s.version < last) {
+                    torn = true;
+                }
+                last = s.version;
+            }
+        });
+    }
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 2; ++t) {
+        writers.emplace_back([&]() {
+            for (int i = 0; i < 2000; ++i) {
+                lock.update([](Snapshot& value) { value = make_snapshot(value.version + 1); });
+            }
+        });
+    }
+    for (auto& w : writers) {
+        w.join();
+    }
+    done = true;
+    for (auto& r : readers) {
+        r.join();
+    }
+    EXPECT_FALSE(torn.load());
+    EXPECT_EQ(lock.load().version, 4000u);
+}
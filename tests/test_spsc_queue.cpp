@@ -0,0 +1,122 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/spsc_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// 1. 测试基本的 try_push/try_pop 与容量
+TEST(SpscQueueTest, TryPushTryPopAndCapacity) {
+    cppthreadflow::SpscQueue<std::string> q(3);
+    EXPECT_EQ(q.capacity(), 4u); // 向上取整为 2 的幂
+    EXPECT_TRUE(q.empty());
+
+    for (int i = 0; i < 4; ++i) {
+        std::string s = std::to_string(i);
+        ASSERT_TRUE(q.try_push(s));
+    }
+    std::string extra = "extra";
+    EXPECT_FALSE(q.try_push(extra));
+    EXPECT_EQ(extra, "extra"); // 失败时元素不会被移走
+    EXPECT_EQ(q.size(), 4u);
+
+    std::string out;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(q.try_pop(out));
+        EXPECT_EQ(out, std::to_string(i));
+    }
+    EXPECT_FALSE(q.try_pop(out));
+}
+
+// 2. 测试只能移动的类型，以及析构时释放剩余元素
+TEST(SpscQueueTest, MoveOnlyElements) {
+    auto tracker = std::make_shared<int>(0);
+    {
+        cppthreadflow::SpscQueue<std::shared_ptr<int> > q(8);
+        q.push(tracker);
+        q.push(tracker);
+        EXPECT_EQ(tracker.use_count(), 3);
+    }
+    EXPECT_EQ(tracker.use_count(), 1);
+
+    cppthreadflow::SpscQueue<std::unique_ptr<int> > q(2);
+    q.push(std::make_unique<int>(7));
+    std::unique_ptr<int> out;
+    ASSERT_TRUE(q.pop(out));
+    EXPECT_EQ(*out, 7);
+}
+
+// 3. 测试 stop：阻塞的 pop 被唤醒，剩余元素仍可取出
+TEST(SpscQueueTest, StopBehavior) {
+    cppthreadflow::SpscQueue<int> q(4);
+    std::atomic<bool> pop_returned(false);
+    std::thread consumer([&]() {
+        int val;
+        EXPECT_FALSE(q.pop(val));
+        pop_returned = true;
+    });
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(pop_returned);
+    q.stop();
+    consumer.join();
+    EXPECT_TRUE(pop_returned);
+
+    cppthreadflow::SpscQueue<int> q2(4);
+    q2.push(1);
+    q2.stop();
+    int val = 0;
+    EXPECT_TRUE(q2.pop(val));
+    EXPECT_EQ(val, 1);
+    EXPECT_FALSE(q2.pop(val));
+}
+
+// 4. 测试队列满时 push 阻塞，消费后恢复；stop 会解除阻塞
+TEST(SpscQueueTest, PushBlocksWhenFull) {
+    cppthreadflow::SpscQueue<int> q(2);
+    q.push(1);
+    q.push(2);
+
+    std::atomic<bool> pushed(false);
+    std::thread producer([&]() {
+        EXPECT_TRUE(q.push(3));
+        pushed = true;
+        EXPECT_FALSE(q.push(4)); // 队列又满了，stop 后返回 false
+    });
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(pushed);
+
+    int val = 0;
+    ASSERT_TRUE(q.pop(val));
+    EXPECT_EQ(val, 1);
+    while (!pushed) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(20ms);
+    q.stop();
+    producer.join();
+}
+
+// 5. 压力测试：大量元素按顺序传递
+TEST(SpscQueueTest, StressPreservesOrder) {
+    cppthreadflow::SpscQueue<int> q(256);
+    const int count = 1000000;
+
+    std::thread producer([&]() {
+        for (int i = 0; i < count; ++i) {
+            q.push(i);
+        }
+        q.stop();
+    });
+
+    int expected = 0;
+    int val = 0;
+    while (q.pop(val)) {
+        ASSERT_EQ(val, expected);
+        expected++;
+    }
+    producer.join();
+    EXPECT_EQ(expected, count);
+}
@@ -0,0 +1,123 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/strand.hpp"
+#include "../src/ThreadLib/thread_pool.hpp"
+#include <atomic>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// 1. 测试同一个 strand 上的任务按提交顺序执行
+TEST(StrandTest, PreservesSubmissionOrder) {
+    cppthreadflow::ThreadPool pool(4);
+    cppthreadflow::Strand strand(pool);
+    std::vector<int> order;
+
+    for (int i = 0; i < 1000; ++i) {
+        strand.post([&order, i]() { order.push_back(i); });
+    }
+    strand.submit([]() {}).get(); // 等待之前的任务全部完成
+
+    ASSERT_EQ(order.size(), 1000u);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+// 2. 测试多个生产者同时提交时，同一个 strand 的任务从不并发执行
+TEST(StrandTest, TasksNeverRunConcurrently) {
+    cppthreadflow::ThreadPool pool(4);
+    const int num_strands = 4;
+    const int num_producers = 4;
+    const int tasks_per_producer = 2000;
+    std::vector<std::unique_ptr<cppthreadflow::Strand>> strands;
+    std::vector<int> counters(num_strands, 0); // 不加锁，只由各自的 strand 修改
+    std::vector<std::atomic<int>> active(num_strands);
+    std::atomic<int> overlaps(0);
+
+    for (int i = 0; i < num_strands; ++i) {
+        strands.push_back(std::make_unique<cppthreadflow::Strand>(pool, 16));
+    }
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&]() {
+            for (int j = 0; j < tasks_per_producer; ++j) {
+                const int s = j % num_strands;
+                strands[s]->post([&, s]() {
+                    if (active[s].fetch_add(1) != 0) {
+                        overlaps++;
+                    }
+                    ++counters[s];
+                    active[s].fetch_sub(1);
+                });
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    for (auto& strand : strands) {
+        strand->submit([]() {}).get();
+    }
+
+    EXPECT_EQ(overlaps.load(), 0);
+    for (int s = 0; s < num_strands; ++s) {
+        EXPECT_EQ(counters[s], num_producers * tasks_per_producer / num_strands);
+    }
+}
+
+// 3. 测试 submit 返回结果与异常，post 的异常不会影响后续任务
+TEST(StrandTest, SubmitResultsAndExceptions) {
+    cppthreadflow::ThreadPool pool(2);
+    cppthreadflow::Strand strand(pool);
+
+    auto value = strand.submit([](int a, int b) { return a * b; }, 6, 7);
+    EXPECT_EQ(value.get(), 42);
+
+    auto failed = strand.submit([]() { throw std::runtime_error("strand task failed"); });
+    EXPECT_THROW(failed.get(), std::runtime_error);
+
+    strand.post([]() { throw std::runtime_error("ignored"); });
+    EXPECT_TRUE(strand.submit([]() { return true; }).get());
+}
+
+// 4. 测试 running_in_this_thread
+TEST(StrandTest, RunningInThisThread) {
+    cppthreadflow::ThreadPool pool(2);
+    cppthreadflow::Strand a(pool);
+    cppthreadflow::Strand b(pool);
+
+    EXPECT_FALSE(a.running_in_this_thread());
+    EXPECT_TRUE(a.submit([&]() { return a.running_in_this_thread(); }).get());
+    EXPECT_FALSE(a.submit([&]() { return b.running_in_this_thread(); }).get());
+}
+
+// 5. 测试每次只执行一批任务：单线程池上两个繁忙的 strand 交替运行
+TEST(StrandTest, BoundedBatchesShareWorkers) {
+    cppthreadflow::ThreadPool pool(1);
+    cppthreadflow::Strand a(pool, 8);
+    cppthreadflow::Strand b(pool, 8);
+    std::vector<char> trace; // 唯一的工作线程按顺序写入
+
+    // 先占住唯一的工作线程，让两个 strand 的任务都排好队
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    pool.submit([opened]() { opened.wait(); });
+    for (int i = 0; i < 100; ++i) {
+        a.post([&trace]() { trace.push_back('a'); });
+        b.post([&trace]() { trace.push_back('b'); });
+    }
+    gate.set_value();
+    a.submit([]() {}).get();
+    b.submit([]() {}).get();
+
+    ASSERT_EQ(trace.size(), 200u);
+    // a 的第一批最多 8 个任务之后，b 就获得了执行机会
+    size_t first_b = 0;
+    while (trace[first_b] != 'b') {
+        ++first_b;
+    }
+    EXPECT_LE(first_b, 8u);
+}
@@ -0,0 +1,113 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/task_group.hpp"
+#include "../src/ThreadLib/thread_pool.hpp"
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+// 1. 测试 wait 等待所有子任务完成
+TEST(TaskGroupTest, RunsAllTasks) {
+    cppthreadflow::ThreadPool pool(4);
+    cppthreadflow::TaskGroup group(pool);
+    std::atomic<int> sum(0);
+
+    for (int i = 1; i <= 100; ++i) {
+        group.run([&sum, i]() { sum += i; });
+    }
+    group.wait();
+    EXPECT_EQ(sum.load(), 5050);
+    EXPECT_FALSE(group.is_cancelled());
+}
+
+// 2. 测试子任务失败时取消其余子任务，并汇总异常
+TEST(TaskGroupTest, FailureCancelsRemainingAndAggregates) {
+    cppthreadflow::ThreadPool pool(1); // 单线程，子任务按提交顺序执行
+    cppthreadflow::TaskGroup group(pool);
+    std::atomic<int> executed(0);
+
+    group.run([]() { throw std::runtime_error("first failure"); });
+    for (int i = 0; i < 10; ++i) {
+        group.run([&executed]() { executed++; });
+    }
+
+    try {
+        group.wait();
+        FAIL() << "wait() should throw TaskGroupError";
+    } catch (const cppthreadflow::TaskGroupError& error) {
+        ASSERT_EQ(error.exceptions().size(), 1u);
+        EXPECT_THROW(std::rethrow_exception(error.exceptions()[0]), std::runtime_error);
+    }
+    EXPECT_TRUE(group.is_cancelled());
+    EXPECT_EQ(executed.load(), 0);
+}
+
+// 3. 测试在唯一的工作线程中等待嵌套任务组不会死锁
+TEST(TaskGroupTest, NestedWaitInsideWorkerDoesNotDeadlock) {
+    cppthreadflow::ThreadPool pool(1);
+    auto outer = pool.submit([&pool]() {
+        cppthreadflow::TaskGroup inner(pool);
+        std::atomic<int> count(0);
+        for (int i = 0; i < 10; ++i) {
+            inner.run([&count]() { count++; });
+        }
+        inner.wait(); // 工作线程自己执行排队的子任务
+        return count.load();
+    });
+    EXPECT_EQ(outer.get(), 10);
+}
+
+// 4. 测试取消沿令牌传播到嵌套的任务组
+TEST(TaskGroupTest, CancellationPropagatesToChildren) {
+    cppthreadflow::ThreadPool pool(4);
+    cppthreadflow::TaskGroup parent(pool);
+    std::promise<void> started;
+    std::atomic<bool> observed(false);
+
+    parent.run([&](const cppthreadflow::CancellationToken& token) {
+        cppthreadflow::TaskGroup child(pool, token);
+        child.run([&](const cppthreadflow::CancellationToken& child_token) {
+            started.set_value();
+            while (!child_token.is_cancellation_requested()) {
+                std::this_thread::yield();
+            }
+            observed = true;
+        });
+        child.wait();
+    });
+
+    started.get_future().wait();
+    parent.cancel();
+    parent.wait();
+    EXPECT_TRUE(observed.load());
+}
+
+// 5. 测试 CancellationSource 与父子关联
+TEST(TaskGroupTest, CancellationSourceLinking) {
+    cppthreadflow::CancellationToken none;
+    EXPECT_FALSE(none.can_be_cancelled());
+    EXPECT_FALSE(none.is_cancellation_requested());
+
+    cppthreadflow::CancellationSource parent;
+    cppthreadflow::CancellationSource child(parent.token());
+    cppthreadflow::CancellationToken child_token = child.token();
+    EXPECT_TRUE(child_token.can_be_cancelled());
+
+    child.cancel(); // 取消子源不影响父源
+    EXPECT_TRUE(child_token.is_cancellation_requested());
+    EXPECT_FALSE(parent.is_cancellation_requested());
+
+    cppthreadflow::CancellationSource sibling(parent.token());
+    parent.cancel();
+    EXPECT_TRUE(sibling.is_cancellation_requested());
+}
+
+// 6. 测试丢弃策略的线程池会让 wait() 永远等待，构造时即被拒绝
+TEST(TaskGroupTest, RejectsDropPolicyPool) {
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.queue_capacity = 1;
+    options.overflow_policy = cppthreadflow::OverflowPolicy::kDropOldest;
+    cppthreadflow::ThreadPool pool(options);
+    EXPECT_THROW(cppthreadflow::TaskGroup group(pool), std::invalid_argument);
+}
@@ -0,0 +1,212 @@
+﻿#include <gtest/gtest.h>
+#include "../src/ThreadLib/tenant_scheduler.hpp"
+#include "../src/ThreadLib/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// 提交一个阻塞任务占住唯一的执行位置，返回用于放行的 promise
+std::promise<void> block_scheduler(cppthreadflow::TenantScheduler& scheduler,
+                                   cppthreadflow::TenantScheduler::TenantId tenant) {
+    std::promise<void> release;
+    std::promise<void> started;
+    auto started_future = started.get_future();
+    scheduler.post(tenant, [&started, opened = release.get_future().share()]() {
+        started.set_value();
+        opened.wait();
+    });
+    started_future.wait();
+    return release;
+}
+
+} // namespace
+
+// 1. 测试任务全部执行，并统计到对应的租户
+TEST(TenantSchedulerTest, RunsAllTasksAndCountsPerTenant) {
+    cppthreadflow::ThreadPool pool(4);
+    cppthreadflow::TenantScheduler scheduler(pool);
+    auto a = scheduler.add_tenant({"a"});
+    auto b = scheduler.add_tenant({"b"});
+    EXPECT_EQ(scheduler.tenant_count(), 2u);
+
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 50; ++i) {
+        futures.push_back(scheduler.submit(i % 2 == 0 ? a : b, [i]() { return i; }));
+    }
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(futures[i].get(), i);
+    }
+
+    auto stats_a = scheduler.tenant_stats(a);
+    auto stats_b = scheduler.tenant_stats(b);
+    EXPECT_EQ(stats_a.submitted, 25u);
+    EXPECT_EQ(stats_b.submitted, 25u);
+    // future 就绪时任务可能还没归还执行位置，等待统计更新
+    while (scheduler.tenant_stats(a).completed + scheduler.tenant_stats(b).completed < 50) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(scheduler.tenant_stats(a).queued, 0u);
+    EXPECT_EQ(scheduler.tenant_stats(b).running, 0u);
+}
+
+// 2. 测试突发任务不会饿死其他租户：两个租户的任务交替执行
+TEST(TenantSchedulerTest, BurstDoesNotStarveOtherTenant) {
+    cppthreadflow::ThreadPool pool(1);
+    cppthreadflow::TenantScheduler scheduler(pool, 1);
+    auto noisy = scheduler.add_tenant({"noisy"});
+    auto quiet = scheduler.add_tenant({"quiet"});
+
+    auto release = block_scheduler(scheduler, noisy);
+    std::mutex mutex;
+    std::vector<cppthreadflow::TenantScheduler::TenantId> order;
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 200; ++i) {
+        futures.push_back(scheduler.submit(noisy, [&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(noisy);
+        }));
+    }
+    for (int i = 0; i < 10; ++i) {
+        futures.push_back(scheduler.submit(quiet, [&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(quiet);
+        }));
+    }
+    EXPECT_EQ(scheduler.tenant_stats(noisy).queued, 200u);
+    release.set_value();
+    for (auto& f : futures) {
+        f.get();
+    }
+
+    // 权重相同，quiet 的 10 个任务应当在前 21 个任务内执行完，而不是排在 200 个之后
+    auto last_quiet = std::find(order.rbegin(), order.rend(), quiet);
+    ASSERT_NE(last_quiet, order.rend());
+    EXPECT_LE(order.rend() - last_quiet, 21);
+    EXPECT_GT(scheduler.tenant_stats(quiet).max_wait_time, std::chrono::nanoseconds(0));
+}
+
+// 3. 测试按权重分配执行机会
+TEST(TenantSchedulerTest, WeightsControlShare) {
+    cppthreadflow::ThreadPool pool(1);
+    cppthreadflow::TenantScheduler scheduler(pool, 1);
+    auto gate = scheduler.add_tenant({"gate"});
+    auto heavy = scheduler.add_tenant({"heavy", 3});
+    auto light = scheduler.add_tenant({"light", 1});
+
+    auto release = block_scheduler(scheduler, gate);
+    std::mutex mutex;
+    std::vector<cppthreadflow::TenantScheduler::TenantId> order;
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 40; ++i) {
+        for (auto tenant : {heavy, light}) {
+            futures.push_back(scheduler.submit(tenant, [&, tenant]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(tenant);
+            }));
+        }
+    }
+    release.set_value();
+    for (auto& f : futures) {
+        f.get();
+    }
+
+    // 前 40 个任务中，heavy 与 light 之比为 3:1
+    const auto heavy_count = std::count(order.begin(), order.begin() + 40, heavy);
+    EXPECT_EQ(heavy_count, 30);
+}
+
+// 4. 测试单个租户的并发上限，不影响其他租户
+TEST(TenantSchedulerTest, ConcurrencyCapLimitsTenant) {
+    cppthreadflow::ThreadPool pool(4);
+    cppthreadflow::TenantScheduler scheduler(pool);
+    cppthreadflow::TenantOptions capped_options;
+    capped_options.name = "capped";
+    capped_options.max_concurrency = 1;
+    auto capped = scheduler.add_tenant(capped_options);
+    auto free = scheduler.add_tenant({"free"});
+
+    std::atomic<int> running(0);
+    std::atomic<int> max_running(0);
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 20; ++i) {
+        futures.push_back(scheduler.submit(capped, [&]() {
+            int now = ++running;
+            int expected = max_running.load();
+            while (now > expected && !max_running.compare_exchange_weak(expected, now)) {
+            }
+            std::this_thread::sleep_for(1ms);
+            --running;
+        }));
+    }
+    std::atomic<int> free_done(0);
+    for (int i = 0; i < 20; ++i) {
+        futures.push_back(scheduler.submit(free, [&free_done]() { free_done++; }));
+    }
+    for (auto& f : futures) {
+        f.get();
+    }
+
+    EXPECT_EQ(max_running.load(), 1);
+    EXPECT_EQ(free_done.load(), 20);
+}
+
+// 5. 测试参数检查
+TEST(TenantSchedulerTest, RejectsInvalidArguments) {
+    cppthreadflow::ThreadPool pool(1);
+    cppthreadflow::TenantScheduler scheduler(pool);
+    EXPECT_THROW(scheduler.add_tenant({"zero", 0}), std::invalid_argument);
+    EXPECT_THROW(scheduler.post(42, []() {}), std::out_of_range);
+    EXPECT_THROW(scheduler.tenant_stats(42), std::out_of_range);
+}
+
+// 6. 测试线程池拒绝提交时任务按失败处理，而不是在提交者线程上执行
+TEST(TenantSchedulerTest, RejectedSubmissionFailsJobInsteadOfRunningInline) {
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.queue_capacity = 1;
+    options.overflow_policy = cppthreadflow::OverflowPolicy::kFailFast;
+    cppthreadflow::ThreadPool pool(options);
+
+    // 占住唯一的工作线程，并填满队列
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> started;
+    auto blocker = pool.submit([&started, released]() {
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait();
+    auto filler = pool.submit([]() {});
+
+    cppthreadflow::TenantScheduler scheduler(pool);
+    const auto tenant = scheduler.add_tenant();
+    std::atomic<bool> ran(false);
+    auto future = scheduler.submit(tenant, [&ran]() { ran = true; });
+
+    EXPECT_FALSE(ran.load());
+    EXPECT_THROW(future.get(), std::future_error);
+    const auto stats = scheduler.tenant_stats(tenant);
+    EXPECT_EQ(stats.rejected, 1u);
+    EXPECT_EQ(stats.running, 0u);
+    EXPECT_EQ(stats.completed, 0u);
+
+    release.set_value();
+    blocker.get();
+    filler.get();
+    // 执行位置已归还，之后的任务正常执行
+    scheduler.submit(tenant, []() {}).get();
+    // future 就绪时统计可能尚未更新
+    for (int i = 0; i < 1000 && scheduler.tenant_stats(tenant).completed == 0; ++i) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_EQ(scheduler.tenant_stats(tenant).completed, 1u);
+}
@@ -4,6 +4,8 @@
 #include <thread>
 #include <atomic>
 #include <type_traits>
+#include <future>
+#include <vector>
 // 测试基本任务提交和结果获取
 TEST(ThreadPoolTest, SubmitTaskAndGetResult) {
     cppthreadflow::ThreadPool pool(2);
@@ -90,4 +92,200 @@ TEST(ThreadPoolTest, GracefulShutdown) {
 
     // 析构函数应该阻塞直到所有任务完成
     EXPECT_EQ(tasks_completed, num_tasks);
-}
\ No newline at end of file
+}
+// 测试有界线程池：kFailFast 策略下队列满时 submit 抛出异常
+TEST(ThreadPoolTest, BoundedQueueFailFast) {
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.queue_capacity = 1;
+    options.overflow_policy = cppthreadflow::OverflowPolicy::kFailFast;
+    cppthreadflow::ThreadPool pool(options);
+
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+    std::atomic<bool> started(false);
+    // 第一个任务占住唯一的工作线程
+    auto blocker = pool.submit([&started, gate]() {
+        started = true;
+        gate.wait();
+    });
+    while (!started) {
+        std::this_thread::yield();
+    }
+
+    auto queued = pool.submit([]() { return 1; }); // 占满队列
+    EXPECT_THROW(pool.submit([]() { return 2; }), cppthreadflow::QueueFullError);
+    EXPECT_EQ(pool.queue_stats().rejected, 1u);
+    EXPECT_EQ(pool.pending_tasks(), 1u);
+
+    release.set_value();
+    blocker.get();
+    EXPECT_EQ(queued.get(), 1);
+}
+
+// 测试有界线程池：kBlock 策略下 submit 阻塞，直到有空位
+TEST(ThreadPoolTest, BoundedQueueBlocksSubmitter) {
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 2;
+    options.queue_capacity = 4;
+    cppthreadflow::ThreadPool pool(options);
+
+    std::atomic<int> completed(0);
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 100; ++i) {
+        futures.push_back(pool.submit([&completed]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            completed++;
+        }));
+        EXPECT_LE(pool.pending_tasks(), 4u);
+    }
+    for (auto& f : futures) {
+        f.get();
+    }
+    EXPECT_EQ(completed.load(), 100);
+    EXPECT_GT(pool.queue_stats().blocked_pushes, 0u);
+}
+
+// 测试 try_run_pending_task：调用线程可以取出排队的任务并执行
+TEST(ThreadPoolTest, TryRunPendingTaskHelpsFromCallerThread) {
+    cppthreadflow::ThreadPool pool(1);
+    std::promise<void> started;
+    std::promise<void> release;
+    auto blocker = pool.submit([&started, opened = release.get_future().share()]() {
+        started.set_value();
+        opened.wait();
+    });
+    started.get_future().wait();
+
+    // 唯一的工作线程被占用，排队的任务只能由调用线程执行
+    auto queued = pool.submit([]() { return std::this_thread::get_id(); });
+    EXPECT_TRUE(pool.try_run_pending_task());
+    EXPECT_EQ(queued.get(), std::this_thread::get_id());
+    EXPECT_FALSE(pool.try_run_pending_task());
+
+    release.set_value();
+    blocker.get();
+}
+
+// 测试带令牌的 submit：开始执行前已取消的任务被放弃，future 收到 OperationCancelled
+TEST(ThreadPoolTest, SubmitWithCancelledTokenSkipsTask) {
+    cppthreadflow::ThreadPool pool(1);
+    std::promise<void> started;
+    std::promise<void> release;
+    auto blocker = pool.submit([&started, opened = release.get_future().share()]() {
+        started.set_value();
+        opened.wait();
+    });
+    started.get_future().wait();
+
+    cppthreadflow::CancellationSource source;
+    std::atomic<bool> ran(false);
+    auto queued = pool.submit(source.token(), [&ran](int x) { ran = true; return x; }, 7);
+    auto unaffected = pool.submit(cppthreadflow::CancellationToken(), []() { return 1; });
+    source.cancel();
+    release.set_value();
+
+    EXPECT_THROW(queued.get(), cppthreadflow::OperationCancelled);
+    EXPECT_FALSE(ran.load());
+    EXPECT_EQ(unaffected.get(), 1);
+    blocker.get();
+}
+
+// 测试 submit_with_deadline：排队的任务按截止时间先后执行，而不是提交顺序
+TEST(ThreadPoolTest, DeadlineTasksRunEarliestFirst) {
+    using namespace std::chrono_literals;
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.deadline_ordering = cppthreadflow::PriorityOrdering::kStrict;
+    cppthreadflow::ThreadPool pool(options);
+
+    std::promise<void> started;
+    std::promise<void> release;
+    auto blocker = pool.submit([&started, opened = release.get_future().share()]() {
+        started.set_value();
+        opened.wait();
+    });
+    started.get_future().wait();
+
+    const auto now = cppthreadflow::ThreadPool::Clock::now();
+    std::vector<int> order;
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 5; ++i) {
+        // 越晚提交的任务截止时间越早
+        futures.push_back(pool.submit_with_deadline(now + std::chrono::seconds(10 - i), [&order, i]() {
+            order.push_back(i);
+        }));
+    }
+    release.set_value();
+    blocker.get();
+    for (auto& f : futures) {
+        f.get();
+    }
+
+    EXPECT_EQ(order, (std::vector<int>{4, 3, 2, 1, 0}));
+    auto stats = pool.deadline_stats();
+    EXPECT_EQ(stats.submitted, 5u);
+    EXPECT_EQ(stats.expired, 0u);
+    EXPECT_EQ(stats.late, 0u);
+}
+
+// 测试 drop_expired_tasks：开始执行前已过期的任务被丢弃，并计入统计
+TEST(ThreadPoolTest, ExpiredDeadlineTasksAreDropped) {
+    using namespace std::chrono_literals;
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.drop_expired_tasks = true;
+    cppthreadflow::ThreadPool pool(options);
+
+    std::promise<void> started;
+    std::promise<void> release;
+    auto blocker = pool.submit([&started, opened = release.get_future().share()]() {
+        started.set_value();
+        opened.wait();
+    });
+    started.get_future().wait();
+
+    const auto now = cppthreadflow::ThreadPool::Clock::now();
+    std::atomic<bool> ran(false);
+    auto expired = pool.submit_with_deadline(now + 10ms, [&ran]() { ran = true; });
+    auto in_time = pool.submit_with_deadline(now + 10s, []() { return 42; });
+    std::this_thread::sleep_for(30ms);
+    release.set_value();
+
+    EXPECT_THROW(expired.get(), cppthreadflow::OperationCancelled);
+    EXPECT_FALSE(ran.load());
+    EXPECT_EQ(in_time.get(), 42);
+    blocker.get();
+
+    auto stats = pool.deadline_stats();
+    EXPECT_EQ(stats.submitted, 2u);
+    EXPECT_EQ(stats.expired, 1u);
+}
+
+// 测试溢出策略丢弃的票据：对应的带截止时间任务被丢弃，其余任务照常执行
+TEST(ThreadPoolTest, DroppedDeadlineTicketBreaksPromise) {
+    using namespace std::chrono_literals;
+    cppthreadflow::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.queue_capacity = 1;
+    options.overflow_policy = cppthreadflow::OverflowPolicy::kDropNewest;
+    cppthreadflow::ThreadPool pool(options);
+
+    std::promise<void> started;
+    std::promise<void> release;
+    auto blocker = pool.submit([&started, opened = release.get_future().share()]() {
+        started.set_value();
+        opened.wait();
+    });
+    started.get_future().wait();
+
+    const auto now = cppthreadflow::ThreadPool::Clock::now();
+    auto queued = pool.submit_with_deadline(now + 10s, []() { return 1; });
+    auto dropped = pool.submit_with_deadline(now + 1s, []() { return 2; });
+    EXPECT_THROW(dropped.get(), std::future_error);
+
+    release.set_value();
+    blocker.get();
+    EXPECT_EQ(queued.get(), 1);
+    EXPECT_EQ(pool.queue_stats().dropped, 1u);
+}